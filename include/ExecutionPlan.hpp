@@ -0,0 +1,102 @@
+#ifndef EXECUTION_PLAN_HPP
+#define EXECUTION_PLAN_HPP
+
+#include "layers/DenseLayer.hpp"
+#include <vector>
+
+// A training step (or an inference pass) over a model's layers, compiled for
+// batches of up to batch_size rows. With every intermediate's shape known up
+// front, their lifetimes are planned once and tensors that are never live at
+// the same time share memory in a single arena. Running the plan allocates
+// nothing: layer outputs and gradients are views into the arena, and the
+// layers' parameter gradients are written in place for the optimizer.
+//
+// The arithmetic is the same as Model::predict and Model::backward, in the
+// same order.
+//
+// Training normally keeps every layer's output for backward, so activation
+// memory grows with depth x batch size. With recompute_every = k, a training
+// plan keeps only every k-th output (and the last) and backward() recomputes
+// the others one segment at a time: about one extra forward pass for
+// O(depth / k + k) outputs in memory, O(sqrt(depth)) at k = sqrt(depth).
+// Activations whose derivative needs their input (GELU) have that input kept
+// in the arena too, and recomputed along with the output.
+//
+// Like an Optimizer, a plan refers to the layers and must not
+// outlive them; see matches() for when it has to be recompiled.
+class ExecutionPlan
+{
+public:
+    // An inference plan (training false) only needs room for two adjacent
+    // layers' outputs. recompute_every 0 or 1 keeps every output.
+    ExecutionPlan(std::vector<DenseLayer> &layers, int batch_size, bool training = true, int recompute_every = 0);
+    // Movable but not copyable: the views point into this plan's arena
+    ExecutionPlan(const ExecutionPlan &) = delete;
+    ExecutionPlan &operator=(const ExecutionPlan &) = delete;
+    ExecutionPlan(ExecutionPlan &&) = default;
+    ExecutionPlan &operator=(ExecutionPlan &&) = default;
+
+    // The model's output for up to batch_size rows, valid until the next
+    // forward(). In a training plan, input must stay alive and unchanged until
+    // backward().
+    const Matrix &forward(const Matrix &input);
+    // Buffer for the loss gradient of the last forward(), to be filled before
+    // backward() (e.g. by Loss::backward_into)
+    Matrix &output_gradient();
+    // Writes every layer's parameter gradients. The first layer's input
+    // gradient is never computed.
+    void backward();
+
+    // Whether the plan still fits: the same layers, with the shapes it was
+    // compiled for, and at most batch_size rows
+    bool matches(const std::vector<DenseLayer> &layers, int rows) const;
+
+    int getBatchSize() const;
+    bool isTraining() const;
+    int getRecomputeEvery() const;
+    // Bytes of the shared arena, against the same tensors in separate buffers
+    size_t getArenaBytes() const;
+    size_t getUnsharedBytes() const;
+
+private:
+    // A layer's output or the gradient at it, live over steps [first, last] of
+    // the plan's schedule
+    struct Tensor
+    {
+        int cols;
+        int first;
+        int last;
+        size_t offset; // Into the arena, in doubles
+    };
+
+    int add_tensor(int cols);
+    void place_tensors();
+    Matrix &view(int tensor);
+    int output(int layer) const; // The tensor backward reads the layer's output from
+    int pre_activation(int layer) const;
+    int activation_operand(int layer) const;
+    int segment_begin(int end) const;
+    void layer_forward(int layer, const double *input, Matrix &output, int pre_activation);
+
+    std::vector<DenseLayer> *m_layers;
+    int m_batch_size;
+    bool m_training;
+    int m_recompute_every;
+    std::vector<int> m_shapes; // inputs of every layer, then the outputs of the last
+
+    std::vector<Tensor> m_tensors;
+    std::vector<bool> m_kept;       // Outputs kept from forward() for backward()
+    std::vector<int> m_outputs;     // Tensor holding each layer's output in forward()
+    std::vector<int> m_recomputed;  // Tensor backward() recomputes an output that was not kept into, or -1
+    std::vector<int> m_pre_activations;            // Kept activation input of layers that need_input(), or -1
+    std::vector<int> m_recomputed_pre_activations; // The same, recomputed with the output
+    std::vector<int> m_gradients;   // Tensor holding the gradient at each layer's output, or -1
+    std::vector<double> m_arena;
+    size_t m_arena_start; // Doubles skipped to reach a 64-byte boundary; a move keeps the buffer
+    std::vector<Matrix> m_views; // One per tensor, resized to the batch by forward()
+
+    const Matrix *m_input; // Of the last forward(), for the first layer's weight gradients
+    int m_rows;
+};
+
+#endif // EXECUTION_PLAN_HPP
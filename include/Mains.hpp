@@ -1,5 +1,14 @@
 #ifndef MAIN_HPP
 #define MAIN_HPP
+#include <string>
+#include <vector>
 int boston();
 int mnist();
+int hogwild_benchmark(const std::string &dataset_path, int threads, int epochs, int batch_size);
+int static_benchmark(const std::string &task, const std::string &dataset_path, int epochs);
+int plan_benchmark(const std::string &task, const std::string &dataset_path, int epochs, int batch_size,
+                   std::vector<int> hidden, const std::string &activation, int recompute_every);
+int math_benchmark();
+int parallel_benchmark(const std::string &task, const std::string &dataset_path, int epochs, int workers,
+                       int processes, int pipeline_stages, int micro_batches);
 #endif // MAIN_HPP
@@ -11,12 +11,28 @@ public:
     Matrix(int rows, int cols);
     Matrix(const std::vector<std::vector<double>> &data);
 
+    // Copies always own their storage; moves keep a view a view
+    Matrix(const Matrix &other);
+    Matrix(Matrix &&other) noexcept;
+    Matrix &operator=(const Matrix &other);
+    Matrix &operator=(Matrix &&other) noexcept;
+
+    // Non-owning matrix over external row-major storage (e.g. a mapped model
+    // file). The storage must outlive the view and every move of it.
+    static Matrix view(double *data, int rows, int cols);
+    bool isView() const;
+
     int getRows() const;
     int getCols() const;
+    size_t size() const;
 
     double &operator()(int r, int c);
     const double &operator()(int r, int c) const;
 
+    // Raw row-major storage, for kernels that walk the matrix linearly
+    double *data();
+    const double *data() const;
+
     static Matrix random(int rows, int cols);
     static Matrix multiply(const Matrix &a, const Matrix &b);
     static Matrix he(int rows, int cols);
@@ -37,10 +53,15 @@ public:
 
     void print() const;
 
+    // Text block used by model files: a "rows,cols" line, then one CSV line per row
+    void write_text(std::ostream &out) const;
+    static Matrix read_text(std::istream &in);
+
 private:
     int m_rows;
     int m_cols;
     std::vector<double> m_data;
+    double *m_ptr; // m_data.data(), or external storage for views
 };
 
 #endif // MATRIX_H
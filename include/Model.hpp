@@ -1,25 +1,111 @@
 #ifndef MODEL_HPP
 #define MODEL_HPP
 
+#include "ExecutionPlan.hpp"
 #include "layers/DenseLayer.hpp"
+#include "utils/DataHandler.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
+// Architecture of one layer, as recorded in model files
+struct LayerSpec
+{
+    int inputs;
+    int outputs;
+    std::string activation;
+    std::string regularizer; // "none" when the layer has no regularizer
+    std::vector<double> regularizer_params;
+};
+
 class Model
 {
 public:
     Model();
 
+    // Rebuilds a model, architecture included, from a self-describing model file
+    static Model from_file(const std::string &filename);
+    // Layer stack recorded in a model file; empty for legacy files without one
+    static std::vector<LayerSpec> read_architecture(const std::string &filename);
+    std::vector<LayerSpec> describe() const;
+    // Hash of the layer shapes and parameters: a version that changes whenever
+    // the model's outputs can, e.g. to key cached predictions
+    uint64_t fingerprint() const;
+
+    // Parameters-only copy (no cached activations or gradients): cheap enough to
+    // take inside the training loop and hand to another thread.
+    Model snapshot() const;
+    // snapshot() into an existing model with the same layer shapes, reusing its
+    // storage: what a pool of snapshots refills every epoch
+    void copy_parameters(const Model &source);
+
+    // Early-stopping snapshots of the best parameters seen so far. Storage is
+    // allocated by the first save and reused afterwards, so saving on every
+    // improvement and restoring at the end cause no heap traffic.
+    void save_best();
+    void save_best(const Model &source); // From a snapshot of this model
+    void restore_best();
+    bool hasBest() const;
+
     void add(DenseLayer layer);
-    void backward(const Matrix &d_output);
+    // Without regularize, leaves the regularizers' penalty out (see DenseLayer::backward)
+    void backward(const Matrix &d_output, bool regularize = true);
     Matrix predict(Matrix input);
+    // Plans a training step (or with training false, inference) over batches of
+    // up to batch_size rows, to run with no allocations; see ExecutionPlan for
+    // recompute_every (gradient checkpointing)
+    ExecutionPlan compile(int batch_size, bool training = true, int recompute_every = 0);
 
     std::vector<DenseLayer> &getLayers();
+    // Arithmetic of every layer's forward and backward passes (see DenseLayer)
+    void setPrecision(Precision precision);
 
+    // Files ending in ".bin" are saved in the binary format; load() detects it
     void save(const std::string &filename) const;
     void load(const std::string &filename);
+    void save_text(std::ostream &file) const;
+
+    // Versioned binary format: full precision, checksummed, loaded with one read
+    void save_binary(const std::string &filename) const;
+    void load_binary(const std::string &filename);
+    static bool is_binary_file(const std::string &filename);
+
+    // Read-only model whose weights stay in a shared mmap of a binary model file,
+    // so worker processes share one copy through the page cache. Skips the
+    // checksum pass unless asked, so startup only faults in the pages it touches.
+    // Training, restore_best(), folding and pruning such a model throw.
+    static Model map_file(const std::string &filename, bool verify_checksum = false);
+    bool isMapped() const;
+
+    // Folds the affine input preprocessing x' = (x - shift) * scale into the
+    // first layer, so the model takes raw features with no separate pass.
+    void fold_input_transform(const Matrix &shift, const Matrix &scale);
+    // Inverse of fold_input_transform: the model takes preprocessed features again.
+    void unfold_input_transform(const Matrix &shift, const Matrix &scale);
+    void fold_scaler(const StandardScaler &scaler);
+    void unfold_scaler(const StandardScaler &scaler);
+    bool hasFoldedInput() const;
+
+    // Feature scaler fitted at training time, saved alongside the weights
+    void setScaler(const StandardScaler &scaler);
+    const StandardScaler &getScaler() const;
+    bool hasScaler() const;
 
 private:
+    static std::vector<LayerSpec> read_text_architecture(std::istream &file);
+    static std::vector<LayerSpec> read_binary_architecture(const std::string &filename);
+    void check_architecture(const std::vector<LayerSpec> &specs) const;
+
+    void apply_input_affine(const Matrix &shift, const Matrix &scale);
+
     std::vector<DenseLayer> m_layers;
+    bool m_input_folded;
+    std::vector<Matrix> m_best_weights;
+    std::vector<Matrix> m_best_biases;
+    bool m_has_best;
+    StandardScaler m_scaler;
+    std::shared_ptr<const char> m_mapping; // Keeps a map_file() mapping alive
 };
 
 #endif // MODEL_HPP
\ No newline at end of file
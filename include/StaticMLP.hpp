@@ -0,0 +1,412 @@
+#ifndef STATIC_MLP_HPP
+#define STATIC_MLP_HPP
+
+#include "Model.hpp"
+#include "activations/Activation.hpp"
+#include "math/VectorMath.hpp"
+#include "utils/Random.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Building blocks of a StaticMLP: activations as types, and a dense layer whose
+// shape and activation are template parameters
+namespace static_mlp
+{
+struct relu
+{
+    static constexpr const char *name = "relu";
+    template <size_t N>
+    static void apply(std::array<double, N> &values)
+    {
+        for (double &v : values)
+            v = v > 0 ? v : 0;
+    }
+    // From the activation's output, which is positive exactly where its input was
+    static double derivative(double output) { return output > 0 ? 1.0 : 0.0; }
+};
+
+struct linear
+{
+    static constexpr const char *name = "linear";
+    template <size_t N>
+    static void apply(std::array<double, N> &) {}
+    static double derivative(double) { return 1.0; }
+};
+
+struct sigmoid
+{
+    static constexpr const char *name = "sigmoid";
+    template <size_t N>
+    static void apply(std::array<double, N> &values)
+    {
+        vector_sigmoid(values.data(), values.data(), N);
+    }
+    static double derivative(double output) { return output * (1.0 - output); }
+};
+
+struct tanh
+{
+    static constexpr const char *name = "tanh";
+    template <size_t N>
+    static void apply(std::array<double, N> &values)
+    {
+        vector_tanh(values.data(), values.data(), N);
+    }
+    static double derivative(double output) { return 1.0 - output * output; }
+};
+
+// There is no gelu: its derivative needs the input, and layers keep only outputs
+
+// Output layer only: trained with cross-entropy, whose gradient with softmax is
+// output - target. Computed by the same kernel as Softmax.
+struct softmax
+{
+    static constexpr const char *name = "softmax";
+    template <size_t N>
+    static void apply(std::array<double, N> &values)
+    {
+        vector_softmax(values.data(), values.data(), N);
+    }
+};
+
+template <int Inputs, int Outputs, typename Activation>
+struct Dense
+{
+    static_assert(Inputs > 0 && Outputs > 0, "Layer sizes must be positive");
+    static constexpr int inputs = Inputs;
+    static constexpr int outputs = Outputs;
+    using activation = Activation;
+
+    alignas(64) std::array<double, Inputs * Outputs> weights{}; // inputs x outputs, row-major, as in DenseLayer
+    alignas(64) std::array<double, Outputs> biases{};
+
+    // x W + b, summed in the same order as Matrix::multiply, then the activation
+    void forward(const double *x, std::array<double, Outputs> &y) const
+    {
+        std::array<double, Outputs> z{};
+        for (int i = 0; i < Inputs; ++i)
+        {
+            const double xi = x[i];
+            if (xi == 0.0)
+                continue;
+            const double *row = &weights[static_cast<size_t>(i) * Outputs];
+            for (int o = 0; o < Outputs; ++o)
+                z[o] += xi * row[o];
+        }
+        for (int o = 0; o < Outputs; ++o)
+            y[o] = z[o] + biases[o];
+        Activation::apply(y);
+    }
+};
+} // namespace static_mlp
+
+// An MLP whose topology is fixed at compile time, for deployments with a known
+// shape:
+//
+//   using BostonNet = StaticMLP<static_mlp::Dense<13, 64, static_mlp::relu>,
+//                               static_mlp::Dense<64, 64, static_mlp::relu>,
+//                               static_mlp::Dense<64, 1, static_mlp::linear>>;
+//
+// Parameters and activations live in std::arrays sized by the template, every
+// loop has a constant trip count and layers are chained by template recursion,
+// so there is no virtual call, no Matrix and no heap traffic per row. The
+// parameters, gradients and Adam moments are members, so large networks belong
+// on the heap (std::make_unique<Net>()), not the stack.
+//
+// Training is full-batch Adam on MSE (or cross-entropy with a softmax output)
+// and computes the same gradients, in the same order, as Model with its loss
+// and Adam; regularizers are not applied. Parameters move to and from Model,
+// and through it the model file formats.
+template <typename... Layers>
+class StaticMLP
+{
+    static constexpr size_t kDepth = sizeof...(Layers);
+    static_assert(kDepth > 0, "A StaticMLP needs at least one layer");
+    using LayerTuple = std::tuple<Layers...>;
+    template <size_t L>
+    using LayerAt = std::tuple_element_t<L, LayerTuple>;
+    using Outputs = std::tuple<std::array<double, Layers::outputs>...>;
+
+    template <size_t... L>
+    static constexpr bool chained(std::index_sequence<L...>)
+    {
+        return ((LayerAt<L>::outputs == LayerAt<L + 1>::inputs) && ...);
+    }
+    template <size_t... L>
+    static constexpr bool softmax_only_last(std::index_sequence<L...>)
+    {
+        return (!std::is_same_v<typename LayerAt<L>::activation, static_mlp::softmax> && ...);
+    }
+    static_assert(chained(std::make_index_sequence<kDepth - 1>()), "Each layer's inputs must match the previous layer's outputs");
+    static_assert(softmax_only_last(std::make_index_sequence<kDepth - 1>()), "Softmax is only supported on the output layer");
+
+public:
+    static constexpr int kInputs = LayerAt<0>::inputs;
+    static constexpr int kOutputs = LayerAt<kDepth - 1>::outputs;
+    static constexpr bool kClassifier = std::is_same_v<typename LayerAt<kDepth - 1>::activation, static_mlp::softmax>;
+
+    // Parameters start at zero; set them with initialize() or load()
+    StaticMLP() : m_step(0) {}
+
+    // He initialization, as DenseLayer does by default
+    void initialize()
+    {
+        for_each_layer([](auto &layer, auto &, auto &, auto &)
+                       {
+            using Layer = std::decay_t<decltype(layer)>;
+            std::normal_distribution<> distribution(0.0, std::sqrt(2.0 / Layer::inputs));
+            for (double &w : layer.weights)
+                w = distribution(global_rng());
+            layer.biases.fill(0.0); });
+        reset_optimizer();
+    }
+
+    // One row of kInputs features to kOutputs values
+    void predict(const double *input, double *output) const
+    {
+        Outputs outputs;
+        forward<0>(input, outputs);
+        const auto &last = std::get<kDepth - 1>(outputs);
+        std::copy(last.begin(), last.end(), output);
+    }
+
+    Matrix predict(const Matrix &input) const
+    {
+        check_columns(input, kInputs, "Input");
+        Matrix output(input.getRows(), kOutputs);
+        for (int r = 0; r < input.getRows(); ++r)
+        {
+            predict(input.data() + static_cast<size_t>(r) * kInputs, output.data() + static_cast<size_t>(r) * kOutputs);
+        }
+        return output;
+    }
+
+    // One full-batch Adam step; returns the loss before the step
+    double train_step(const Matrix &X, const Matrix &y, double learning_rate, double beta1 = 0.9,
+                      double beta2 = 0.999, double epsilon = 1e-8)
+    {
+        check_columns(X, kInputs, "Input");
+        check_columns(y, kOutputs, "Target");
+        if (X.getRows() != y.getRows() || X.getRows() == 0)
+        {
+            throw std::invalid_argument("Inputs and targets must have the same, nonzero number of rows.");
+        }
+        for_each_layer([](auto &, auto &gradient, auto &, auto &)
+                       {
+            gradient.weights.fill(0.0);
+            gradient.biases.fill(0.0); });
+
+        const int rows = X.getRows();
+        const double normalizer = 2.0 / rows;
+        const double clip = std::numeric_limits<double>::epsilon();
+        double loss = 0.0;
+        Outputs outputs;
+        std::array<double, kOutputs> delta;
+        for (int r = 0; r < rows; ++r)
+        {
+            const double *x = X.data() + static_cast<size_t>(r) * kInputs;
+            const double *target = y.data() + static_cast<size_t>(r) * kOutputs;
+            forward<0>(x, outputs);
+            const auto &prediction = std::get<kDepth - 1>(outputs);
+            std::array<double, kOutputs> logs;
+            if constexpr (kClassifier)
+            {
+                for (int o = 0; o < kOutputs; ++o)
+                    logs[o] = std::min(1.0 - clip, std::max(clip, prediction[o]));
+                vector_log(logs.data(), logs.data(), kOutputs);
+            }
+            for (int o = 0; o < kOutputs; ++o)
+            {
+                double error = prediction[o] - target[o];
+                if constexpr (kClassifier)
+                {
+                    loss -= target[o] * logs[o];
+                    delta[o] = error;
+                }
+                else
+                {
+                    loss += error * error;
+                    delta[o] = error * normalizer *
+                               LayerAt<kDepth - 1>::activation::derivative(prediction[o]);
+                }
+            }
+            backward<kDepth - 1>(x, outputs, delta.data());
+        }
+
+        ++m_step;
+        const double first_correction = 1.0 / (1.0 - std::pow(beta1, m_step));
+        const double second_correction = 1.0 / (1.0 - std::pow(beta2, m_step));
+        auto update = [&](auto &parameters, const auto &gradients, auto &first, auto &second)
+        {
+            for (size_t i = 0; i < parameters.size(); ++i)
+            {
+                const double g = gradients[i];
+                first[i] = first[i] * beta1 + g * (1.0 - beta1);
+                second[i] = second[i] * beta2 + g * g * (1.0 - beta2);
+                double step = first[i] * first_correction / (std::sqrt(second[i] * second_correction) + epsilon);
+                parameters[i] -= step * learning_rate;
+            }
+        };
+        for_each_layer([&](auto &layer, auto &gradient, auto &first, auto &second)
+                       {
+            update(layer.weights, gradient.weights, first.weights, second.weights);
+            update(layer.biases, gradient.biases, first.biases, second.biases); });
+        return loss / rows;
+    }
+
+    // Copies the parameters of a Model with exactly this topology
+    void load(Model &model)
+    {
+        std::vector<DenseLayer> &layers = model.getLayers();
+        if (layers.size() != kDepth)
+        {
+            throw std::invalid_argument("Model has " + std::to_string(layers.size()) + " layers, the StaticMLP has " +
+                                        std::to_string(kDepth) + ".");
+        }
+        size_t l = 0;
+        for_each_layer([&](auto &layer, auto &, auto &, auto &)
+                       {
+            using Layer = std::decay_t<decltype(layer)>;
+            const DenseLayer &source = layers[l++];
+            if (source.getWeights().getRows() != Layer::inputs || source.getWeights().getCols() != Layer::outputs ||
+                source.getActivation()->name() != Layer::activation::name)
+            {
+                throw std::invalid_argument("Model layer " + std::to_string(l) + " does not match the StaticMLP's " +
+                                            std::to_string(Layer::inputs) + "x" + std::to_string(Layer::outputs) +
+                                            " " + Layer::activation::name + " layer.");
+            }
+            std::copy(source.getWeights().data(), source.getWeights().data() + layer.weights.size(), layer.weights.begin());
+            std::copy(source.getBiases().data(), source.getBiases().data() + layer.biases.size(), layer.biases.begin()); });
+        reset_optimizer();
+    }
+
+    Model to_model() const
+    {
+        Model model;
+        for_each_layer([&](const auto &layer)
+                       {
+            using Layer = std::decay_t<decltype(layer)>;
+            Matrix weights(Layer::inputs, Layer::outputs), biases(1, Layer::outputs);
+            std::copy(layer.weights.begin(), layer.weights.end(), weights.data());
+            std::copy(layer.biases.begin(), layer.biases.end(), biases.data());
+            model.add(DenseLayer(std::move(weights), std::move(biases), Activation::create(Layer::activation::name))); });
+        return model;
+    }
+
+    // Through Model, in any format it reads and writes. Only the layers move:
+    // a scaler stored in the file is not kept.
+    void load(const std::string &filename)
+    {
+        Model model = Model::from_file(filename);
+        load(model);
+    }
+    void save(const std::string &filename) const { to_model().save(filename); }
+
+private:
+    static void check_columns(const Matrix &matrix, int columns, const char *what)
+    {
+        if (matrix.getCols() != columns)
+        {
+            throw std::invalid_argument(std::string(what) + " has " + std::to_string(matrix.getCols()) +
+                                        " columns, the StaticMLP expects " + std::to_string(columns) + ".");
+        }
+    }
+
+    template <size_t L>
+    void forward(const double *x, Outputs &outputs) const
+    {
+        std::get<L>(m_layers).forward(x, std::get<L>(outputs));
+        if constexpr (L + 1 < kDepth)
+            forward<L + 1>(std::get<L>(outputs).data(), outputs);
+    }
+
+    // delta is the loss gradient at layer L's pre-activation; accumulates the
+    // layer's gradients and recurses with the gradient at its input
+    template <size_t L>
+    void backward(const double *input, const Outputs &outputs, const double *delta)
+    {
+        using Layer = LayerAt<L>;
+        const Layer &layer = std::get<L>(m_layers);
+        Layer &gradient = std::get<L>(m_gradients);
+        const double *x = input;
+        if constexpr (L > 0)
+            x = std::get<L - 1>(outputs).data();
+
+        for (int i = 0; i < Layer::inputs; ++i)
+        {
+            const double xi = x[i];
+            if (xi == 0.0)
+                continue;
+            double *row = &gradient.weights[static_cast<size_t>(i) * Layer::outputs];
+            for (int o = 0; o < Layer::outputs; ++o)
+                row[o] += xi * delta[o];
+        }
+        for (int o = 0; o < Layer::outputs; ++o)
+            gradient.biases[o] += delta[o];
+
+        if constexpr (L > 0)
+        {
+            using Previous = LayerAt<L - 1>;
+            const auto &previous_output = std::get<L - 1>(outputs);
+            std::array<double, Layer::inputs> previous_delta;
+            for (int i = 0; i < Layer::inputs; ++i)
+            {
+                const double *row = &layer.weights[static_cast<size_t>(i) * Layer::outputs];
+                double sum = 0.0;
+                for (int o = 0; o < Layer::outputs; ++o)
+                    sum += delta[o] * row[o];
+                previous_delta[i] = Previous::activation::derivative(previous_output[i]) * sum;
+            }
+            backward<L - 1>(input, outputs, previous_delta.data());
+        }
+    }
+
+    // f(layer, gradient, first moment, second moment) for every layer in order
+    template <typename F>
+    void for_each_layer(F &&f)
+    {
+        for_each_layer(std::forward<F>(f), std::make_index_sequence<kDepth>());
+    }
+    template <typename F, size_t... L>
+    void for_each_layer(F &&f, std::index_sequence<L...>)
+    {
+        (f(std::get<L>(m_layers), std::get<L>(m_gradients), std::get<L>(m_first_moments),
+           std::get<L>(m_second_moments)),
+         ...);
+    }
+    template <typename F>
+    void for_each_layer(F &&f) const
+    {
+        std::apply([&](const auto &...layer)
+                   { (f(layer), ...); },
+                   m_layers);
+    }
+
+    void reset_optimizer()
+    {
+        m_step = 0;
+        for_each_layer([](auto &, auto &gradient, auto &first, auto &second)
+                       {
+            for (auto *state : {&gradient, &first, &second})
+            {
+                state->weights.fill(0.0);
+                state->biases.fill(0.0);
+            } });
+    }
+
+    LayerTuple m_layers;
+    LayerTuple m_gradients;
+    LayerTuple m_first_moments; // Adam
+    LayerTuple m_second_moments;
+    int m_step;
+};
+
+#endif // STATIC_MLP_HPP
@@ -2,6 +2,8 @@
 #define ACTIVATION_HPP
 
 #include "Matrix.hpp"
+#include <memory>
+#include <string>
 
 class Activation
 {
@@ -9,6 +11,22 @@ public:
     virtual ~Activation() = default;
     virtual Matrix forward(const Matrix &input) = 0;
     virtual Matrix backward(const Matrix &d_output) = 0;
+    // Identifier used by the model file formats
+    virtual std::string name() const = 0;
+
+    // In-place variants over preallocated buffers (see ExecutionPlan).
+    // backward_in_place turns the gradient at the activation's output into the
+    // gradient at its input, given the output forward_in_place produced, or
+    // its input where needs_input(). The defaults go through forward() and
+    // backward().
+    virtual void forward_in_place(Matrix &values);
+    virtual void backward_in_place(const Matrix &output, Matrix &gradient);
+    // Whether the derivative needs the input rather than the output, which
+    // the caller then keeps for backward_in_place
+    virtual bool needs_input() const;
+
+    // Instantiates an activation from its name() identifier
+    static std::shared_ptr<Activation> create(const std::string &name);
 };
 
 #endif // ACTIVATION_HPP
\ No newline at end of file
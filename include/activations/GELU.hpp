@@ -0,0 +1,24 @@
+#ifndef GELU_HPP
+#define GELU_HPP
+
+#include "Activation.hpp"
+
+// Gaussian error linear unit, in its tanh approximation (see vector_gelu).
+// Unlike sigmoid and tanh, the derivative needs the input: forward() keeps
+// it, and in-place callers keep it themselves (needs_input()).
+class GELU : public Activation
+{
+public:
+    GELU();
+    Matrix forward(const Matrix &input) override;
+    Matrix backward(const Matrix &d_output) override;
+    void forward_in_place(Matrix &values) override;
+    void backward_in_place(const Matrix &input, Matrix &gradient) override;
+    bool needs_input() const override;
+    std::string name() const override;
+
+private:
+    Matrix m_input;
+};
+
+#endif // GELU_HPP
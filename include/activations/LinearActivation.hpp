@@ -9,6 +9,9 @@ public:
     LinearActivation();
     Matrix forward(const Matrix &input) override;
     Matrix backward(const Matrix &d_output) override;
+    void forward_in_place(Matrix &values) override;
+    void backward_in_place(const Matrix &output, Matrix &gradient) override;
+    std::string name() const override;
 };
 
 #endif // LINEAR_ACTIVATION_HPP
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef TANH_HPP
+#define TANH_HPP
+
+#include "Activation.hpp"
+
+class Tanh : public Activation
+{
+public:
+    Tanh();
+    Matrix forward(const Matrix &input) override;
+    Matrix backward(const Matrix &d_output) override;
+    void forward_in_place(Matrix &values) override;
+    void backward_in_place(const Matrix &output, Matrix &gradient) override;
+    std::string name() const override;
+
+private:
+    Matrix m_output;
+};
+
+#endif // TANH_HPP
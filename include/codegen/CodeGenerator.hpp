@@ -0,0 +1,49 @@
+#ifndef CODE_GENERATOR_HPP
+#define CODE_GENERATOR_HPP
+
+#include "Model.hpp"
+#include <string>
+
+// Ahead-of-time compilation of a trained Model into a self-contained C++17
+// header for embedding in other programs. The header holds the weights as
+// aligned constexpr arrays and one predict() whose loops all have constant
+// trip counts, so the compiler specializes it to the model's exact shape. It
+// needs no Matrix, no virtual calls and no heap: activations live on the stack.
+//
+// Like the int8 and sparse models, the generated code takes raw features: the
+// preprocessing is folded into the first layer.
+class CodeGenerator
+{
+public:
+    // A preprocessed row is (x - shift) * scale (1 x features each), which is what model expects.
+    // The code goes in namespace `name`, which must be a C++ identifier.
+    CodeGenerator(Model &model, const Matrix &shift, const Matrix &scale, const std::string &name);
+
+    std::string header() const;
+    void write_header(const std::string &filename) const;
+
+    // Compiles a driver for the header at header_path with `compiler` (a shell
+    // command, e.g. "c++ -O2 -march=native"), runs it over every row of input
+    // one predict() call at a time, and returns microseconds per row. Sets
+    // largest_difference to the largest deviation from expected.
+    double benchmark(const std::string &header_path, const std::string &compiler, const Matrix &input,
+                     const Matrix &expected, double &largest_difference) const;
+
+    // A namespace name derived from a file name: "models/mnist-v2.hpp" -> "mnist_v2"
+    static std::string identifier_for(const std::string &filename);
+
+private:
+    struct Layer
+    {
+        int inputs;
+        int outputs;
+        std::string activation;
+        Matrix weights; // inputs x outputs
+        Matrix biases;
+    };
+
+    std::string m_name;
+    std::vector<Layer> m_layers;
+};
+
+#endif // CODE_GENERATOR_HPP
@@ -0,0 +1,38 @@
+#ifndef LOW_RANK_HPP
+#define LOW_RANK_HPP
+
+#include "layers/DenseLayer.hpp"
+#include <vector>
+
+// matrix = left * diag(singular) * right^T, with singular values in decreasing
+// order. left is rows x k, right is cols x k, k = min(rows, cols).
+struct SingularValueDecomposition
+{
+    Matrix left;
+    std::vector<double> singular;
+    Matrix right;
+};
+
+// One-sided Jacobi SVD: accurate to working precision, and fast enough for the
+// few hundred columns of a dense layer
+SingularValueDecomposition singular_value_decomposition(const Matrix &matrix);
+
+// Smallest rank whose leading singular values hold the fraction `energy` of the
+// squared Frobenius norm (at least 1)
+int rank_for_energy(const std::vector<double> &singular, double energy);
+// Fraction of the squared Frobenius norm held by the leading `rank` singular values
+double retained_energy(const std::vector<double> &singular, int rank);
+
+// Whether a rank-`rank` factorization of an inputs x outputs layer needs fewer
+// multiply-adds per row than the layer itself
+bool factorization_saves_work(int inputs, int outputs, int rank);
+
+// Truncated SVD of layer's weights as two layers: a linear bottleneck of `rank`
+// units whose biases start at zero (and train like any others when the model
+// is fine-tuned), then the layer's biases and activation. Both factors get
+// sqrt of the singular values, so they train at similar scales. The layers are
+// plain DenseLayers, so a factorized model saves and loads like any other.
+std::vector<DenseLayer> factorize_layer(const DenseLayer &layer, int rank);
+std::vector<DenseLayer> factorize_layer(const DenseLayer &layer, const SingularValueDecomposition &svd, int rank);
+
+#endif // LOW_RANK_HPP
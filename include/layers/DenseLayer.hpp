@@ -3,13 +3,21 @@
 
 #include "Matrix.hpp"
 #include "activations/Activation.hpp"
+#include "precision/BFloat16.hpp"
 #include "regularizers/Regularizer.hpp"
 #include <memory>
 
 enum class WeightInitType
 {
     RANDOM, // Our original method
-    HE      // The new, better method for ReLU
+    HE,     // The new, better method for ReLU
+    ZERO    // Parameters are about to be loaded from a file
+};
+
+enum class Precision
+{
+    DOUBLE, // Everything in double
+    BF16    // GEMM operands and the cached input in bfloat16, float32 accumulation
 };
 
 class DenseLayer
@@ -18,9 +26,17 @@ public:
     DenseLayer(int inputSize, int outputSize, std::shared_ptr<Activation> activation,
                std::shared_ptr<Regularizer> regularizer = nullptr,
                WeightInitType init_type = WeightInitType::HE);
+    // Wraps existing parameters (moved in, so views over external storage stay views).
+    // Gradient buffers are only allocated by the first backward pass.
+    DenseLayer(Matrix weights, Matrix biases, std::shared_ptr<Activation> activation,
+               std::shared_ptr<Regularizer> regularizer = nullptr);
 
     Matrix forward(const Matrix &inputData);
-    Matrix backward(const Matrix &d_output);
+    // Returns the gradient for the previous layer, or an empty matrix without
+    // input_gradient (the first layer has no use for it). Without regularize the
+    // weight gradient leaves out the regularizer's penalty, for trainers that
+    // add it once after combining gradients of parts of a batch.
+    Matrix backward(const Matrix &d_output, bool input_gradient = true, bool regularize = true);
 
     // Getters
     Matrix &getWeights();
@@ -33,13 +49,25 @@ public:
     std::shared_ptr<Activation> getActivation() const;
     const Matrix &getWeightsGradient() const;
     const Matrix &getBiasesGradient() const;
+    // Writable gradient buffers, sized to the parameters, for trainers that
+    // assemble gradients outside backward() (e.g. a data-parallel all-reduce)
+    Matrix &getWeightsGradient();
+    Matrix &getBiasesGradient();
     std::shared_ptr<Regularizer> getRegularizer() const;
 
     // Setters
     void setWeights(const Matrix &weights);
     void setBiases(const Matrix &biases);
 
+    // Mixed precision: the weights stay double (the master copy the optimizer
+    // updates); each pass multiplies bfloat16 copies of the operands
+    void setPrecision(Precision precision);
+    Precision getPrecision() const;
+
 private:
+    Matrix forward_bf16(const Matrix &inputData);
+    Matrix backward_bf16(const Matrix &d_linear, bool input_gradient, bool regularize);
+
     Matrix m_weights;
     Matrix m_biases;
     std::shared_ptr<Activation> m_activation;
@@ -48,6 +76,11 @@ private:
 
     Matrix m_d_weights;
     Matrix m_d_biases;
+
+    Precision m_precision;
+    BF16Matrix m_bf16_input_t; // Cached input, transposed, in place of m_input
+    BF16Matrix m_bf16_operand; // The pass's other bf16 operands, released once used
+    BF16Matrix m_bf16_weights;
 };
 
 #endif // DENSE_LAYER_HPP
@@ -7,6 +7,9 @@ class CategoricalCrossEntropy : public Loss {
 public:
     double calculate(const Matrix& y_pred, const Matrix& y_true) override;
     Matrix backward(const Matrix& y_pred, const Matrix& y_true) override;
+    void backward_into(const Matrix& y_pred, const Matrix& y_true, Matrix& gradient) override;
+    // y_pred - y_true summed over the rows, not averaged
+    bool gradient_is_mean() const override;
 };
 
 #endif // CATEGORICAL_CROSS_ENTROPY_HPP
\ No newline at end of file
@@ -13,6 +13,14 @@ public:
 
     // Calculates the gradient of the loss with respect to the predictions
     virtual Matrix backward(const Matrix &y_pred, const Matrix &y_true) = 0;
+    // backward() into an existing buffer of the predictions' shape (see ExecutionPlan).
+    // The default copies the result of backward().
+    virtual void backward_into(const Matrix &y_pred, const Matrix &y_true, Matrix &gradient);
+
+    // Whether backward() is the gradient of the mean over the batch's rows
+    // rather than of their sum. Trainers combining gradients of parts of a
+    // batch weight them by the part's share of the rows only when it is.
+    virtual bool gradient_is_mean() const;
 };
 
 #endif // LOSS_HPP
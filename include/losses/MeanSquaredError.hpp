@@ -7,6 +7,7 @@ class MeanSquaredError : public Loss {
 public:
     double calculate(const Matrix& y_pred, const Matrix& y_true) override;
     Matrix backward(const Matrix& y_pred, const Matrix& y_true) override;
+    void backward_into(const Matrix& y_pred, const Matrix& y_true, Matrix& gradient) override;
 };
 
 #endif // MEAN_SQUARED_ERROR_HPP
\ No newline at end of file
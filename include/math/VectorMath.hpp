@@ -0,0 +1,31 @@
+#ifndef VECTOR_MATH_HPP
+#define VECTOR_MATH_HPP
+
+#include <cstddef>
+#include <string>
+
+// Elementwise transcendental functions over arrays of doubles, several values
+// per instruction. out may be the same array as in.
+//
+// Largest errors against a long double reference: exp 1 ulp, log 1 ulp,
+// tanh 3 ulp, sigmoid 3 ulp (see `--benchmark math`). The whole double range
+// is handled: exp overflows to inf and underflows through the subnormals to
+// 0, log(0) is -inf and log of a negative NaN, and NaN gives NaN.
+void vector_exp(const double *in, double *out, size_t n);
+void vector_log(const double *in, double *out, size_t n);
+void vector_tanh(const double *in, double *out, size_t n);
+void vector_sigmoid(const double *in, double *out, size_t n);
+// GELU in its tanh form, 0.5 x (1 + tanh(sqrt(2/pi) (x + 0.044715 x^3))),
+// and its derivative
+void vector_gelu(const double *in, double *out, size_t n);
+void vector_gelu_derivative(const double *in, double *out, size_t n);
+
+// Softmax of one row of n > 0 values, shifted by their max for stability:
+// exponentials within 1 ulp, summed lane by lane, scaled by 1 / sum
+void vector_softmax(const double *in, double *out, size_t n);
+
+// Kernel in use: "avx512", "avx2" (with FMA) or "generic" (two lanes). The
+// MLP_MATH_KERNEL environment variable overrides the choice.
+std::string math_kernel_name();
+
+#endif // VECTOR_MATH_HPP
@@ -11,6 +11,10 @@ public:
 
     void step() override;
 
+    // Moments are stored per layer as m_weights, v_weights, m_biases, v_biases
+    OptimizerState getState() const override;
+    void setState(const OptimizerState &state) override;
+
 private:
     double m_beta1;
     double m_beta2;
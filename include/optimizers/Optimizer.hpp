@@ -2,8 +2,17 @@
 #define OPTIMIZER_HPP
 
 #include "layers/DenseLayer.hpp"
+#include <string>
 #include <vector>
 
+// Internal optimizer state (step count and per-parameter buffers), for checkpoints
+struct OptimizerState
+{
+    std::string name;
+    int step = 0;
+    std::vector<Matrix> tensors;
+};
+
 class Optimizer
 {
 public:
@@ -12,6 +21,10 @@ public:
 
     virtual void step() = 0;
 
+    // Copy of the state needed to resume training exactly; stateless by default
+    virtual OptimizerState getState() const;
+    virtual void setState(const OptimizerState &state);
+
 protected:
     std::vector<DenseLayer> &m_layers;
     double m_learning_rate;
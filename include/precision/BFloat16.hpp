@@ -0,0 +1,64 @@
+#ifndef BFLOAT16_HPP
+#define BFLOAT16_HPP
+
+#include "Matrix.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// bfloat16: the top 16 bits of a float32. Same exponent range as float32,
+// 8 bits of mantissa. Rounds to nearest even; NaN stays NaN.
+inline uint16_t to_bf16(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u)
+        return static_cast<uint16_t>((bits >> 16) | 0x40u);
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+inline float from_bf16(uint16_t value)
+{
+    uint32_t bits = static_cast<uint32_t>(value) << 16;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// Row-major bfloat16 copy of a Matrix, as a GEMM operand. Rows are zero-padded
+// to a multiple of 32 values (one 512-bit dot-product step), and the row count
+// to a multiple of 4, so kernels need no tail handling.
+class BF16Matrix
+{
+public:
+    BF16Matrix();
+
+    // Rounds source, or its transpose, into this matrix; storage is reused
+    void pack(const Matrix &source, bool transpose = false);
+    void clear();
+
+    int getRows() const;
+    int getCols() const;
+    size_t getStride() const;
+    const uint16_t *row(int r) const;
+    // Bytes held, padding included
+    size_t bytes() const;
+
+private:
+    int m_rows;
+    int m_cols;
+    size_t m_stride;
+    std::vector<uint16_t> m_data;
+};
+
+// c = a * b^T for a (m x k) and b (n x k), with products accumulated in float32.
+// c must be m x n.
+void gemm_bf16_nt(const BF16Matrix &a, const BF16Matrix &b, Matrix &c);
+
+// Dot-product kernel in use: "avx512bf16" (native vdpbf16ps) or "software".
+// The MLP_BF16_KERNEL environment variable overrides the choice.
+std::string bf16_kernel_name();
+
+#endif // BFLOAT16_HPP
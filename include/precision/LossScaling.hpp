@@ -0,0 +1,61 @@
+#ifndef LOSS_SCALING_HPP
+#define LOSS_SCALING_HPP
+
+#include "losses/Loss.hpp"
+#include "optimizers/Optimizer.hpp"
+
+// Dynamic loss scaling for reduced-precision backward passes. The loss
+// gradient is multiplied by the scale before backward, so small gradients keep
+// their significant bits, and the weight gradients are divided by it before
+// the optimizer step. A step whose gradients overflowed is skipped and the
+// scale halved; after growth_interval good steps in a row the scale doubles.
+class LossScaler
+{
+public:
+    explicit LossScaler(double initial_scale = 65536.0, int growth_interval = 1000);
+
+    double getScale() const;
+    long long getSkippedSteps() const;
+
+    // Divides every layer's gradients by the scale and updates the scale.
+    // Returns false, leaving the gradients alone, if any was not finite.
+    bool unscale(std::vector<DenseLayer> &layers);
+
+private:
+    double m_scale;
+    int m_growth_interval;
+    int m_good_steps;
+    long long m_skipped;
+};
+
+// Loss whose gradient carries the scaler's current scale
+class ScaledLoss : public Loss
+{
+public:
+    ScaledLoss(Loss &loss, const LossScaler &scaler);
+
+    double calculate(const Matrix &y_pred, const Matrix &y_true) override;
+    Matrix backward(const Matrix &y_pred, const Matrix &y_true) override;
+
+private:
+    Loss &m_loss;
+    const LossScaler &m_scaler;
+};
+
+// Unscales the gradients, then steps the wrapped optimizer unless they overflowed.
+// State (for checkpoints) is the wrapped optimizer's.
+class ScaledOptimizer : public Optimizer
+{
+public:
+    ScaledOptimizer(std::vector<DenseLayer> &layers, Optimizer &optimizer, LossScaler &scaler);
+
+    void step() override;
+    OptimizerState getState() const override;
+    void setState(const OptimizerState &state) override;
+
+private:
+    Optimizer &m_optimizer;
+    LossScaler &m_scaler;
+};
+
+#endif // LOSS_SCALING_HPP
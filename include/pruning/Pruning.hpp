@@ -0,0 +1,54 @@
+#ifndef PRUNING_HPP
+#define PRUNING_HPP
+
+#include "optimizers/Optimizer.hpp"
+#include <cstdint>
+#include <vector>
+
+// Side of the square weight blocks that block pruning removes together, and
+// that the block-sparse format stores
+const int kSparseBlock = 4;
+
+// Which weights of each layer survived pruning. Biases are never pruned.
+class PruningMask
+{
+public:
+    PruningMask() = default;
+
+    // Zeroes, in every layer, the fraction `sparsity` of weights with the smallest
+    // magnitude. With blocks, kSparseBlock x kSparseBlock blocks are ranked by
+    // their L2 norm and removed whole. Weights that are already zero go first,
+    // so pruning again to a higher sparsity extends the previous mask.
+    static PruningMask by_sparsity(std::vector<DenseLayer> &layers, double sparsity, bool blocks = false);
+    // Zeroes every weight with |w| < threshold
+    static PruningMask by_threshold(std::vector<DenseLayer> &layers, double threshold);
+
+    // Re-zeroes the pruned weights, or their gradients
+    void apply(std::vector<DenseLayer> &layers) const;
+    void apply_to_gradients(std::vector<DenseLayer> &layers) const;
+
+private:
+    std::vector<std::vector<uint8_t>> m_keep; // Per layer, per weight (row-major)
+};
+
+// Fraction of all weights (not biases) that are zero
+double weight_sparsity(const std::vector<DenseLayer> &layers);
+
+// Fine-tuning with a frozen mask: pruned weights get no gradient and are
+// zeroed again after every step of the wrapped optimizer, so momentum cannot
+// revive them. State (for checkpoints) is the wrapped optimizer's.
+class MaskedOptimizer : public Optimizer
+{
+public:
+    MaskedOptimizer(std::vector<DenseLayer> &layers, Optimizer &optimizer, const PruningMask &mask);
+
+    void step() override;
+    OptimizerState getState() const override;
+    void setState(const OptimizerState &state) override;
+
+private:
+    Optimizer &m_optimizer;
+    const PruningMask &m_mask;
+};
+
+#endif // PRUNING_HPP
@@ -0,0 +1,70 @@
+#ifndef SPARSE_MODEL_HPP
+#define SPARSE_MODEL_HPP
+
+#include "Model.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class SparseFormat
+{
+    CSR, // Compressed sparse rows: one (input, weight) pair per nonzero weight
+    BSR  // Block-sparse rows: dense kSparseBlock x kSparseBlock blocks, for block-pruned layers
+};
+
+// Inference-only copy of a pruned Model in which zero weights take neither
+// memory nor time. Each layer stores W^T (one row per output) in the chosen
+// format. Rows are processed in tiles: the tile is transposed once, so every
+// nonzero weight scales a contiguous run of the tile's values, which the
+// compiler vectorizes, and layers pass the tile on still transposed.
+//
+// Like a quantized model, it takes raw features: the preprocessing is folded
+// into the first layer (a per-input scale keeps zeros zero).
+class SparseModel
+{
+public:
+    // A preprocessed row is (x - shift) * scale (1 x features each), which is what model expects
+    static SparseModel from_model(Model &model, const Matrix &shift, const Matrix &scale, SparseFormat format);
+
+    // Outputs for every row of raw features; tiles are split across threads
+    Matrix predict(const Matrix &input) const;
+
+    // Checksummed binary format (conventionally ".sparse")
+    void save(const std::string &filename) const;
+    static SparseModel from_file(const std::string &filename);
+    static bool is_sparse_file(const std::string &filename);
+
+    int getInputSize() const;
+    int getOutputSize() const;
+    // Bytes of stored weights, indices and biases
+    size_t parameter_bytes() const;
+    // Weights stored (with block padding) over weights of the dense layers
+    double density() const;
+    // Hash of the stored parameters, e.g. to key cached predictions
+    uint64_t fingerprint() const;
+
+private:
+    struct Layer
+    {
+        int inputs;
+        int outputs;
+        std::string activation;
+        SparseFormat format;
+        // CSR: row_start[o]..row_start[o + 1] index the nonzeros of output o.
+        // BSR: the same over block rows of kSparseBlock outputs; each entry is
+        // a block of kSparseBlock x kSparseBlock values, row-major.
+        std::vector<int32_t> row_start;
+        std::vector<int32_t> column; // Input index (CSR) or first input of the block (BSR)
+        std::vector<double> values;
+        std::vector<double> biases;
+    };
+
+    SparseModel();
+    std::vector<char> serialize() const;
+    void deserialize(const std::vector<char> &payload);
+
+    int m_input_size;
+    std::vector<Layer> m_layers;
+};
+
+#endif // SPARSE_MODEL_HPP
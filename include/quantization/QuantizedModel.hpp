@@ -0,0 +1,78 @@
+#ifndef QUANTIZED_MODEL_HPP
+#define QUANTIZED_MODEL_HPP
+
+#include "Model.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Post-training int8 version of a Model, for inference only.
+//
+// Weights are quantized symmetrically per output channel to [-127, 127].
+// Layer inputs are quantized per tensor to [0, 127] with a zero point, using
+// the range each layer's input took on a calibration sample. Only 7 bits are
+// used so that the AVX2 maddubs kernel, which sums pairs of u8 x s8 products
+// into saturating 16-bit lanes, can never saturate.
+//
+// A layer's int32 accumulators go through one fused epilogue: bias add,
+// ReLU and requantization to the next layer's input are a single
+// multiply-add and clamp per output. The last layer dequantizes to doubles
+// and applies its activation (softmax or linear) as the double model does.
+//
+// The model takes raw features: the preprocessing it was quantized with is
+// folded into the quantization of the first layer's input.
+class QuantizedModel
+{
+public:
+    // calibration holds raw feature rows; a preprocessed row is (x - shift) * scale
+    // (1 x features each), which is what model itself expects
+    static QuantizedModel quantize(Model &model, const Matrix &calibration, const Matrix &shift, const Matrix &scale);
+
+    // Outputs for every row of raw features; rows are split across threads
+    Matrix predict(const Matrix &input) const;
+
+    // Checksummed binary format (conventionally ".q8")
+    void save(const std::string &filename) const;
+    static QuantizedModel from_file(const std::string &filename);
+    static bool is_quantized_file(const std::string &filename);
+
+    int getInputSize() const;
+    int getOutputSize() const;
+    // Bytes of weights, per-channel factors and input quantization parameters
+    size_t parameter_bytes() const;
+    // Hash of the quantized parameters, e.g. to key cached predictions
+    uint64_t fingerprint() const;
+
+    // Dot-product kernel picked for this CPU: "vnni", "avx2" or "scalar".
+    // The MLP_INT8_KERNEL environment variable overrides the choice.
+    static std::string kernel_name();
+
+private:
+    struct Layer
+    {
+        int inputs;
+        int outputs;
+        int stride; // inputs rounded up to the kernel width; the padding weights are zero
+        std::string activation;
+        // Output-major, outputs rounded up to a multiple of 4 rows of stride weights
+        std::vector<int8_t> weights;
+        // Epilogue per output: v = acc * multiplier + offset. Hidden layers
+        // round v and clamp it to [clamp_low, 127] (clamp_low is the next zero
+        // point under ReLU); the last layer's v is the dequantized output.
+        std::vector<float> multiplier;
+        std::vector<float> offset;
+        int clamp_low;
+    };
+
+    QuantizedModel();
+    std::vector<char> serialize() const;
+    void deserialize(const std::vector<char> &payload);
+
+    int m_input_size;
+    // First-layer input quantization from raw features: q = x * mul + add
+    std::vector<float> m_input_mul;
+    std::vector<float> m_input_add;
+    std::vector<Layer> m_layers;
+};
+
+#endif // QUANTIZED_MODEL_HPP
@@ -10,6 +10,9 @@ public:
     ElasticNetRegularizer(double lambda1, double lambda2);
     double loss(const Matrix &weights) override;
     Matrix gradient(const Matrix &weights) override;
+    void add_gradient(const Matrix &weights, Matrix &gradient) override;
+    std::string name() const override;
+    std::vector<double> parameters() const override;
 
 private:
     double m_lambda1;
@@ -2,6 +2,9 @@
 #define REGULARIZER_HPP
 
 #include "Matrix.hpp"
+#include <memory>
+#include <string>
+#include <vector>
 
 class Regularizer
 {
@@ -9,6 +12,15 @@ public:
     virtual ~Regularizer() = default;
     virtual double loss(const Matrix &weights) = 0;
     virtual Matrix gradient(const Matrix &weights) = 0;
+    // gradient += gradient(weights), without a temporary where the penalty allows
+    virtual void add_gradient(const Matrix &weights, Matrix &gradient);
+
+    // Identifier and hyperparameters, as recorded in model files
+    virtual std::string name() const = 0;
+    virtual std::vector<double> parameters() const = 0;
+
+    // Rebuilds a regularizer from its name and parameters; "none" gives nullptr
+    static std::shared_ptr<Regularizer> create(const std::string &name, const std::vector<double> &parameters);
 };
 
 #endif // REGULARIZER_HPP
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef INFERENCE_SERVER_HPP
+#define INFERENCE_SERVER_HPP
+
+#include "utils/StreamingPredictor.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-running prediction server for a model that is loaded once. Clients
+// connect to a Unix domain socket and send one request per line: the raw
+// feature values, comma-separated. Each gets one line back: the output
+// values, or "error: <reason>". A client may send many lines without waiting;
+// replies come back in request order. The line "stats" returns the latency
+// report.
+//
+// Requests from all connections go to one batcher thread. It waits for up to
+// max_latency_ms after the oldest pending request, or until max_batch requests
+// are pending, and answers them all with one batched forward pass. Latency
+// is recorded per request in two parts: queueing (arrival to batch start) and
+// compute (the batch's forward pass).
+class InferenceServer
+{
+public:
+    // infer runs on the batcher thread only, so it need not be thread-safe
+    InferenceServer(ChunkInference infer, int input_size, int max_batch = 64, double max_latency_ms = 2.0);
+    ~InferenceServer();
+
+    InferenceServer(const InferenceServer &) = delete;
+    InferenceServer &operator=(const InferenceServer &) = delete;
+
+    // Accepts connections until stop(). Replaces a stale socket at path, but
+    // throws if path is some other file.
+    void serve(const std::string &socket_path);
+    // Makes serve() return soon. Only sets a flag, so it is safe in a signal handler.
+    void stop();
+
+    // Request count, batch sizes and latency percentiles, on one line
+    std::string stats() const;
+    // Appends source() to every stats() line (e.g. cache counters)
+    void add_stats_source(std::function<std::string()> source);
+
+private:
+    struct Request
+    {
+        std::vector<double> features;
+        std::chrono::steady_clock::time_point arrived;
+        std::promise<std::string> reply;
+    };
+
+    // Queues a request for the batcher; the future holds its reply line
+    std::future<std::string> submit(std::vector<double> features);
+    void batch_loop();
+    void run_batch(std::vector<std::unique_ptr<Request>> &batch);
+    void handle_connection(int fd);
+    std::future<std::string> handle_line(const std::string &line);
+    void record(double queue_ms, double compute_ms);
+
+    ChunkInference m_infer;
+    int m_input_size;
+    size_t m_max_batch;
+    std::chrono::microseconds m_max_latency;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::unique_ptr<Request>> m_pending;
+    bool m_closing; // Batcher drains what is pending and exits
+    std::atomic<bool> m_stop_requested;
+    std::thread m_batcher;
+
+    mutable std::mutex m_stats_mutex;
+    std::vector<double> m_queue_ms;   // Latest samples, a ring of kLatencyWindow
+    std::vector<double> m_compute_ms;
+    size_t m_next_sample;
+    long long m_requests;
+    long long m_batches;
+    std::vector<std::function<std::string()>> m_stats_sources;
+
+    std::mutex m_connections_mutex;
+    std::vector<int> m_connections; // Open client sockets, shut down on stop
+};
+
+#endif // INFERENCE_SERVER_HPP
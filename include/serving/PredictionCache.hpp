@@ -0,0 +1,74 @@
+#ifndef PREDICTION_CACHE_HPP
+#define PREDICTION_CACHE_HPP
+
+#include "Matrix.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// LRU cache of model outputs for traffic that repeats identical input rows.
+// Entries are content-addressed: the key hashes the input row as the model
+// sees it (after scaling), seeded with the model version, so a different
+// model never sees another's entries. The row itself is stored too, so a hash
+// collision is a miss rather than a wrong answer.
+//
+// The cache is split into shards, each with its own lock and LRU list, so
+// concurrent callers rarely contend. The memory cap is divided evenly
+// between the shards, and each evicts its least recently used entries.
+class PredictionCache
+{
+public:
+    PredictionCache(size_t max_bytes, uint64_t model_version, int shards = 16);
+
+    PredictionCache(const PredictionCache &) = delete;
+    PredictionCache &operator=(const PredictionCache &) = delete;
+
+    // Outputs for every row of input. Cached rows are copied; the rest go
+    // through forward() as one batch, and their outputs are cached.
+    Matrix predict(const Matrix &input, const std::function<Matrix(const Matrix &)> &forward);
+
+    // Copies the cached output for row into output (getOutputCols() values)
+    bool lookup(const double *row, int cols, double *output);
+    void insert(const double *row, int cols, const double *output, int output_cols);
+
+    int getOutputCols() const;
+    long long getHits() const;
+    long long getMisses() const;
+    size_t getEntries() const;
+    size_t getBytes() const;
+    // Hit and miss counters, hit rate and size, on one line
+    std::string stats() const;
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        std::vector<double> input;
+        std::vector<double> output;
+    };
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    uint64_t key_for(const double *row, int cols) const;
+    Shard &shard_for(uint64_t key);
+
+    uint64_t m_version;
+    size_t m_shard_capacity; // Bytes per shard
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<int> m_output_cols; // 0 until the first insert
+    std::atomic<long long> m_hits;
+    std::atomic<long long> m_misses;
+};
+
+#endif // PREDICTION_CACHE_HPP
@@ -0,0 +1,42 @@
+#ifndef DATA_PARALLEL_TRAINER_HPP
+#define DATA_PARALLEL_TRAINER_HPP
+
+#include "Model.hpp"
+#include "losses/Loss.hpp"
+#include "optimizers/Optimizer.hpp"
+#include <vector>
+
+// Synchronous data-parallel training on one host. Each worker thread owns a
+// replica of the layer stack and runs forward and backward on its shard of the
+// batch. The shard gradients are then all-reduced into the master model's
+// gradient buffers (see GradientReduction.hpp), the regularizers' penalty is
+// added once, and a single optimizer step updates the master weights.
+// Because the replicas share an address space, the all-reduce is a
+// reduce-scatter: each worker sums one slice of every gradient across all
+// replicas and writes it straight into the master buffer. No gather step is
+// needed.
+//
+// The model must keep its layer stack for the trainer's lifetime, and the loss
+// must be stateless, since all workers share it.
+class DataParallelTrainer
+{
+public:
+    // workers <= 0 uses one worker per hardware thread
+    DataParallelTrainer(Model &model, Loss &loss, int workers = 0);
+
+    // One training step on a batch, sharded by rows. Leaves the reduced
+    // gradients in the master layers, applies optimizer.step() and returns the
+    // batch loss.
+    double step(const Matrix &X, const Matrix &y, Optimizer &optimizer);
+
+    int getWorkers() const;
+
+private:
+    void all_reduce(int shards, const std::vector<int> &shard_rows, int total_rows);
+
+    Model &m_model;
+    Loss &m_loss;
+    std::vector<Model> m_replicas;
+};
+
+#endif // DATA_PARALLEL_TRAINER_HPP
@@ -0,0 +1,19 @@
+#ifndef GRADIENT_REDUCTION_HPP
+#define GRADIENT_REDUCTION_HPP
+
+#include "layers/DenseLayer.hpp"
+#include "losses/Loss.hpp"
+
+// Rules shared by the trainers that combine the gradients of parts of a batch
+// (data-parallel shards, process ranks, pipeline micro-batches) into the
+// gradient Model::backward gives on the whole batch.
+
+// Weight of the gradient of `rows` rows in a batch of `total_rows`: their share
+// of the batch when the loss's gradient is a mean over rows, 1 when it is a sum
+double part_gradient_weight(const Loss &loss, int rows, int total_rows);
+
+// Parts are backpropagated without the regularizer's penalty, which depends on
+// the weights alone; this adds it once to the combined weight gradient
+void add_regularizer_gradient(DenseLayer &layer);
+
+#endif // GRADIENT_REDUCTION_HPP
@@ -0,0 +1,50 @@
+#ifndef HOGWILD_TRAINER_HPP
+#define HOGWILD_TRAINER_HPP
+
+#include "Model.hpp"
+#include "losses/Loss.hpp"
+#include "optimizers/Optimizer.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Lock-free asynchronous mini-batch training (Hogwild). Every thread pulls
+// mini-batches from a shared queue, runs forward and backward on its own
+// activation state, and has its own optimizer apply the update straight to
+// the master model's weights. The racy, unsynchronized reads and writes are
+// deliberate. With sparse or weakly overlapping gradients, the lost updates
+// cost less convergence than locking would cost throughput.
+//
+// Each thread's optimizer keeps its own state, so with Adam every thread
+// tracks its own moment estimates. The master model must own its parameters
+// (not be mapped), and they must not be reassigned while the trainer exists,
+// because the worker replicas point into them.
+class HogwildTrainer
+{
+public:
+    using OptimizerFactory = std::function<std::unique_ptr<Optimizer>(std::vector<DenseLayer> &)>;
+
+    // threads <= 0 uses one thread per hardware thread
+    HogwildTrainer(Model &model, Loss &loss, OptimizerFactory make_optimizer,
+                   int threads = 0, int batch_size = 64);
+
+    // One shuffled pass over (X, y); returns the mean mini-batch loss
+    double epoch(const Matrix &X, const Matrix &y);
+
+    int getThreads() const;
+    int getBatchSize() const;
+
+private:
+    struct Worker
+    {
+        Model replica; // Layers are views onto the master parameters
+        std::unique_ptr<Optimizer> optimizer;
+    };
+
+    Model &m_model;
+    Loss &m_loss;
+    int m_batch_size;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+#endif // HOGWILD_TRAINER_HPP
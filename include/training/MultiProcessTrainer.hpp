@@ -0,0 +1,36 @@
+#ifndef MULTI_PROCESS_TRAINER_HPP
+#define MULTI_PROCESS_TRAINER_HPP
+
+#include "Model.hpp"
+#include "losses/Loss.hpp"
+#include "optimizers/Optimizer.hpp"
+#include "training/SharedMemoryGroup.hpp"
+#include <vector>
+
+// Synchronous data-parallel training across the processes of a
+// SharedMemoryGroup. Every rank holds a full replica (the group forks after
+// the model is built, so replicas start identical), runs forward and backward
+// on its shard of the batch, and all-reduces the gradients through the shared
+// segment (see GradientReduction.hpp), adding the regularizers' penalty only
+// after that. Every rank then applies the same optimizer step, so the replicas
+// stay identical without broadcasting any weights.
+class MultiProcessTrainer
+{
+public:
+    MultiProcessTrainer(Model &model, Loss &loss, SharedMemoryGroup &group);
+
+    // Values exchanged per step: every parameter plus the batch loss
+    static size_t buffer_size(Model &model);
+
+    // One training step on the full batch; each rank uses its own rows.
+    // Returns the batch loss, which is the same on every rank.
+    double step(const Matrix &X, const Matrix &y, Optimizer &optimizer);
+
+private:
+    Model &m_model;
+    Loss &m_loss;
+    SharedMemoryGroup &m_group;
+    std::vector<double> m_buffer; // Packed gradients, reused across steps
+};
+
+#endif // MULTI_PROCESS_TRAINER_HPP
@@ -0,0 +1,44 @@
+#ifndef PIPELINE_EXECUTOR_HPP
+#define PIPELINE_EXECUTOR_HPP
+
+#include "Model.hpp"
+#include "losses/Loss.hpp"
+#include <vector>
+
+// Pipeline-parallel execution of a Model's layer stack. Consecutive layers are
+// grouped into stages, balanced by weight count, and each stage runs on its own
+// thread. A batch is split into micro-batches that flow through the stages over
+// bounded queues, so different stages work on different micro-batches at the
+// same time (GPipe schedule: all forwards, then all backwards).
+//
+// Every in-flight micro-batch gets its own copy of the layers' activation
+// caches and gradients. Those copies are views onto the model's weights, so
+// the weights are never duplicated. The model must own its parameters (it must
+// not be mapped).
+class PipelineExecutor
+{
+public:
+    // stages <= 0 uses one stage per layer, capped by the hardware threads
+    PipelineExecutor(Model &model, int stages = 0, int micro_batches = 4, size_t queue_capacity = 2);
+
+    Matrix predict(const Matrix &input);
+    // Forward and backward pass over the batch. Leaves the same gradient as
+    // Model::backward on the whole batch in the model's layers, ready for an
+    // optimizer step. Returns the batch loss. The loss must be stateless.
+    double forward_backward(const Matrix &X, const Matrix &y, Loss &loss);
+
+    int getStages() const;
+    int getMicroBatches() const;
+
+private:
+    // Layer replicas for one micro-batch; weights are views onto the model's
+    std::vector<DenseLayer> make_replica() const;
+    int micro_batch_count(int rows) const;
+
+    Model &m_model;
+    std::vector<int> m_stage_begin; // First layer of each stage, plus an end marker
+    int m_micro_batches;
+    size_t m_queue_capacity;
+};
+
+#endif // PIPELINE_EXECUTOR_HPP
@@ -0,0 +1,62 @@
+#ifndef SHARED_MEMORY_GROUP_HPP
+#define SHARED_MEMORY_GROUP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/types.h>
+#include <vector>
+
+// A group of processes on one host that exchange data through a POSIX
+// shared-memory segment. launch() creates the segment and forks the other
+// ranks, so every process continues from the same point with the same
+// state. Collectives are a ring all-reduce over per-rank buffers in the
+// segment, separated by a lock-free barrier, with no sockets or network.
+//
+// The segment is unlinked as soon as it is mapped, so nothing is left
+// behind in /dev/shm when a run ends or crashes. If a rank dies, the others
+// notice at their next barrier and throw instead of hanging.
+class SharedMemoryGroup
+{
+public:
+    // Forks world - 1 children; the calling process becomes rank 0. Buffers hold
+    // `capacity` doubles, the largest all_reduce() the group will run. Call it
+    // before starting any threads.
+    static std::unique_ptr<SharedMemoryGroup> launch(int world, size_t capacity);
+    ~SharedMemoryGroup();
+
+    SharedMemoryGroup(const SharedMemoryGroup &) = delete;
+    SharedMemoryGroup &operator=(const SharedMemoryGroup &) = delete;
+
+    int rank() const;
+    int world() const;
+
+    void barrier();
+    // Sums data[0, count) element-wise across all ranks, in place on every rank
+    void all_reduce(double *data, size_t count);
+    // True on every rank if the flag is set on any rank
+    bool any(bool flag);
+
+    // Ends the group: other ranks exit the process here, rank 0 waits for
+    // them and throws if any of them failed
+    void finish();
+
+private:
+    struct Header;
+
+    SharedMemoryGroup(void *base, size_t bytes, int rank, int world, size_t capacity);
+    double *buffer(int rank) const;
+    void check_peers(uint32_t generation);
+
+    void *m_base;
+    size_t m_bytes;
+    Header *m_header;
+    int m_rank;
+    int m_world;
+    size_t m_capacity;
+    pid_t m_parent;                 // Rank 0's pid
+    std::vector<pid_t> m_children;  // Rank 0 only
+    bool m_finished;
+};
+
+#endif // SHARED_MEMORY_GROUP_HPP
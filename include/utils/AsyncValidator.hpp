@@ -0,0 +1,83 @@
+#ifndef ASYNC_VALIDATOR_HPP
+#define ASYNC_VALIDATOR_HPP
+
+#include "Model.hpp"
+#include "losses/Loss.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ValidationResult
+{
+    int epoch = -1;
+    double loss = 0.0;
+    double accuracy = 0.0; // Only set when class labels were given
+    // The parameters that were evaluated, valid until the validator's next call
+    const Model *snapshot = nullptr;
+};
+
+// Evaluates parameter snapshots on the validation set in a background thread,
+// so the next training epoch runs while the previous one is being validated.
+// Results come back in submission order. X_val and y_val are held by reference
+// and must outlive the validator.
+//
+// Snapshots live in a fixed pool of models, sized by the first submissions and
+// refilled in place after that, so validating every epoch allocates no
+// parameters. A snapshot is busy from submit() until its result is taken.
+class AsyncValidator
+{
+public:
+    // labels: raw class indices for accuracy, or an empty matrix to skip it
+    AsyncValidator(const Matrix &X_val, const Matrix &y_val, std::shared_ptr<Loss> loss,
+                   const Matrix &labels, size_t snapshots = 2);
+    ~AsyncValidator(); // Discards unfinished work and stops the worker
+
+    // Copies the model's parameters into a free snapshot (Model::copy_parameters)
+    // and queues it. Blocks while every snapshot is queued or being validated;
+    // returns false, queuing nothing, if one holds a result yet to be taken.
+    bool submit(int epoch, const Model &model);
+    // Takes the next finished result without blocking; false if none is ready
+    bool poll(ValidationResult &result);
+    // Blocks for the next result; false once nothing is outstanding
+    bool wait(ValidationResult &result);
+
+private:
+    struct Job
+    {
+        int epoch;
+        size_t snapshot;
+    };
+    struct Done
+    {
+        ValidationResult result;
+        size_t snapshot;
+    };
+
+    void run();
+    bool take(ValidationResult &result);
+    void release_taken();
+
+    const Matrix &m_X_val;
+    const Matrix &m_y_val;
+    std::shared_ptr<Loss> m_loss;
+    Matrix m_labels;
+    std::vector<Model> m_snapshots;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<size_t> m_free; // Snapshots ready to be refilled
+    bool m_has_taken;           // Whether m_taken is held by the last result handed out
+    size_t m_taken;
+    std::deque<Job> m_pending;
+    std::deque<Done> m_done;
+    std::exception_ptr m_error;
+    bool m_busy;
+    bool m_stop;
+    std::thread m_worker;
+};
+
+#endif // ASYNC_VALIDATOR_HPP
@@ -0,0 +1,61 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO with a fixed capacity, for handing work between pipeline
+// threads. push() waits while the queue is full, which applies backpressure
+// to the producer. pop() waits while it is empty. close() wakes everyone:
+// pushes fail from then on, and pops drain what is left and then fail.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity < 1 ? 1 : capacity), m_closed(false) {}
+
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this]()
+                        { return m_items.size() < m_capacity || m_closed; });
+        if (m_closed)
+            return false;
+        m_items.push_back(std::move(item));
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this]()
+                         { return !m_items.empty() || m_closed; });
+        if (m_items.empty())
+            return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_not_full.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+private:
+    size_t m_capacity;
+    bool m_closed;
+    std::deque<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+};
+
+#endif // BOUNDED_QUEUE_HPP
@@ -0,0 +1,56 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "Model.hpp"
+#include "optimizers/Optimizer.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Everything besides the weights needed to resume a run where it stopped
+struct TrainingState
+{
+    int epoch = -1;
+    OptimizerState optimizer;
+    std::string rng_state;
+};
+
+// Periodically writes full training checkpoints from a background thread.
+// A checkpoint is a regular text model file followed by a TRAINING_STATE
+// section, so it can be passed straight to --load. Files are written to a
+// temporary path and renamed into place, so a crash never leaves a torn file.
+class Checkpointer
+{
+public:
+    Checkpointer(const std::string &path, int every_epochs);
+    ~Checkpointer(); // Writes any pending checkpoint, then stops the worker
+
+    bool due(int epoch) const;
+    // Takes the snapshot and returns immediately. If the worker is still busy,
+    // a snapshot that has not started writing yet is replaced by the newer one.
+    void submit(Model snapshot, TrainingState state);
+    // Blocks until every submitted checkpoint is on disk
+    void flush();
+
+    // Reads the TRAINING_STATE section of a checkpoint; false for plain model files
+    static bool read_state(const std::string &path, TrainingState &state);
+    static void write(const std::string &path, const Model &model, const TrainingState &state);
+
+private:
+    void run();
+
+    std::string m_path;
+    int m_every;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::unique_ptr<Model> m_pending_model;
+    TrainingState m_pending_state;
+    bool m_busy;
+    bool m_stop;
+    std::thread m_worker;
+};
+
+#endif // CHECKPOINT_HPP
@@ -5,17 +5,32 @@
 #include <string>
 #include <vector>
 
-// Add this class declaration to DataHandler.hpp
+// Standardizes features to zero mean and unit variance.
+// Statistics are accumulated in a single row-major pass (Welford), split across
+// threads and merged with Chan's formula, so fit() can also be fed chunk by chunk.
 class StandardScaler
 {
 public:
     StandardScaler();
     void fit(const Matrix &data);
+    // Folds another chunk of rows into the running statistics (streaming fit).
+    void partial_fit(const Matrix &data);
+    void reset();
+    // Restores statistics saved with a model (mean and std are 1 x features)
+    void set_statistics(const Matrix &mean, const Matrix &std, long long count);
+
     Matrix transform(const Matrix &data) const;
+    void transform_inplace(Matrix &data) const;
     Matrix fit_transform(const Matrix &data);
 
+    const Matrix &getMean() const;
+    const Matrix &getStd() const;
+    long long getCount() const;
+
 private:
+    long long m_count;
     Matrix m_mean;
+    Matrix m_m2; // Sum of squared deviations from the running mean
     Matrix m_std;
 };
 
@@ -28,7 +43,15 @@ Matrix read_csv_boston(const std::string &filepath, int num_rows = -1);
 // Normalizes feature values from [0, 255] to [0, 1].
 void normalize_features(Matrix &features);
 
+// normalize_features as an affine (shift, scale) pair, for Model::fold_input_transform.
+std::pair<Matrix, Matrix> normalization_transform(int num_features);
+// A fitted StandardScaler as an affine (shift, scale) pair: shift = mean, scale = 1 / std.
+std::pair<Matrix, Matrix> scaler_transform(const StandardScaler &scaler);
+
 // Converts a column vector of labels to a one-hot encoded matrix.
 Matrix one_hot_encode(const Matrix &labels, int num_classes);
 
+// Copies the rows order[begin, end) of source into a new matrix (shuffled mini-batches).
+Matrix gather_rows(const Matrix &source, const std::vector<int> &order, size_t begin, size_t end);
+
 #endif // DATA_HANDLER_HPP
\ No newline at end of file
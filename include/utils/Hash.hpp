@@ -0,0 +1,49 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// FNV-1a over 64-bit words, like the binary model checksum, with a splitmix64
+// finalizer so that every bit of the result (shard selection uses the high
+// bits) depends on every input bit. Not cryptographic.
+inline uint64_t hash_finalize(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+inline uint64_t hash_doubles(const double *values, size_t count, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    uint64_t hash = seed;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t word;
+        std::memcpy(&word, values + i, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash_finalize(hash);
+}
+
+// The same over raw bytes; a tail shorter than a word is zero-padded
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i < sizeof(word) ? size - i : sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash_finalize(hash);
+}
+
+#endif // HASH_HPP
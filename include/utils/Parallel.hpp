@@ -0,0 +1,43 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Number of row chunks worth spawning threads for, given a minimum chunk size.
+inline int parallel_chunk_count(int rows, int min_rows_per_chunk)
+{
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    if (hw < 1)
+        hw = 1;
+    int by_size = rows / std::max(1, min_rows_per_chunk);
+    return std::max(1, std::min(hw, by_size));
+}
+
+// Splits [0, rows) into `chunks` contiguous ranges and runs func(chunk, begin, end)
+// on each, one thread per chunk. The calling thread handles the first chunk.
+template <typename Func>
+void parallel_for_chunks(int rows, int chunks, Func func)
+{
+    if (chunks <= 1)
+    {
+        func(0, 0, rows);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (int c = 1; c < chunks; ++c)
+    {
+        int begin = static_cast<int>(static_cast<long long>(rows) * c / chunks);
+        int end = static_cast<int>(static_cast<long long>(rows) * (c + 1) / chunks);
+        workers.emplace_back(func, c, begin, end);
+    }
+    func(0, 0, static_cast<int>(static_cast<long long>(rows) / chunks));
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,40 @@
+#ifndef PAYLOAD_READER_HPP
+#define PAYLOAD_READER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Bounds-checked reads from a loaded model payload. A read past the end
+// throws "<kind> file is truncated.", e.g. with kind "Sparse model".
+class PayloadReader
+{
+public:
+    PayloadReader(const std::vector<char> &payload, const std::string &kind)
+        : m_payload(payload), m_kind(kind), m_offset(0)
+    {
+    }
+
+    template <typename T>
+    void read(T *values, size_t count)
+    {
+        size_t bytes = count * sizeof(T);
+        if (bytes > m_payload.size() - m_offset)
+        {
+            throw std::runtime_error(m_kind + " file is truncated.");
+        }
+        std::memcpy(values, m_payload.data() + m_offset, bytes);
+        m_offset += bytes;
+    }
+
+    bool done() const { return m_offset == m_payload.size(); }
+
+private:
+    const std::vector<char> &m_payload;
+    std::string m_kind;
+    size_t m_offset;
+};
+
+#endif // PAYLOAD_READER_HPP
@@ -0,0 +1,16 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <random>
+#include <string>
+
+// Process-wide generator used for weight initialization (and anything else that
+// needs randomness), so runs can be seeded and checkpoints can capture its state.
+std::mt19937 &global_rng();
+void seed_global_rng(unsigned int seed);
+
+// Serialized generator state, as stored in checkpoints
+std::string save_rng_state();
+void restore_rng_state(const std::string &state);
+
+#endif // RANDOM_HPP
@@ -0,0 +1,113 @@
+#ifndef STREAMING_DATASET_HPP
+#define STREAMING_DATASET_HPP
+
+#include "Matrix.hpp"
+#include "utils/BoundedQueue.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// Where the target sits in each row of a dataset file
+enum class LabelColumn
+{
+    FIRST, // MNIST: label, pixel...
+    LAST   // Boston: feature..., MEDV
+};
+
+struct DataBatch
+{
+    Matrix features{0, 0};
+    Matrix labels{0, 0}; // One column
+};
+
+class RowSource;
+
+// Streams a dataset file in mini-batches without loading it. A prefetch thread
+// reads and parses the file ahead of the consumer into two batch slots, so I/O
+// overlaps with training, and memory stays at a few batches plus the optional
+// shuffle buffer however large the file is. Reads CSV files (header row, "NA"
+// read as 0) and the binary dataset format written by convert_csv(), detected
+// from the file contents.
+class StreamingDataset
+{
+public:
+    // shuffle_buffer > 0 shuffles rows within a window of that many rows.
+    // Every pass starts after the first skip_rows rows (held-out data).
+    StreamingDataset(const std::string &path, LabelColumn label, int batch_size,
+                     size_t shuffle_buffer = 0, long long skip_rows = 0);
+    ~StreamingDataset();
+
+    StreamingDataset(const StreamingDataset &) = delete;
+    StreamingDataset &operator=(const StreamingDataset &) = delete;
+
+    // Next batch of the current pass; false once the pass is over
+    bool next(DataBatch &batch);
+    // Starts another pass over the file, skipping what is left of this one
+    void rewind();
+
+    int getFeatureCount() const;
+    // Columns in a dataset file (label included), read from its header only
+    static int column_count(const std::string &path);
+
+    // Binary dataset: "MLPDATA" magic, version, column and row counts, then
+    // rows of doubles in file order. Parses the CSV once, streaming.
+    static void convert_csv(const std::string &csv_path, const std::string &binary_path);
+    static bool is_binary_file(const std::string &path);
+
+private:
+    void run();
+    void produce_pass();
+    void emit_row(const double *row, DataBatch &batch, int &filled);
+    bool flush_batch(DataBatch &batch, int &filled);
+
+    std::unique_ptr<RowSource> m_source;
+    LabelColumn m_label;
+    int m_batch_size;
+    size_t m_shuffle_buffer;
+    long long m_skip_rows;
+    std::mt19937 m_rng; // Seeded from global_rng(), used only by the prefetch thread
+
+    BoundedQueue<DataBatch> m_batches; // Two slots: one being filled, one being consumed
+    bool m_pass_done;                  // Consumer side: next() hit the end of the pass
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    int m_passes_requested;
+    int m_passes_started;
+    bool m_stop;
+    std::exception_ptr m_error; // Prefetch failure, rethrown by next()
+    std::thread m_worker;
+};
+
+// Writes a binary dataset file chunk by chunk, without knowing the row count up
+// front; close() fills it in. Files it writes can be streamed back.
+class DatasetWriter
+{
+public:
+    DatasetWriter(const std::string &path, int cols);
+    ~DatasetWriter();
+
+    DatasetWriter(const DatasetWriter &) = delete;
+    DatasetWriter &operator=(const DatasetWriter &) = delete;
+
+    // Appends `count` rows of `cols` doubles
+    void write(const double *rows, size_t count);
+    void close();
+
+private:
+    void write_header();
+
+    std::string m_path;
+    std::ofstream m_file;
+    int m_cols;
+    uint64_t m_rows;
+    bool m_closed;
+};
+
+#endif // STREAMING_DATASET_HPP
@@ -0,0 +1,35 @@
+#ifndef STREAMING_PREDICTOR_HPP
+#define STREAMING_PREDICTOR_HPP
+
+#include "Matrix.hpp"
+#include "utils/StreamingDataset.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+struct PredictionStats
+{
+    long long rows = 0;
+    double seconds = 0.0;
+    double rows_per_second = 0.0;
+};
+
+// Turns a chunk of raw features (modifiable in place) into the output rows
+using ChunkInference = std::function<Matrix(Matrix &features)>;
+// Sees every chunk's output rows and labels, in order; first_row is the
+// index of the chunk's first row in the input
+using ChunkObserver = std::function<void(const Matrix &output, const Matrix &labels, long long first_row)>;
+
+// Batch prediction over a dataset of any size in three pipelined stages: the
+// dataset's prefetch thread parses the next chunk, the calling thread runs
+// inference on the current one, and a writer thread writes the previous
+// chunk's output. Memory is bounded by a few chunks.
+//
+// Output goes to output_path, as CSV with the given column names or as a
+// binary dataset file when the path ends in ".bin". An empty path writes
+// nothing; observe() still sees every chunk.
+PredictionStats stream_predictions(StreamingDataset &input, const std::string &output_path,
+                                   const std::vector<std::string> &columns, const ChunkInference &infer,
+                                   const ChunkObserver &observe);
+
+#endif // STREAMING_PREDICTOR_HPP
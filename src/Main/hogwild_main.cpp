@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "Mains.hpp"
+#include "Model.hpp"
+#include "layers/DenseLayer.hpp"
+#include "activations/ReLU.hpp"
+#include "activations/Softmax.hpp"
+#include "losses/CategoricalCrossEntropy.hpp"
+#include "optimizers/Adam.hpp"
+#include "training/DataParallelTrainer.hpp"
+#include "training/HogwildTrainer.hpp"
+#include "utils/DataHandler.hpp"
+#include "utils/Evaluation.hpp"
+#include "utils/Random.hpp"
+
+namespace
+{
+struct CurvePoint
+{
+    double seconds; // Training time only; evaluation is not counted
+    double loss;
+    double accuracy;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+// Convergence per wall-clock second of Hogwild against synchronous mini-batch
+// training on the same data, starting weights, batch size and thread count.
+// The synchronous baseline all-reduces every mini-batch across the workers.
+int hogwild_benchmark(const std::string &dataset_path, int threads, int epochs, int batch_size)
+{
+    std::cout << "--- Hogwild vs Synchronous Training Benchmark ---" << std::endl;
+
+    auto all_data = read_csv_mnist(dataset_path);
+    int train_size = std::min(5000, all_data.first.getRows() - 1000);
+    if (train_size <= 0)
+    {
+        std::cerr << "Error: The benchmark needs more than 1000 rows of data." << std::endl;
+        return 1;
+    }
+    Matrix X_train = all_data.first.slice(0, train_size);
+    Matrix X_val = all_data.first.slice(train_size, train_size + 1000);
+    Matrix y_val_raw = all_data.second.slice(train_size, train_size + 1000);
+    normalize_features(X_train);
+    normalize_features(X_val);
+    Matrix y_train = one_hot_encode(all_data.second.slice(0, train_size), 10);
+    Matrix y_val = one_hot_encode(y_val_raw, 10);
+
+    const double learning_rate = 0.002;
+    Model initial;
+    initial.add(DenseLayer(X_train.getCols(), 128, std::make_shared<ReLU>()));
+    initial.add(DenseLayer(128, 10, std::make_shared<Softmax>()));
+    CategoricalCrossEntropy loss_fn;
+
+    auto evaluate = [&](Model &model, double seconds)
+    {
+        Matrix predictions = model.predict(X_val);
+        return CurvePoint{seconds, loss_fn.calculate(predictions, y_val), calculate_accuracy(predictions, y_val_raw)};
+    };
+
+    // --- Synchronous: every mini-batch is sharded, all-reduced and stepped once ---
+    Model sync_model = initial.snapshot();
+    Adam sync_optimizer(sync_model.getLayers(), learning_rate);
+    DataParallelTrainer sync_trainer(sync_model, loss_fn, threads);
+    std::vector<CurvePoint> sync_curve;
+    std::vector<int> order(train_size);
+    double sync_seconds = 0.0;
+    for (int epoch = 0; epoch < epochs; ++epoch)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), global_rng());
+        for (size_t begin = 0; begin < order.size(); begin += batch_size)
+        {
+            size_t end = std::min(begin + batch_size, order.size());
+            sync_trainer.step(gather_rows(X_train, order, begin, end), gather_rows(y_train, order, begin, end),
+                              sync_optimizer);
+        }
+        sync_seconds += seconds_since(start);
+        sync_curve.push_back(evaluate(sync_model, sync_seconds));
+    }
+
+    // --- Hogwild: threads update the shared weights without synchronizing ---
+    Model hogwild_model = initial.snapshot();
+    HogwildTrainer hogwild(hogwild_model, loss_fn, [learning_rate](std::vector<DenseLayer> &layers)
+                           { return std::unique_ptr<Optimizer>(new Adam(layers, learning_rate)); },
+                           threads, batch_size);
+    std::vector<CurvePoint> hogwild_curve;
+    double hogwild_seconds = 0.0;
+    for (int epoch = 0; epoch < epochs; ++epoch)
+    {
+        auto start = std::chrono::steady_clock::now();
+        hogwild.epoch(X_train, y_train);
+        hogwild_seconds += seconds_since(start);
+        hogwild_curve.push_back(evaluate(hogwild_model, hogwild_seconds));
+    }
+
+    std::cout << "Threads: " << hogwild.getThreads() << ", batch size: " << batch_size
+              << ", training rows: " << train_size << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "\nEpoch | Sync time (s) | Sync loss | Sync acc | Hogwild time (s) | Hogwild loss | Hogwild acc" << std::endl;
+    for (int epoch = 0; epoch < epochs; ++epoch)
+    {
+        const CurvePoint &s = sync_curve[epoch];
+        const CurvePoint &h = hogwild_curve[epoch];
+        std::cout << std::setw(5) << epoch << " | " << std::setw(13) << s.seconds << " | " << std::setw(9) << s.loss
+                  << " | " << std::setw(7) << s.accuracy * 100.0 << "% | " << std::setw(16) << h.seconds << " | "
+                  << std::setw(12) << h.loss << " | " << std::setw(10) << h.accuracy * 100.0 << "%" << std::endl;
+    }
+
+    double rows = static_cast<double>(train_size) * epochs;
+    std::cout << "\nSynchronous throughput: " << rows / sync_seconds << " rows/s" << std::endl;
+    std::cout << "Hogwild throughput:     " << rows / hogwild_seconds << " rows/s ("
+              << sync_seconds / hogwild_seconds << "x)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Mains.hpp"
+#include "Matrix.hpp"
+#include "activations/Softmax.hpp"
+#include "math/VectorMath.hpp"
+
+namespace
+{
+// Seconds per call of fn, timed over enough calls to fill about 0.2 s
+double time_per_call(const std::function<void()> &fn)
+{
+    fn();
+    int calls = 1;
+    while (true)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int c = 0; c < calls; ++c)
+            fn();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.2)
+            return seconds / calls;
+        calls *= 2;
+    }
+}
+
+// Distance from value to the exact result, in units in the last place of the
+// exact result rounded to double
+double ulp_error(double value, long double exact)
+{
+    double rounded = static_cast<double>(exact);
+    if (std::isnan(rounded) || std::isinf(rounded))
+        return value == rounded || (std::isnan(value) && std::isnan(rounded)) ? 0.0 : INFINITY;
+    double magnitude = std::fabs(rounded);
+    double ulp = std::nextafter(magnitude, INFINITY) - magnitude;
+    return static_cast<double>(std::fabs(static_cast<long double>(value) - exact) / ulp);
+}
+
+struct Function
+{
+    const char *name;
+    void (*vectorized)(const double *, double *, size_t);
+    double (*scalar)(double);
+    long double (*exact)(long double);
+    double low, high; // Test inputs are uniform over [low, high]
+    double bound;     // Documented in VectorMath.hpp, in ulp
+};
+
+// The previous Softmax: three passes per row, std::exp and a division per value
+void scalar_softmax(Matrix &values)
+{
+    for (int i = 0; i < values.getRows(); ++i)
+    {
+        double max_val = values(i, 0);
+        for (int j = 1; j < values.getCols(); ++j)
+            max_val = std::max(max_val, values(i, j));
+        double sum = 0.0;
+        for (int j = 0; j < values.getCols(); ++j)
+        {
+            values(i, j) = std::exp(values(i, j) - max_val);
+            sum += values(i, j);
+        }
+        for (int j = 0; j < values.getCols(); ++j)
+            values(i, j) /= sum;
+    }
+}
+} // namespace
+
+// Accuracy and throughput of the vectorized exp, log, tanh and sigmoid
+// against the C library, then Softmax on a wide layer before and after.
+// Returns 1 if an error exceeds its documented bound.
+int math_benchmark()
+{
+    std::cout << "--- Vectorized Math Benchmark (" << math_kernel_name() << " kernel) ---" << std::endl;
+
+    const Function functions[] = {
+        {"exp", vector_exp, [](double x) { return std::exp(x); }, [](long double x) { return std::exp(x); }, -745.0,
+         709.0, 1.0},
+        {"log", vector_log, [](double x) { return std::log(x); }, [](long double x) { return std::log(x); }, 1e-300,
+         1e3, 1.0},
+        {"tanh", vector_tanh, [](double x) { return std::tanh(x); }, [](long double x) { return std::tanh(x); }, -20.0,
+         20.0, 3.0},
+        {"sigmoid", vector_sigmoid, [](double x) { return 1.0 / (1.0 + std::exp(-x)); },
+         [](long double x) { return 1.0L / (1.0L + std::exp(-x)); }, -40.0, 40.0, 3.0},
+    };
+
+    const size_t samples = 1000000;
+    const size_t timed = 4096; // Values per timed call, small enough to stay in cache
+    std::mt19937_64 rng(42);
+    std::vector<double> input(samples), output(samples);
+    bool within_bounds = true;
+
+    std::cout << std::left << std::setw(10) << "Function" << std::setw(10) << "Max ulp" << std::setw(8) << "Bound"
+              << std::setw(16) << "std:: ns/value" << std::setw(16) << "Vector ns/value" << "Speedup" << std::endl;
+    std::cout << std::fixed;
+    for (const Function &function : functions)
+    {
+        // Half the inputs over the whole range, half near zero
+        std::uniform_real_distribution<double> wide(function.low, function.high);
+        std::uniform_real_distribution<double> narrow(std::max(function.low, -1.0), 1.0);
+        for (size_t i = 0; i < samples; ++i)
+            input[i] = i % 2 == 0 ? wide(rng) : narrow(rng);
+
+        function.vectorized(input.data(), output.data(), samples);
+        double max_error = 0.0;
+        for (size_t i = 0; i < samples; ++i)
+            max_error = std::max(max_error, ulp_error(output[i], function.exact(input[i])));
+        within_bounds = within_bounds && max_error <= function.bound;
+
+        double scalar_seconds = time_per_call([&]
+                                              {
+            for (size_t i = 0; i < timed; ++i)
+                output[i] = function.scalar(input[i]); });
+        double vector_seconds = time_per_call([&]
+                                              { function.vectorized(input.data(), output.data(), timed); });
+
+        std::cout << std::setw(10) << function.name << std::setprecision(2) << std::setw(10) << max_error
+                  << std::setprecision(0) << std::setw(8) << function.bound << std::setprecision(2) << std::setw(16)
+                  << scalar_seconds * 1e9 / timed << std::setw(16) << vector_seconds * 1e9 / timed << std::setprecision(1) << scalar_seconds / vector_seconds << "x" << std::endl;
+    }
+
+    // --- Softmax over a wide output layer ---
+    const int rows = 64, cols = 1000;
+    Matrix logits(rows, cols);
+    std::normal_distribution<double> normal(0.0, 4.0);
+    for (size_t i = 0; i < logits.size(); ++i)
+        logits.data()[i] = normal(rng);
+    Matrix before = logits, after = logits;
+    Softmax softmax;
+    double scalar_seconds = time_per_call([&]
+                                          {
+        before = logits;
+        scalar_softmax(before); });
+    double vector_seconds = time_per_call([&]
+                                          {
+        after = logits;
+        softmax.forward_in_place(after); });
+    double difference = 0.0;
+    for (size_t i = 0; i < before.size(); ++i)
+        difference = std::max(difference, std::fabs(before.data()[i] - after.data()[i]));
+
+    std::cout << "\nSoftmax, " << rows << " x " << cols << ": scalar " << std::setprecision(1)
+              << scalar_seconds * 1e6 << " us, vectorized " << vector_seconds * 1e6 << " us ("
+              << scalar_seconds / vector_seconds << "x), largest difference " << std::scientific
+              << std::setprecision(2) << difference << std::endl;
+
+    if (!within_bounds)
+    {
+        std::cerr << "Error: a kernel exceeds its documented error bound." << std::endl;
+        return 1;
+    }
+    std::cout << "All errors within the documented bounds" << std::endl;
+    return 0;
+}
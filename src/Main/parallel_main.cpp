@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Mains.hpp"
+#include "Model.hpp"
+#include "activations/Activation.hpp"
+#include "activations/LinearActivation.hpp"
+#include "activations/Softmax.hpp"
+#include "losses/CategoricalCrossEntropy.hpp"
+#include "losses/MeanSquaredError.hpp"
+#include "regularizers/L2Regularizer.hpp"
+#include "training/DataParallelTrainer.hpp"
+#include "training/MultiProcessTrainer.hpp"
+#include "training/PipelineExecutor.hpp"
+#include "utils/DataHandler.hpp"
+
+namespace
+{
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Leaves the gradients a trainer reduced in the layers, for comparison
+class KeepGradients : public Optimizer
+{
+public:
+    explicit KeepGradients(std::vector<DenseLayer> &layers) : Optimizer(layers, 0.0) {}
+    void step() override {}
+};
+
+// Largest difference between the two models' gradients, relative to the
+// largest gradient of the first
+double largest_gradient_difference(Model &reference, Model &other)
+{
+    double largest = 0.0, difference = 0.0;
+    for (size_t l = 0; l < reference.getLayers().size(); ++l)
+    {
+        const DenseLayer &a = reference.getLayers()[l];
+        const DenseLayer &b = other.getLayers()[l];
+        for (const auto &pair : {std::make_pair(&a.getWeightsGradient(), &b.getWeightsGradient()),
+                                 std::make_pair(&a.getBiasesGradient(), &b.getBiasesGradient())})
+        {
+            for (size_t i = 0; i < pair.first->size(); ++i)
+            {
+                largest = std::max(largest, std::fabs(pair.first->data()[i]));
+                difference = std::max(difference, std::fabs(pair.first->data()[i] - pair.second->data()[i]));
+            }
+        }
+    }
+    return largest > 0.0 ? difference / largest : difference;
+}
+} // namespace
+
+// Full-batch gradients of the Boston (MSE) or MNIST (cross-entropy) network
+// from the single-threaded Model and from the parallel trainers, from the same
+// weights, without and with L2 regularizers: time per step and how far the
+// gradients are from the Model's.
+// With processes > 1, MultiProcessTrainer runs too, and with pipeline_stages
+// a PipelineExecutor over micro_batches. Returns 1 if any differs by more
+// than rounding.
+int parallel_benchmark(const std::string &task, const std::string &dataset_path, int epochs, int workers,
+                       int processes, int pipeline_stages, int micro_batches)
+{
+    std::cout << "--- Parallel Training Gradient Benchmark (" << task << ") ---" << std::endl;
+
+    Matrix X(0, 0), y(0, 0);
+    Model model;
+    std::unique_ptr<Loss> loss_fn;
+    if (task == "boston")
+    {
+        Matrix data = read_csv_boston(dataset_path.empty() ? "data/boston_housing.csv" : dataset_path);
+        int features = data.getCols() - 1;
+        X = Matrix(data.getRows(), features);
+        y = Matrix(data.getRows(), 1);
+        for (int i = 0; i < data.getRows(); ++i)
+        {
+            for (int j = 0; j < features; ++j)
+                X(i, j) = data(i, j);
+            y(i, 0) = data(i, features);
+        }
+        StandardScaler scaler;
+        X = scaler.fit_transform(X);
+        model.add(DenseLayer(features, 64, Activation::create("relu")));
+        model.add(DenseLayer(64, 64, Activation::create("relu")));
+        model.add(DenseLayer(64, 1, std::make_shared<LinearActivation>()));
+        loss_fn.reset(new MeanSquaredError());
+    }
+    else
+    {
+        auto all_data = read_csv_mnist(dataset_path.empty() ? "data/mnist_train.csv" : dataset_path);
+        int rows = std::min(1000, all_data.first.getRows());
+        X = all_data.first.slice(0, rows);
+        normalize_features(X);
+        y = one_hot_encode(all_data.second.slice(0, rows), 10);
+        model.add(DenseLayer(X.getCols(), 128, Activation::create("relu")));
+        model.add(DenseLayer(128, 10, std::make_shared<Softmax>()));
+        loss_fn.reset(new CategoricalCrossEntropy());
+    }
+    const int steps = std::max(1, epochs);
+    std::cout << "Rows: " << X.getRows() << ", steps: " << steps << std::endl;
+
+    // The same weights with an L2 penalty on every layer, which the trainers
+    // must add once rather than once per part of the batch
+    Model regularized;
+    for (const DenseLayer &layer : model.getLayers())
+    {
+        regularized.add(DenseLayer(layer.getWeights(), layer.getBiases(),
+                                   Activation::create(layer.getActivation()->name()),
+                                   std::make_shared<L2Regularizer>(1.0)));
+    }
+
+    bool within_rounding = true;
+    for (Model *network : {&model, &regularized})
+    {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << (network == &model ? "\nWithout regularizers" : "\nWith L2 regularizers") << std::endl;
+
+        // --- Model: the whole batch on one thread ---
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s)
+            network->backward(loss_fn->backward(network->predict(X), y));
+        double model_seconds = seconds_since(start);
+        std::cout << "Model: " << model_seconds * 1e3 / steps << " ms/step" << std::endl;
+
+        auto report = [&](const std::string &name, double seconds, Model &trained)
+        {
+            double difference = largest_gradient_difference(*network, trained);
+            within_rounding = within_rounding && difference <= 1e-9;
+            std::cout << name << ": " << seconds * 1e3 / steps << " ms/step (" << model_seconds / seconds
+                      << "x), largest gradient difference " << std::scientific << std::setprecision(2) << difference
+                      << std::fixed << std::setprecision(1) << std::endl;
+        };
+
+        // --- Multi-process: shards in forked processes, while no thread runs ---
+        if (processes > 1)
+        {
+            Model replica = network->snapshot();
+            auto group = SharedMemoryGroup::launch(processes, MultiProcessTrainer::buffer_size(replica));
+            MultiProcessTrainer trainer(replica, *loss_fn, *group);
+            KeepGradients keep(replica.getLayers());
+            start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; ++s)
+                trainer.step(X, y, keep);
+            double seconds = seconds_since(start);
+            group->finish(); // Only rank 0 continues
+            report("Multi-process, " + std::to_string(processes) + " processes", seconds, replica);
+        }
+
+        // --- Data-parallel: shards on worker threads, reduced into the master ---
+        {
+            Model master = network->snapshot();
+            DataParallelTrainer trainer(master, *loss_fn, workers);
+            KeepGradients keep(master.getLayers());
+            start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; ++s)
+                trainer.step(X, y, keep);
+            report("Data-parallel, " + std::to_string(trainer.getWorkers()) + " workers", seconds_since(start),
+                   master);
+        }
+
+        // --- Pipeline: micro-batches flowing through stages on their own threads ---
+        if (pipeline_stages > 0)
+        {
+            Model pipelined = network->snapshot();
+            PipelineExecutor pipeline(pipelined, pipeline_stages, micro_batches);
+            start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; ++s)
+                pipeline.forward_backward(X, y, *loss_fn);
+            report("Pipeline, " + std::to_string(pipeline.getStages()) + " stages, " +
+                       std::to_string(micro_batches) + " micro-batches",
+                   seconds_since(start), pipelined);
+        }
+    }
+
+    if (!within_rounding)
+    {
+        std::cerr << "Error: a parallel trainer's gradient differs from the single-threaded one." << std::endl;
+        return 1;
+    }
+    std::cout << "All gradients match the single-threaded Model" << std::endl;
+    return 0;
+}
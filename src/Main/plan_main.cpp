@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "Mains.hpp"
+#include "Model.hpp"
+#include "activations/Activation.hpp"
+#include "activations/LinearActivation.hpp"
+#include "activations/Softmax.hpp"
+#include "losses/CategoricalCrossEntropy.hpp"
+#include "losses/MeanSquaredError.hpp"
+#include "optimizers/Adam.hpp"
+#include "utils/DataHandler.hpp"
+
+namespace
+{
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bytes of heap in use, or 0 where the C library cannot tell
+size_t heap_in_use()
+{
+#ifdef __GLIBC__
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd; // Large blocks are mmapped
+#else
+    return 0;
+#endif
+}
+
+double largest_parameter_difference(Model &a, Model &b)
+{
+    double largest = 0.0;
+    for (size_t l = 0; l < a.getLayers().size(); ++l)
+    {
+        for (const auto &pair : {std::make_pair(&a.getLayers()[l].getWeights(), &b.getLayers()[l].getWeights()),
+                                 std::make_pair(&a.getLayers()[l].getBiases(), &b.getLayers()[l].getBiases())})
+        {
+            for (size_t i = 0; i < pair.first->size(); ++i)
+                largest = std::max(largest, std::fabs(pair.first->data()[i] - pair.second->data()[i]));
+        }
+    }
+    return largest;
+}
+} // namespace
+
+// Mini-batch Adam training of the Boston or MNIST network (the default, or
+// `hidden` layers, with the given activation) through Model::predict/backward and through a compiled
+// ExecutionPlan, from the same weights: time per step, memory held by the
+// step's intermediates, and how far apart the trained parameters end up. With
+// recompute_every, a plan that recomputes activations runs too.
+int plan_benchmark(const std::string &task, const std::string &dataset_path, int epochs, int batch_size,
+                   std::vector<int> hidden, const std::string &activation, int recompute_every)
+{
+    std::cout << "--- Compiled Execution Plan Benchmark (" << task << ") ---" << std::endl;
+
+    Matrix X(0, 0), y(0, 0);
+    Model model;
+    std::unique_ptr<Loss> loss_fn;
+    double learning_rate;
+    if (task == "boston")
+    {
+        Matrix data = read_csv_boston(dataset_path.empty() ? "data/boston_housing.csv" : dataset_path);
+        int features = data.getCols() - 1;
+        X = Matrix(data.getRows(), features);
+        y = Matrix(data.getRows(), 1);
+        for (int i = 0; i < data.getRows(); ++i)
+        {
+            for (int j = 0; j < features; ++j)
+                X(i, j) = data(i, j);
+            y(i, 0) = data(i, features);
+        }
+        StandardScaler scaler;
+        X = scaler.fit_transform(X);
+        int inputs = features;
+        for (int units : hidden.empty() ? std::vector<int>{64, 64} : hidden)
+        {
+            model.add(DenseLayer(inputs, units, Activation::create(activation)));
+            inputs = units;
+        }
+        model.add(DenseLayer(inputs, 1, std::make_shared<LinearActivation>()));
+        loss_fn.reset(new MeanSquaredError());
+        learning_rate = 0.01;
+    }
+    else
+    {
+        auto all_data = read_csv_mnist(dataset_path.empty() ? "data/mnist_train.csv" : dataset_path);
+        int rows = std::min(5000, all_data.first.getRows());
+        X = all_data.first.slice(0, rows);
+        normalize_features(X);
+        y = one_hot_encode(all_data.second.slice(0, rows), 10);
+        int inputs = X.getCols();
+        for (int units : hidden.empty() ? std::vector<int>{128} : hidden)
+        {
+            model.add(DenseLayer(inputs, units, Activation::create(activation)));
+            inputs = units;
+        }
+        model.add(DenseLayer(inputs, 10, std::make_shared<Softmax>()));
+        loss_fn.reset(new CategoricalCrossEntropy());
+        learning_rate = 0.001;
+    }
+
+    // Batches are sliced up front, so neither side pays for it inside the loop
+    std::vector<Matrix> X_batches, y_batches;
+    for (int begin = 0; begin < X.getRows(); begin += batch_size)
+    {
+        int end = std::min(begin + batch_size, X.getRows());
+        X_batches.push_back(X.slice(begin, end));
+        y_batches.push_back(y.slice(begin, end));
+    }
+    const double steps = static_cast<double>(X_batches.size()) * epochs;
+    std::cout << "Rows: " << X.getRows() << ", batch size: " << batch_size << ", steps: " << steps << std::endl;
+
+    // --- Model: fresh matrices for every layer, every step ---
+    Model dynamic_model = model.snapshot();
+    Adam dynamic_optimizer(dynamic_model.getLayers(), learning_rate);
+    size_t before = heap_in_use();
+    Matrix gradient = loss_fn->backward(dynamic_model.predict(X_batches[0]), y_batches[0]);
+    size_t dynamic_bytes = heap_in_use() - std::min(before, heap_in_use());
+    dynamic_model.backward(gradient);
+    dynamic_optimizer.step();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch < epochs; ++epoch)
+    {
+        for (size_t b = epoch == 0 ? 1 : 0; b < X_batches.size(); ++b)
+        {
+            Matrix y_pred = dynamic_model.predict(X_batches[b]);
+            dynamic_model.backward(loss_fn->backward(y_pred, y_batches[b]));
+            dynamic_optimizer.step();
+        }
+    }
+    double dynamic_seconds = seconds_since(start);
+    const double timed_steps = std::max(1.0, steps - 1); // The first step of each runs untimed
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\nModel: " << dynamic_seconds * 1e6 / timed_steps << " us/step, "
+              << dynamic_bytes / 1024.0 << " KB held between forward and backward" << std::endl;
+
+    // --- Compiled: one arena, planned once ---
+    std::vector<int> intervals{0};
+    if (recompute_every > 1)
+        intervals.push_back(recompute_every);
+    for (int interval : intervals)
+    {
+        Model compiled_model = model.snapshot();
+        Adam compiled_optimizer(compiled_model.getLayers(), learning_rate);
+        ExecutionPlan plan = compiled_model.compile(batch_size, true, interval);
+        auto step = [&](size_t b)
+        {
+            loss_fn->backward_into(plan.forward(X_batches[b]), y_batches[b], plan.output_gradient());
+            plan.backward();
+            compiled_optimizer.step();
+        };
+        step(0);
+        start = std::chrono::steady_clock::now();
+        for (int epoch = 0; epoch < epochs; ++epoch)
+        {
+            for (size_t b = epoch == 0 ? 1 : 0; b < X_batches.size(); ++b)
+                step(b);
+        }
+        double compiled_seconds = seconds_since(start);
+
+        if (interval > 1)
+            std::cout << "Plan, one layer output kept in " << interval << ": ";
+        else
+            std::cout << "Plan: ";
+        std::cout << compiled_seconds * 1e6 / timed_steps << " us/step (" << dynamic_seconds / compiled_seconds
+                  << "x), arena " << plan.getArenaBytes() / 1024.0 << " KB (" << plan.getUnsharedBytes() / 1024.0
+                  << " KB unshared), largest parameter difference " << std::scientific << std::setprecision(2)
+                  << largest_parameter_difference(dynamic_model, compiled_model) << std::fixed << std::setprecision(1)
+                  << std::endl;
+    }
+    return 0;
+}
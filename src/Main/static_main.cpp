@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "Mains.hpp"
+#include "Model.hpp"
+#include "StaticMLP.hpp"
+#include "activations/LinearActivation.hpp"
+#include "activations/ReLU.hpp"
+#include "activations/Softmax.hpp"
+#include "losses/CategoricalCrossEntropy.hpp"
+#include "losses/MeanSquaredError.hpp"
+#include "optimizers/Adam.hpp"
+#include "utils/DataHandler.hpp"
+
+namespace
+{
+using namespace static_mlp;
+using BostonNet = StaticMLP<Dense<13, 64, relu>, Dense<64, 64, relu>, Dense<64, 1, linear>>;
+using MnistNet = StaticMLP<Dense<784, 128, relu>, Dense<128, 10, softmax>>;
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double largest_difference(const Matrix &a, const Matrix &b)
+{
+    double largest = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+        largest = std::max(largest, std::fabs(a.data()[i] - b.data()[i]));
+    return largest;
+}
+
+template <typename Net>
+int compare(Model &model, Loss &loss_fn, const Matrix &X, const Matrix &y, int epochs, double learning_rate)
+{
+    // The parameters alone are megabytes for MNIST: too big for the stack
+    auto net = std::make_unique<Net>();
+    net->load(model);
+    const int rows = X.getRows();
+    std::cout << "Rows: " << rows << ", full-batch training steps: " << epochs << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // --- Inference ---
+    auto start = std::chrono::steady_clock::now();
+    Matrix dynamic_batch = model.predict(X);
+    double dynamic_batch_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    Matrix dynamic_rows(rows, Net::kOutputs);
+    for (int r = 0; r < rows; ++r)
+    {
+        Matrix row = model.predict(X.slice(r, r + 1));
+        std::copy(row.data(), row.data() + Net::kOutputs, dynamic_rows.data() + static_cast<size_t>(r) * Net::kOutputs);
+    }
+    double dynamic_row_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    Matrix fixed = net->predict(X);
+    double fixed_seconds = seconds_since(start);
+
+    std::cout << "\nInference (us/row)" << std::endl;
+    std::cout << "  Model, whole batch:   " << dynamic_batch_seconds * 1e6 / rows << std::endl;
+    std::cout << "  Model, row at a time: " << dynamic_row_seconds * 1e6 / rows << std::endl;
+    std::cout << "  StaticMLP:            " << fixed_seconds * 1e6 / rows << " ("
+              << std::setprecision(1) << dynamic_batch_seconds / fixed_seconds << "x the batch, "
+              << dynamic_row_seconds / fixed_seconds << "x row at a time)" << std::endl;
+    std::cout << std::scientific << std::setprecision(2)
+              << "  Largest difference:   " << largest_difference(dynamic_batch, fixed) << std::endl;
+
+    // --- Training: the same full-batch Adam steps from the same weights ---
+    Adam optimizer(model.getLayers(), learning_rate);
+    double dynamic_loss = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch < epochs; ++epoch)
+    {
+        Matrix predictions = model.predict(X);
+        dynamic_loss = loss_fn.calculate(predictions, y);
+        model.backward(loss_fn.backward(predictions, y));
+        optimizer.step();
+    }
+    double dynamic_train_seconds = seconds_since(start);
+
+    double fixed_loss = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch < epochs; ++epoch)
+        fixed_loss = net->train_step(X, y, learning_rate);
+    double fixed_train_seconds = seconds_since(start);
+
+    double weight_difference = 0.0;
+    Model trained = net->to_model();
+    for (size_t l = 0; l < trained.getLayers().size(); ++l)
+    {
+        weight_difference = std::max(weight_difference, largest_difference(model.getLayers()[l].getWeights(),
+                                                                           trained.getLayers()[l].getWeights()));
+        weight_difference = std::max(weight_difference, largest_difference(model.getLayers()[l].getBiases(),
+                                                                           trained.getLayers()[l].getBiases()));
+    }
+
+    std::cout << std::fixed << std::setprecision(3) << "\nTraining (ms/step)" << std::endl;
+    std::cout << "  Model + Adam:         " << dynamic_train_seconds * 1e3 / std::max(1, epochs)
+              << " (last loss " << std::setprecision(6) << dynamic_loss << ")" << std::endl;
+    std::cout << std::setprecision(3) << "  StaticMLP:            " << fixed_train_seconds * 1e3 / std::max(1, epochs)
+              << " (last loss " << std::setprecision(6) << fixed_loss << ")" << std::endl;
+    std::cout << std::scientific << std::setprecision(2)
+              << "  Largest parameter difference: " << weight_difference << std::endl;
+    return 0;
+}
+} // namespace
+
+// Model against the StaticMLP of the same topology (the default Boston or
+// MNIST network), from the same starting weights: inference per row and in
+// batch, then full-batch Adam training
+int static_benchmark(const std::string &task, const std::string &dataset_path, int epochs)
+{
+    std::cout << "--- StaticMLP vs Model Benchmark (" << task << ") ---" << std::endl;
+
+    Model model;
+    if (task == "boston")
+    {
+        Matrix data = read_csv_boston(dataset_path.empty() ? "data/boston_housing.csv" : dataset_path);
+        int features = data.getCols() - 1;
+        if (features != BostonNet::kInputs)
+        {
+            std::cerr << "Error: Expected " << BostonNet::kInputs << " features, found " << features << "." << std::endl;
+            return 1;
+        }
+        Matrix X(data.getRows(), features), y(data.getRows(), 1);
+        for (int i = 0; i < data.getRows(); ++i)
+        {
+            for (int j = 0; j < features; ++j)
+                X(i, j) = data(i, j);
+            y(i, 0) = data(i, features);
+        }
+        StandardScaler scaler;
+        X = scaler.fit_transform(X);
+
+        model.add(DenseLayer(13, 64, std::make_shared<ReLU>()));
+        model.add(DenseLayer(64, 64, std::make_shared<ReLU>()));
+        model.add(DenseLayer(64, 1, std::make_shared<LinearActivation>()));
+        MeanSquaredError loss_fn;
+        return compare<BostonNet>(model, loss_fn, X, y, epochs, 0.01);
+    }
+
+    auto all_data = read_csv_mnist(dataset_path.empty() ? "data/mnist_train.csv" : dataset_path);
+    if (all_data.first.getCols() != MnistNet::kInputs)
+    {
+        std::cerr << "Error: Expected " << MnistNet::kInputs << " pixels, found " << all_data.first.getCols() << "." << std::endl;
+        return 1;
+    }
+    // Full-batch steps through the naive Matrix::multiply are slow; a couple of
+    // thousand rows are plenty to compare the two
+    int rows = std::min(2000, all_data.first.getRows());
+    Matrix X = all_data.first.slice(0, rows);
+    normalize_features(X);
+    Matrix y = one_hot_encode(all_data.second.slice(0, rows), 10);
+
+    model.add(DenseLayer(784, 128, std::make_shared<ReLU>()));
+    model.add(DenseLayer(128, 10, std::make_shared<Softmax>()));
+    CategoricalCrossEntropy loss_fn;
+    return compare<MnistNet>(model, loss_fn, X, y, epochs, 0.001);
+}
@@ -2,8 +2,12 @@
 #include <stdexcept>
 #include <random>
 #include <cmath>
+#include <sstream>
+#include <string>
+#include "utils/Random.hpp"
 
-Matrix::Matrix(int rows, int cols) : m_rows(rows), m_cols(cols), m_data(rows * cols, 0.0) {}
+Matrix::Matrix(int rows, int cols)
+    : m_rows(rows), m_cols(cols), m_data(static_cast<size_t>(rows) * cols, 0.0), m_ptr(m_data.data()) {}
 
 Matrix::Matrix(const std::vector<std::vector<double>> &data)
 {
@@ -11,20 +15,85 @@ Matrix::Matrix(const std::vector<std::vector<double>> &data)
     {
         m_rows = 0;
         m_cols = 0;
+        m_ptr = m_data.data();
         return;
     }
     m_rows = data.size();
     m_cols = data[0].size();
-    m_data.resize(m_rows * m_cols);
+    m_data.resize(static_cast<size_t>(m_rows) * m_cols);
+    m_ptr = m_data.data();
     for (int i = 0; i < m_rows; ++i)
     {
         for (int j = 0; j < m_cols; ++j)
         {
-            m_data[i * m_cols + j] = data[i][j];
+            m_ptr[i * m_cols + j] = data[i][j];
         }
     }
 }
 
+Matrix::Matrix(const Matrix &other)
+    : m_rows(other.m_rows), m_cols(other.m_cols),
+      m_data(other.m_ptr, other.m_ptr + other.size()), m_ptr(m_data.data()) {}
+
+Matrix::Matrix(Matrix &&other) noexcept
+    : m_rows(other.m_rows), m_cols(other.m_cols), m_data(), m_ptr(other.m_ptr)
+{
+    // Moving the vector keeps its buffer, so m_ptr stays valid for owned storage too
+    m_data = std::move(other.m_data);
+    other.m_rows = 0;
+    other.m_cols = 0;
+    other.m_data.clear();
+    other.m_ptr = other.m_data.data();
+}
+
+Matrix &Matrix::operator=(const Matrix &other)
+{
+    if (this != &other)
+    {
+        // Copies always own their storage, even when copying a view
+        m_data.assign(other.m_ptr, other.m_ptr + other.size());
+        m_rows = other.m_rows;
+        m_cols = other.m_cols;
+        m_ptr = m_data.data();
+    }
+    return *this;
+}
+
+Matrix &Matrix::operator=(Matrix &&other) noexcept
+{
+    if (this != &other)
+    {
+        m_rows = other.m_rows;
+        m_cols = other.m_cols;
+        m_data = std::move(other.m_data);
+        m_ptr = other.m_ptr;
+        other.m_rows = 0;
+        other.m_cols = 0;
+        other.m_data.clear();
+        other.m_ptr = other.m_data.data();
+    }
+    return *this;
+}
+
+Matrix Matrix::view(double *data, int rows, int cols)
+{
+    Matrix m(0, 0);
+    m.m_rows = rows;
+    m.m_cols = cols;
+    m.m_ptr = data;
+    return m;
+}
+
+bool Matrix::isView() const
+{
+    return m_ptr != m_data.data();
+}
+
+size_t Matrix::size() const
+{
+    return static_cast<size_t>(m_rows) * m_cols;
+}
+
 int Matrix::getRows() const
 {
     return m_rows;
@@ -41,7 +110,7 @@ double &Matrix::operator()(int r, int c)
     {
         throw std::out_of_range("Matrix index out of range");
     }
-    return m_data[r * m_cols + c];
+    return m_ptr[r * m_cols + c];
 }
 
 const double &Matrix::operator()(int r, int c) const
@@ -50,14 +119,23 @@ const double &Matrix::operator()(int r, int c) const
     {
         throw std::out_of_range("Matrix index out of range");
     }
-    return m_data[r * m_cols + c];
+    return m_ptr[r * m_cols + c];
+}
+
+double *Matrix::data()
+{
+    return m_ptr;
+}
+
+const double *Matrix::data() const
+{
+    return m_ptr;
 }
 
 Matrix Matrix::random(int rows, int cols)
 {
     Matrix m(rows, cols);
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 &gen = global_rng();
     std::uniform_real_distribution<> dis(-1.0, 1.0);
 
     for (int i = 0; i < rows; ++i)
@@ -98,13 +176,12 @@ Matrix Matrix::he(int rows, int cols)
     Matrix m(rows, cols);
     double stddev = std::sqrt(2.0 / rows);
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 &gen = global_rng();
     std::normal_distribution<> dis(0.0, stddev);
 
     for (int i = 0; i < rows * cols; ++i)
     {
-        m.m_data[i] = dis(gen);
+        m.m_ptr[i] = dis(gen);
     }
     return m;
 }
@@ -116,9 +193,9 @@ Matrix Matrix::operator-(const Matrix &other) const
         throw std::invalid_argument("Matrices must have the same dimensions for subtraction.");
     }
     Matrix result(m_rows, m_cols);
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        result.m_data[i] = m_data[i] - other.m_data[i];
+        result.m_ptr[i] = m_ptr[i] - other.m_ptr[i];
     }
     return result;
 }
@@ -126,9 +203,9 @@ Matrix Matrix::operator-(const Matrix &other) const
 Matrix Matrix::operator*(double scalar) const
 {
     Matrix result(m_rows, m_cols);
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        result.m_data[i] = m_data[i] * scalar;
+        result.m_ptr[i] = m_ptr[i] * scalar;
     }
     return result;
 }
@@ -140,9 +217,9 @@ Matrix Matrix::operator+(const Matrix &other) const
         throw std::invalid_argument("Matrices must have the same dimensions for addition.");
     }
     Matrix result(m_rows, m_cols);
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        result.m_data[i] = m_data[i] + other.m_data[i];
+        result.m_ptr[i] = m_ptr[i] + other.m_ptr[i];
     }
     return result;
 }
@@ -153,9 +230,9 @@ void Matrix::element_multiply(const Matrix &other)
     {
         throw std::invalid_argument("Matrices must have the same dimensions for element-wise multiplication.");
     }
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        m_data[i] *= other.m_data[i];
+        m_ptr[i] *= other.m_ptr[i];
     }
 }
 
@@ -165,25 +242,25 @@ void Matrix::element_divide(const Matrix &other)
     {
         throw std::invalid_argument("Matrices must have the same dimensions for element-wise division.");
     }
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        if (other.m_data[i] == 0)
+        if (other.m_ptr[i] == 0)
         {
             // Avoid division by zero, though Adam's epsilon helps
-            m_data[i] = 0;
+            m_ptr[i] = 0;
         }
         else
         {
-            m_data[i] /= other.m_data[i];
+            m_ptr[i] /= other.m_ptr[i];
         }
     }
 }
 
 void Matrix::element_sqrt()
 {
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        m_data[i] = std::sqrt(m_data[i]);
+        m_ptr[i] = std::sqrt(m_ptr[i]);
     }
 }
 
@@ -202,9 +279,9 @@ Matrix Matrix::transpose() const
 
 void Matrix::map(const std::function<double(double)> &func)
 {
-    for (int i = 0; i < m_rows * m_cols; ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        m_data[i] = func(m_data[i]);
+        m_ptr[i] = func(m_ptr[i]);
     }
 }
 
@@ -233,9 +310,9 @@ void Matrix::update(const Matrix &gradient, double learning_rate)
         throw std::invalid_argument("Matrices must have the same dimensions for update.");
     }
 
-    for (size_t i = 0; i < m_data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
-        m_data[i] -= gradient.m_data[i] * learning_rate;
+        m_ptr[i] -= gradient.m_ptr[i] * learning_rate;
     }
 }
 
@@ -249,4 +326,47 @@ void Matrix::print() const
         }
         std::cout << std::endl;
     }
+}
+
+void Matrix::write_text(std::ostream &out) const
+{
+    out << m_rows << "," << m_cols << "\n";
+    for (int i = 0; i < m_rows; ++i)
+    {
+        const double *row = m_ptr + static_cast<size_t>(i) * m_cols;
+        for (int j = 0; j < m_cols; ++j)
+        {
+            out << row[j] << (j == m_cols - 1 ? "" : ",");
+        }
+        out << "\n";
+    }
+}
+
+Matrix Matrix::read_text(std::istream &in)
+{
+    std::string line;
+    std::getline(in, line); // Get dimensions
+    std::stringstream ss_dims(line);
+    std::string rows_str, cols_str;
+    std::getline(ss_dims, rows_str, ',');
+    std::getline(ss_dims, cols_str, ',');
+    int rows = std::stoi(rows_str);
+    int cols = std::stoi(cols_str);
+
+    Matrix m(rows, cols);
+    for (int i = 0; i < rows; ++i)
+    {
+        std::getline(in, line);
+        std::stringstream ss_row(line);
+        std::string val_str;
+        for (int j = 0; j < cols; ++j)
+        {
+            if (!std::getline(ss_row, val_str, ','))
+            {
+                throw std::runtime_error("Matrix row is shorter than its declared size.");
+            }
+            m.m_ptr[static_cast<size_t>(i) * cols + j] = std::stod(val_str);
+        }
+    }
+    return m;
 }
\ No newline at end of file
@@ -0,0 +1,378 @@
+#include "ExecutionPlan.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+// Tensors start on 64-byte boundaries: offsets are multiples of 8 doubles
+// from an arena start aligned by hand, since std::vector only guarantees 16
+const size_t kAlignment = 8;
+
+size_t aligned(size_t doubles)
+{
+    return (doubles + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// out = in W + b, each sum in Matrix::multiply's order. Zero inputs (ReLU
+// outputs, blank pixels) add nothing and are skipped.
+void linear_forward(const double *in, int rows, const Matrix &weights, const Matrix &biases, double *out)
+{
+    const int inputs = weights.getRows();
+    const int outputs = weights.getCols();
+    for (int r = 0; r < rows; ++r)
+    {
+        const double *x = in + static_cast<size_t>(r) * inputs;
+        double *z = out + static_cast<size_t>(r) * outputs;
+        std::fill(z, z + outputs, 0.0);
+        for (int k = 0; k < inputs; ++k)
+        {
+            const double xk = x[k];
+            if (xk == 0.0)
+                continue;
+            const double *w = weights.data() + static_cast<size_t>(k) * outputs;
+            for (int o = 0; o < outputs; ++o)
+                z[o] += xk * w[o];
+        }
+        for (int o = 0; o < outputs; ++o)
+            z[o] += biases.data()[o];
+    }
+}
+
+// dW = in^T d and db = column sums of d, summed over rows in order
+void parameter_gradients(const double *in, int rows, const Matrix &d, Matrix &d_weights, Matrix &d_biases)
+{
+    const int inputs = d_weights.getRows();
+    const int outputs = d_weights.getCols();
+    for (int i = 0; i < inputs; ++i)
+    {
+        double *dw = d_weights.data() + static_cast<size_t>(i) * outputs;
+        std::fill(dw, dw + outputs, 0.0);
+        for (int r = 0; r < rows; ++r)
+        {
+            const double xi = in[static_cast<size_t>(r) * inputs + i];
+            if (xi == 0.0)
+                continue;
+            const double *dr = d.data() + static_cast<size_t>(r) * outputs;
+            for (int o = 0; o < outputs; ++o)
+                dw[o] += xi * dr[o];
+        }
+    }
+    double *db = d_biases.data();
+    std::fill(db, db + outputs, 0.0);
+    for (int r = 0; r < rows; ++r)
+    {
+        const double *dr = d.data() + static_cast<size_t>(r) * outputs;
+        for (int o = 0; o < outputs; ++o)
+            db[o] += dr[o];
+    }
+}
+
+// d_input = d W^T: rows of d against rows of W
+void input_gradient(const Matrix &d, const Matrix &weights, Matrix &d_input)
+{
+    const int inputs = weights.getRows();
+    const int outputs = weights.getCols();
+    for (int r = 0; r < d.getRows(); ++r)
+    {
+        const double *dr = d.data() + static_cast<size_t>(r) * outputs;
+        double *out = d_input.data() + static_cast<size_t>(r) * inputs;
+        for (int i = 0; i < inputs; ++i)
+        {
+            const double *w = weights.data() + static_cast<size_t>(i) * outputs;
+            double sum = 0.0;
+            for (int o = 0; o < outputs; ++o)
+                sum += dr[o] * w[o];
+            out[i] = sum;
+        }
+    }
+}
+} // namespace
+
+ExecutionPlan::ExecutionPlan(std::vector<DenseLayer> &layers, int batch_size, bool training, int recompute_every)
+    : m_layers(&layers), m_batch_size(batch_size), m_training(training), m_recompute_every(recompute_every),
+      m_arena_start(0), m_input(nullptr), m_rows(0)
+{
+    if (batch_size <= 0)
+    {
+        throw std::invalid_argument("Batch size must be positive.");
+    }
+    if (recompute_every < 0)
+    {
+        throw std::invalid_argument("Recomputation interval cannot be negative.");
+    }
+    if (layers.empty())
+    {
+        throw std::invalid_argument("Cannot compile a model without layers.");
+    }
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        const Matrix &weights = layers[l].getWeights();
+        if (layers[l].getPrecision() != Precision::DOUBLE)
+        {
+            throw std::invalid_argument("Execution plans run in double precision.");
+        }
+        if (l > 0 && weights.getRows() != m_shapes.back())
+        {
+            throw std::invalid_argument("Layer " + std::to_string(l) + " takes " + std::to_string(weights.getRows()) +
+                                        " inputs, but the layer before has " + std::to_string(m_shapes.back()) +
+                                        " outputs.");
+        }
+        if (l == 0)
+            m_shapes.push_back(weights.getRows());
+        m_shapes.push_back(weights.getCols());
+        if (training)
+            layers[l].getWeightsGradient(); // Sizes the buffer now rather than in the first step
+    }
+
+    // Lifetimes come from walking the schedule the plan runs: forward, the
+    // loss, then backward one segment at a time, each segment first
+    // recomputing the outputs that were not kept
+    const int depth = static_cast<int>(layers.size());
+    for (int l = 0; l < depth; ++l)
+    {
+        bool kept = !training || recompute_every <= 1 || (l + 1) % recompute_every == 0 || l == depth - 1;
+        m_kept.push_back(kept);
+        m_outputs.push_back(add_tensor(m_shapes[l + 1]));
+        bool keep_input = training && kept && layers[l].getActivation()->needs_input();
+        m_pre_activations.push_back(keep_input ? add_tensor(m_shapes[l + 1]) : -1);
+    }
+    m_recomputed.assign(depth, -1);
+    m_recomputed_pre_activations.assign(depth, -1);
+    m_gradients.assign(depth, -1);
+
+    int step = 0;
+    auto use = [&](int tensor)
+    {
+        m_tensors[tensor].first = std::min(m_tensors[tensor].first, step);
+        m_tensors[tensor].last = std::max(m_tensors[tensor].last, step);
+    };
+    for (int l = 0; l < depth; ++l, ++step)
+    {
+        if (l > 0)
+            use(m_outputs[l - 1]);
+        use(m_outputs[l]);
+        if (m_pre_activations[l] >= 0)
+            use(m_pre_activations[l]);
+    }
+    if (training)
+    {
+        use(m_outputs.back()); // The loss
+        m_gradients.back() = add_tensor(m_shapes.back());
+        use(m_gradients.back());
+        ++step;
+        for (int end = depth - 1; end >= 0; end = segment_begin(end) - 1)
+        {
+            int begin = segment_begin(end);
+            for (int l = begin; l < end; ++l, ++step)
+            {
+                m_recomputed[l] = add_tensor(m_shapes[l + 1]);
+                if (layers[l].getActivation()->needs_input())
+                {
+                    m_recomputed_pre_activations[l] = add_tensor(m_shapes[l + 1]);
+                    use(m_recomputed_pre_activations[l]);
+                }
+                if (l > 0)
+                    use(output(l - 1));
+                use(m_recomputed[l]);
+            }
+            for (int l = end; l >= begin; --l, ++step)
+            {
+                use(activation_operand(l));
+                use(m_gradients[l]);
+                if (l > 0)
+                {
+                    // The first layer's input gradient has no tensor
+                    use(output(l - 1));
+                    m_gradients[l - 1] = add_tensor(m_shapes[l]);
+                    use(m_gradients[l - 1]);
+                }
+            }
+        }
+    }
+    place_tensors();
+    for (size_t t = 0; t < m_tensors.size(); ++t)
+        m_views.push_back(Matrix::view(m_arena.data() + m_arena_start + m_tensors[t].offset, 0, m_tensors[t].cols));
+}
+
+// Greedy by size: each tensor, largest first, goes at the lowest offset that
+// is free for its whole lifetime
+void ExecutionPlan::place_tensors()
+{
+    std::vector<int> order(m_tensors.size());
+    for (size_t t = 0; t < order.size(); ++t)
+        order[t] = static_cast<int>(t);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     { return m_tensors[a].cols > m_tensors[b].cols; });
+
+    size_t arena = 0;
+    std::vector<int> placed;
+    for (int t : order)
+    {
+        Tensor &tensor = m_tensors[t];
+        size_t size = aligned(static_cast<size_t>(m_batch_size) * tensor.cols);
+        std::vector<std::pair<size_t, size_t>> taken; // [begin, end) of live neighbours
+        for (int other : placed)
+        {
+            const Tensor &o = m_tensors[other];
+            if (o.first <= tensor.last && tensor.first <= o.last)
+                taken.emplace_back(o.offset, o.offset + aligned(static_cast<size_t>(m_batch_size) * o.cols));
+        }
+        std::sort(taken.begin(), taken.end());
+        size_t offset = 0;
+        for (const auto &range : taken)
+        {
+            if (range.first >= offset + size)
+                break;
+            offset = std::max(offset, range.second);
+        }
+        tensor.offset = offset;
+        arena = std::max(arena, offset + size);
+        placed.push_back(t);
+    }
+    // Room to move the start up to the next 64-byte boundary
+    m_arena.assign(arena + kAlignment - 1, 0.0);
+    uintptr_t address = reinterpret_cast<uintptr_t>(m_arena.data());
+    const uintptr_t bytes = kAlignment * sizeof(double);
+    m_arena_start = ((bytes - address % bytes) % bytes) / sizeof(double);
+}
+
+Matrix &ExecutionPlan::view(int tensor)
+{
+    return m_views[tensor];
+}
+
+int ExecutionPlan::add_tensor(int cols)
+{
+    m_tensors.push_back(Tensor{cols, std::numeric_limits<int>::max(), -1, 0});
+    return static_cast<int>(m_tensors.size()) - 1;
+}
+
+int ExecutionPlan::output(int layer) const
+{
+    return m_kept[layer] ? m_outputs[layer] : m_recomputed[layer];
+}
+
+int ExecutionPlan::pre_activation(int layer) const
+{
+    return m_kept[layer] ? m_pre_activations[layer] : m_recomputed_pre_activations[layer];
+}
+
+// What backward_in_place reads: the activation's input where it needs that
+int ExecutionPlan::activation_operand(int layer) const
+{
+    return pre_activation(layer) >= 0 ? pre_activation(layer) : output(layer);
+}
+
+// First layer of the segment ending at `end`: the one after the last kept output
+int ExecutionPlan::segment_begin(int end) const
+{
+    int begin = end;
+    while (begin > 0 && !m_kept[begin - 1])
+        --begin;
+    return begin;
+}
+
+void ExecutionPlan::layer_forward(int layer, const double *input, Matrix &output, int pre_activation)
+{
+    DenseLayer &dense = (*m_layers)[layer];
+    linear_forward(input, m_rows, dense.getWeights(), dense.getBiases(), output.data());
+    if (pre_activation >= 0)
+        std::copy(output.data(), output.data() + output.size(), view(pre_activation).data());
+    dense.getActivation()->forward_in_place(output);
+}
+
+const Matrix &ExecutionPlan::forward(const Matrix &input)
+{
+    if (input.getCols() != m_shapes.front() || !matches(*m_layers, input.getRows()) || input.getRows() == 0)
+    {
+        throw std::invalid_argument("Input of " + std::to_string(input.getRows()) + "x" +
+                                    std::to_string(input.getCols()) + " does not fit an execution plan for " +
+                                    std::to_string(m_batch_size) + "x" + std::to_string(m_shapes.front()) +
+                                    " batches of these layers.");
+    }
+    m_rows = input.getRows();
+    for (size_t t = 0; t < m_tensors.size(); ++t)
+        m_views[t] = Matrix::view(m_arena.data() + m_arena_start + m_tensors[t].offset, m_rows, m_tensors[t].cols);
+
+    const double *in = input.data();
+    for (size_t l = 0; l < m_layers->size(); ++l)
+    {
+        layer_forward(static_cast<int>(l), in, view(m_outputs[l]), m_pre_activations[l]);
+        in = view(m_outputs[l]).data();
+    }
+    m_input = &input;
+    return view(m_outputs.back());
+}
+
+Matrix &ExecutionPlan::output_gradient()
+{
+    if (!m_training)
+    {
+        throw std::runtime_error("An inference plan has no gradients.");
+    }
+    return view(m_gradients.back());
+}
+
+void ExecutionPlan::backward()
+{
+    if (!m_training || !m_input)
+    {
+        throw std::runtime_error("backward() needs a training plan and a forward() before it.");
+    }
+    for (int end = static_cast<int>(m_layers->size()) - 1; end >= 0; end = segment_begin(end) - 1)
+    {
+        int begin = segment_begin(end);
+        for (int l = begin; l < end; ++l)
+        {
+            layer_forward(l, l == 0 ? m_input->data() : view(output(l - 1)).data(), view(m_recomputed[l]),
+                          m_recomputed_pre_activations[l]);
+        }
+        for (int l = end; l >= begin; --l)
+        {
+            DenseLayer &layer = (*m_layers)[l];
+            Matrix &d = view(m_gradients[l]);
+            layer.getActivation()->backward_in_place(view(activation_operand(l)), d);
+
+            const double *in = l == 0 ? m_input->data() : view(output(l - 1)).data();
+            Matrix &d_weights = layer.getWeightsGradient();
+            parameter_gradients(in, m_rows, d, d_weights, layer.getBiasesGradient());
+            if (layer.getRegularizer())
+            {
+                layer.getRegularizer()->add_gradient(layer.getWeights(), d_weights);
+            }
+            if (l > 0)
+            {
+                input_gradient(d, layer.getWeights(), view(m_gradients[l - 1]));
+            }
+        }
+    }
+    m_input = nullptr;
+}
+
+bool ExecutionPlan::matches(const std::vector<DenseLayer> &layers, int rows) const
+{
+    if (&layers != m_layers || layers.size() + 1 != m_shapes.size() || rows > m_batch_size)
+        return false;
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        if (layers[l].getWeights().getRows() != m_shapes[l] || layers[l].getWeights().getCols() != m_shapes[l + 1] ||
+            layers[l].getPrecision() != Precision::DOUBLE)
+            return false;
+    }
+    return true;
+}
+
+int ExecutionPlan::getBatchSize() const { return m_batch_size; }
+bool ExecutionPlan::isTraining() const { return m_training; }
+int ExecutionPlan::getRecomputeEvery() const { return m_recompute_every; }
+size_t ExecutionPlan::getArenaBytes() const { return (m_arena.size() - (kAlignment - 1)) * sizeof(double); }
+
+size_t ExecutionPlan::getUnsharedBytes() const
+{
+    size_t doubles = 0;
+    for (const Tensor &tensor : m_tensors)
+        doubles += aligned(static_cast<size_t>(m_batch_size) * tensor.cols);
+    return doubles * sizeof(double);
+}
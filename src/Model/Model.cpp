@@ -1,21 +1,26 @@
 #include "Model.hpp"
+#include "utils/Hash.hpp"
 #include <fstream>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <stdexcept>
 
-Model::Model() {}
+Model::Model() : m_input_folded(false), m_has_best(false) {}
 
 void Model::add(DenseLayer layer)
 {
-    m_layers.push_back(layer);
+    m_layers.push_back(std::move(layer));
 }
 
-void Model::backward(const Matrix &d_output)
+void Model::backward(const Matrix &d_output, bool regularize)
 {
     Matrix current_grad = d_output;
     for (int i = m_layers.size() - 1; i >= 0; --i)
     {
-        current_grad = m_layers[i].backward(current_grad);
+        // Nothing consumes the first layer's input gradient
+        current_grad = m_layers[i].backward(current_grad, i > 0, regularize);
     }
 }
 
@@ -24,6 +29,14 @@ std::vector<DenseLayer> &Model::getLayers()
     return m_layers;
 }
 
+void Model::setPrecision(Precision precision)
+{
+    for (auto &layer : m_layers)
+    {
+        layer.setPrecision(precision);
+    }
+}
+
 Matrix Model::predict(Matrix input)
 {
     Matrix current_output = input;
@@ -34,111 +47,475 @@ Matrix Model::predict(Matrix input)
     return current_output;
 }
 
-void Model::save(const std::string &filepath) const
+ExecutionPlan Model::compile(int batch_size, bool training, int recompute_every)
 {
-    std::ofstream file(filepath);
+    if (training && isMapped())
+    {
+        throw std::runtime_error("Cannot train a read-only memory-mapped model.");
+    }
+    return ExecutionPlan(m_layers, batch_size, training, recompute_every);
+}
+
+static bool has_binary_extension(const std::string &filepath)
+{
+    const std::string ext = ".bin";
+    return filepath.size() >= ext.size() &&
+           filepath.compare(filepath.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+static bool starts_with(const std::string &line, const std::string &prefix)
+{
+    return line.compare(0, prefix.size(), prefix) == 0;
+}
+
+static void write_row(std::ostream &file, const double *values, int cols)
+{
+    for (int j = 0; j < cols; ++j)
+    {
+        file << values[j] << (j == cols - 1 ? "" : ",");
+    }
+    file << "\n";
+}
+
+static void read_row(std::istream &file, double *values, int cols)
+{
+    std::string line;
+    std::getline(file, line);
+    std::stringstream ss_row(line);
+    std::string val_str;
+    for (int j = 0; j < cols; ++j)
+    {
+        if (!std::getline(ss_row, val_str, ','))
+        {
+            throw std::runtime_error("Model file row is shorter than its declared size.");
+        }
+        values[j] = std::stod(val_str);
+    }
+}
+
+static void write_matrix(std::ostream &file, const std::string &tag, const Matrix &matrix)
+{
+    file << tag << "\n";
+    matrix.write_text(file);
+}
+
+Model Model::from_file(const std::string &filepath)
+{
+    std::vector<LayerSpec> specs = read_architecture(filepath);
+    if (specs.empty())
+    {
+        throw std::runtime_error("Model file does not record its architecture: " + filepath);
+    }
+
+    Model model;
+    for (const auto &spec : specs)
+    {
+        model.add(DenseLayer(spec.inputs, spec.outputs, Activation::create(spec.activation),
+                             Regularizer::create(spec.regularizer, spec.regularizer_params),
+                             WeightInitType::ZERO));
+    }
+    model.load(filepath);
+    return model;
+}
+
+std::vector<LayerSpec> Model::read_architecture(const std::string &filepath)
+{
+    if (is_binary_file(filepath))
+    {
+        return read_binary_architecture(filepath);
+    }
+    std::ifstream file(filepath);
     if (!file.is_open())
     {
-        throw std::runtime_error("Could not open file for saving: " + filepath);
+        throw std::runtime_error("Could not open file for loading: " + filepath);
     }
+    return read_text_architecture(file);
+}
 
+// LAYER lines precede the first WEIGHTS block: "LAYER <in> <out> <activation> <regularizer> [params...]"
+std::vector<LayerSpec> Model::read_text_architecture(std::istream &file)
+{
+    std::vector<LayerSpec> specs;
+    std::string line;
+    while (std::getline(file, line) && line != "WEIGHTS")
+    {
+        if (!starts_with(line, "LAYER "))
+            continue;
+        std::stringstream ss(line.substr(6));
+        LayerSpec spec;
+        if (!(ss >> spec.inputs >> spec.outputs >> spec.activation >> spec.regularizer))
+        {
+            throw std::runtime_error("Malformed LAYER line in model file: " + line);
+        }
+        double param;
+        while (ss >> param)
+        {
+            spec.regularizer_params.push_back(param);
+        }
+        specs.push_back(spec);
+    }
+    return specs;
+}
+
+std::vector<LayerSpec> Model::describe() const
+{
+    std::vector<LayerSpec> specs;
+    for (const auto &layer : m_layers)
+    {
+        LayerSpec spec;
+        spec.inputs = layer.getWeights().getRows();
+        spec.outputs = layer.getWeights().getCols();
+        spec.activation = layer.getActivation()->name();
+        spec.regularizer = layer.getRegularizer() ? layer.getRegularizer()->name() : "none";
+        if (layer.getRegularizer())
+            spec.regularizer_params = layer.getRegularizer()->parameters();
+        specs.push_back(spec);
+    }
+    return specs;
+}
+
+uint64_t Model::fingerprint() const
+{
+    uint64_t hash = hash_doubles(nullptr, 0, m_input_folded ? 1 : 0);
     for (const auto &layer : m_layers)
     {
         const Matrix &weights = layer.getWeights();
         const Matrix &biases = layer.getBiases();
+        double shape[2] = {static_cast<double>(weights.getRows()), static_cast<double>(weights.getCols())};
+        hash = hash_doubles(shape, 2, hash);
+        hash = hash_doubles(weights.data(), weights.size(), hash);
+        hash = hash_doubles(biases.data(), biases.size(), hash);
+    }
+    return hash;
+}
+
+Model Model::snapshot() const
+{
+    Model copy;
+    for (const auto &layer : m_layers)
+    {
+        // Activations cache their input, so a snapshot that may run forward on
+        // another thread gets its own instances
+        copy.add(DenseLayer(layer.getWeights(), layer.getBiases(),
+                            Activation::create(layer.getActivation()->name()), layer.getRegularizer()));
+    }
+    copy.m_input_folded = m_input_folded;
+    copy.m_scaler = m_scaler;
+    return copy;
+}
+
+void Model::copy_parameters(const Model &source)
+{
+    if (source.m_layers.size() != m_layers.size())
+    {
+        throw std::invalid_argument("Cannot copy parameters from a model with a different number of layers.");
+    }
+    // Same-shape assignment reuses each matrix's storage
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        m_layers[l].setWeights(source.m_layers[l].getWeights());
+        m_layers[l].setBiases(source.m_layers[l].getBiases());
+    }
+    m_input_folded = source.m_input_folded;
+    m_scaler = source.m_scaler;
+}
 
-        // Save weights
-        file << "WEIGHTS\n";
-        file << weights.getRows() << "," << weights.getCols() << "\n";
-        for (int i = 0; i < weights.getRows(); ++i)
+void Model::save_best()
+{
+    save_best(*this);
+}
+
+void Model::save_best(const Model &source)
+{
+    if (source.m_layers.size() != m_layers.size())
+    {
+        throw std::invalid_argument("Best-model snapshot has a different number of layers.");
+    }
+    if (m_best_weights.size() != m_layers.size())
+    {
+        // First save: size the buffers once, later saves copy into them
+        m_best_weights.clear();
+        m_best_biases.clear();
+        m_best_weights.reserve(m_layers.size());
+        m_best_biases.reserve(m_layers.size());
+        for (const auto &layer : m_layers)
         {
-            for (int j = 0; j < weights.getCols(); ++j)
-            {
-                file << weights(i, j) << (j == weights.getCols() - 1 ? "" : ",");
-            }
-            file << "\n";
+            m_best_weights.emplace_back(layer.getWeights().getRows(), layer.getWeights().getCols());
+            m_best_biases.emplace_back(layer.getBiases().getRows(), layer.getBiases().getCols());
+        }
+    }
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const Matrix &weights = source.m_layers[l].getWeights();
+        const Matrix &biases = source.m_layers[l].getBiases();
+        if (weights.getRows() != m_best_weights[l].getRows() || weights.getCols() != m_best_weights[l].getCols() ||
+            biases.getRows() != m_best_biases[l].getRows() || biases.getCols() != m_best_biases[l].getCols())
+        {
+            throw std::invalid_argument("Layer " + std::to_string(l) + " shape mismatch in best-model snapshot.");
         }
+        // Same-shape assignment reuses the existing storage
+        m_best_weights[l] = weights;
+        m_best_biases[l] = biases;
+    }
+    m_has_best = true;
+}
 
-        // Save biases
-        file << "BIASES\n";
-        file << biases.getRows() << "," << biases.getCols() << "\n";
-        for (int i = 0; i < biases.getRows(); ++i)
+void Model::restore_best()
+{
+    if (!m_has_best)
+    {
+        throw std::runtime_error("No best-model snapshot has been saved.");
+    }
+    if (isMapped())
+    {
+        throw std::runtime_error("Cannot modify a read-only memory-mapped model.");
+    }
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        m_layers[l].setWeights(m_best_weights[l]);
+        m_layers[l].setBiases(m_best_biases[l]);
+    }
+}
+
+bool Model::hasBest() const
+{
+    return m_has_best;
+}
+
+void Model::check_architecture(const std::vector<LayerSpec> &specs) const
+{
+    if (specs.size() != m_layers.size())
+    {
+        throw std::runtime_error("Model file has " + std::to_string(specs.size()) +
+                                 " layers, expected " + std::to_string(m_layers.size()));
+    }
+    for (size_t l = 0; l < specs.size(); ++l)
+    {
+        const Matrix &weights = m_layers[l].getWeights();
+        if (specs[l].inputs != weights.getRows() || specs[l].outputs != weights.getCols())
         {
-            for (int j = 0; j < biases.getCols(); ++j)
-            {
-                file << biases(i, j) << (j == biases.getCols() - 1 ? "" : ",");
-            }
-            file << "\n";
+            throw std::runtime_error("Layer " + std::to_string(l) + " shape mismatch in model file.");
         }
+        if (specs[l].activation != m_layers[l].getActivation()->name())
+        {
+            throw std::runtime_error("Layer " + std::to_string(l) + " activation mismatch in model file: " +
+                                     specs[l].activation);
+        }
+    }
+}
+
+void Model::save(const std::string &filepath) const
+{
+    if (has_binary_extension(filepath))
+    {
+        save_binary(filepath);
+        return;
     }
+
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not open file for saving: " + filepath);
+    }
+    save_text(file);
     file.close();
 }
 
+void Model::save_text(std::ostream &file) const
+{
+    // Enough digits for every double to read back bit-exact
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    // Architecture and preprocessing header, skipped by readers that only look for WEIGHTS
+    file << "MODEL 2\n";
+    for (const auto &spec : describe())
+    {
+        file << "LAYER " << spec.inputs << " " << spec.outputs << " " << spec.activation << " " << spec.regularizer;
+        for (double param : spec.regularizer_params)
+        {
+            file << " " << param;
+        }
+        file << "\n";
+    }
+    if (m_input_folded)
+    {
+        file << "PREPROCESSING folded\n";
+    }
+    if (hasScaler())
+    {
+        const Matrix &mean = m_scaler.getMean();
+        file << "SCALER " << mean.getCols() << " " << m_scaler.getCount() << "\n";
+        write_row(file, mean.data(), mean.getCols());
+        write_row(file, m_scaler.getStd().data(), mean.getCols());
+    }
+
+    for (const auto &layer : m_layers)
+    {
+        write_matrix(file, "WEIGHTS", layer.getWeights());
+        write_matrix(file, "BIASES", layer.getBiases());
+    }
+}
+
 void Model::load(const std::string &filepath)
 {
+    if (is_binary_file(filepath))
+    {
+        load_binary(filepath);
+        return;
+    }
+
     std::ifstream file(filepath);
     if (!file.is_open())
     {
         throw std::runtime_error("Could not open file for loading: " + filepath);
     }
 
+    // Header first; legacy files without one go straight to the WEIGHTS blocks
+    std::vector<LayerSpec> specs = read_text_architecture(file);
+    if (!specs.empty())
+    {
+        check_architecture(specs);
+    }
+    file.clear();
+    file.seekg(0);
+
     std::string line;
     size_t layer_idx = 0;
-    while (layer_idx < m_layers.size() && std::getline(file, line))
+    m_input_folded = false;
+    m_scaler.reset();
+    while (std::getline(file, line))
     {
-        if (line != "WEIGHTS")
-            continue;
-
-        // Load Weights
-        std::getline(file, line); // Get dimensions
-        std::stringstream ss_dims(line);
-        std::string rows_str, cols_str;
-        std::getline(ss_dims, rows_str, ',');
-        std::getline(ss_dims, cols_str, ',');
-        int rows = std::stoi(rows_str);
-        int cols = std::stoi(cols_str);
-
-        Matrix weights(rows, cols);
-        for (int i = 0; i < rows; ++i)
+        if (line == "PREPROCESSING folded")
         {
-            std::getline(file, line);
-            std::stringstream ss_row(line);
-            std::string val_str;
-            for (int j = 0; j < cols; ++j)
-            {
-                std::getline(ss_row, val_str, ',');
-                weights(i, j) = std::stod(val_str);
-            }
+            m_input_folded = true;
+        }
+        else if (starts_with(line, "SCALER "))
+        {
+            std::stringstream ss(line.substr(7));
+            int cols = 0;
+            long long count = 0;
+            ss >> cols >> count;
+            Matrix mean(1, cols);
+            Matrix std(1, cols);
+            read_row(file, mean.data(), cols);
+            read_row(file, std.data(), cols);
+            m_scaler.set_statistics(mean, std, count);
         }
-        m_layers[layer_idx].setWeights(weights);
-
-        // Load Biases
-        std::getline(file, line); // Should be "BIASES"
-        if (line != "BIASES")
-            break; // Or throw error
-
-        std::getline(file, line); // Get dimensions
-        std::stringstream ss_bdims(line);
-        std::getline(ss_bdims, rows_str, ',');
-        std::getline(ss_bdims, cols_str, ',');
-        rows = std::stoi(rows_str);
-        cols = std::stoi(cols_str);
-
-        Matrix biases(rows, cols);
-        for (int i = 0; i < rows; ++i)
+        else if (line == "WEIGHTS")
         {
+            if (layer_idx >= m_layers.size())
+            {
+                throw std::runtime_error("Model file has more layers than the model.");
+            }
+            m_layers[layer_idx].setWeights(Matrix::read_text(file));
+
             std::getline(file, line);
-            std::stringstream ss_brow(line);
-            std::string val_str;
-            for (int j = 0; j < cols; ++j)
+            if (line != "BIASES")
             {
-                std::getline(ss_brow, val_str, ',');
-                biases(i, j) = std::stod(val_str);
+                throw std::runtime_error("Model file is missing the BIASES block of layer " + std::to_string(layer_idx));
             }
+            m_layers[layer_idx].setBiases(Matrix::read_text(file));
+            layer_idx++;
         }
-        m_layers[layer_idx].setBiases(biases);
-
-        layer_idx++;
+    }
+    if (layer_idx != m_layers.size())
+    {
+        throw std::runtime_error("Model file has " + std::to_string(layer_idx) +
+                                 " layers, expected " + std::to_string(m_layers.size()));
     }
     file.close();
 }
+
+void Model::apply_input_affine(const Matrix &shift, const Matrix &scale)
+{
+    if (m_layers.empty())
+    {
+        throw std::runtime_error("Cannot fold input preprocessing into an empty model.");
+    }
+    if (isMapped())
+    {
+        throw std::runtime_error("Cannot modify a read-only memory-mapped model.");
+    }
+    Matrix &weights = m_layers[0].getWeights();
+    Matrix &biases = m_layers[0].getBiases();
+    int inputs = weights.getRows();
+    int outputs = weights.getCols();
+    if (shift.getCols() != inputs || scale.getCols() != inputs)
+    {
+        throw std::invalid_argument("Input preprocessing does not match the first layer's input size.");
+    }
+
+    // (x - shift) * scale * W + b  ==  x * (diag(scale) W) + (b - (shift * scale) W)
+    for (int i = 0; i < inputs; ++i)
+    {
+        double s = scale(0, i);
+        double offset = shift(0, i) * s;
+        for (int j = 0; j < outputs; ++j)
+        {
+            biases(0, j) -= offset * weights(i, j);
+            weights(i, j) *= s;
+        }
+    }
+}
+
+void Model::fold_input_transform(const Matrix &shift, const Matrix &scale)
+{
+    apply_input_affine(shift, scale);
+    m_input_folded = true;
+}
+
+void Model::unfold_input_transform(const Matrix &shift, const Matrix &scale)
+{
+    // x = x' / scale + shift, i.e. the affine map with shift' = -shift * scale, scale' = 1 / scale
+    Matrix inv_shift(1, shift.getCols());
+    Matrix inv_scale(1, scale.getCols());
+    for (int i = 0; i < scale.getCols(); ++i)
+    {
+        inv_shift(0, i) = -shift(0, i) * scale(0, i);
+        inv_scale(0, i) = 1.0 / scale(0, i);
+    }
+    apply_input_affine(inv_shift, inv_scale);
+    m_input_folded = false;
+}
+
+void Model::fold_scaler(const StandardScaler &scaler)
+{
+    auto transform = scaler_transform(scaler);
+    fold_input_transform(transform.first, transform.second);
+}
+
+void Model::unfold_scaler(const StandardScaler &scaler)
+{
+    auto transform = scaler_transform(scaler);
+    unfold_input_transform(transform.first, transform.second);
+}
+
+bool Model::hasFoldedInput() const
+{
+    return m_input_folded;
+}
+
+void Model::setScaler(const StandardScaler &scaler)
+{
+    m_scaler = scaler;
+}
+
+const StandardScaler &Model::getScaler() const
+{
+    return m_scaler;
+}
+
+bool Model::hasScaler() const
+{
+    return m_scaler.getCount() > 0;
+}
+
+bool Model::isMapped() const
+{
+    for (const auto &layer : m_layers)
+    {
+        if (layer.getWeights().isView())
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "Model.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary model layout (host byte order, every section 64-byte aligned):
+//   BinaryHeader
+//   BinaryLayerRecord[layer_count]        (BinaryLayerRecordV1 in version 1 files)
+//   scaler mean, scaler std (1 x scaler_cols doubles each, when kFlagScaler is set)
+//   per layer: weights (rows x cols doubles), biases (1 x cols doubles)
+// The checksum covers everything after the header.
+namespace
+{
+const char kMagic[8] = {'M', 'L', 'P', 'B', 'I', 'N', '\0', '\0'};
+const uint32_t kVersion = 2;
+const uint32_t kEndianTag = 0x01020304;
+const size_t kAlignment = 64;
+
+const uint32_t kFlagInputFolded = 1u << 0;
+const uint32_t kFlagScaler = 1u << 1;
+
+struct BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t layer_count;
+    uint32_t flags;
+    uint64_t file_size;
+    uint64_t checksum;
+    uint32_t scaler_cols;
+    uint32_t reserved0;
+    uint64_t scaler_count;
+    uint8_t reserved[8];
+};
+static_assert(sizeof(BinaryHeader) == kAlignment, "BinaryHeader must fill one alignment block");
+
+struct BinaryLayerRecordV1
+{
+    int32_t rows;
+    int32_t cols;
+    char activation[24];
+};
+static_assert(sizeof(BinaryLayerRecordV1) == 32, "BinaryLayerRecordV1 layout changed");
+
+struct BinaryLayerRecord
+{
+    int32_t rows;
+    int32_t cols;
+    char activation[24];
+    char regularizer[16];
+    double regularizer_params[2];
+};
+static_assert(sizeof(BinaryLayerRecord) == 64, "BinaryLayerRecord layout changed");
+
+size_t align_up(size_t offset)
+{
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// FNV-1a over 64-bit words; all sections are padded to a multiple of 8 bytes
+uint64_t checksum(const char *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t matrix_bytes(int rows, int cols)
+{
+    return static_cast<size_t>(rows) * cols * sizeof(double);
+}
+
+void copy_name(char *dst, size_t capacity, const std::string &name)
+{
+    if (name.size() >= capacity)
+    {
+        throw std::runtime_error("Name too long for binary model format: " + name);
+    }
+    std::memcpy(dst, name.data(), name.size());
+}
+
+std::string read_name(const char *src, size_t capacity)
+{
+    return std::string(src, strnlen(src, capacity));
+}
+
+// Where each section of a binary model lives
+struct BinaryLayout
+{
+    size_t scaler_offset = 0;
+    std::vector<size_t> blocks; // weights and biases offsets, in file order
+    size_t file_size = 0;
+};
+
+BinaryLayout compute_layout(const std::vector<LayerSpec> &specs, size_t record_size, size_t scaler_cols)
+{
+    BinaryLayout layout;
+    size_t offset = align_up(sizeof(BinaryHeader) + specs.size() * record_size);
+    layout.scaler_offset = offset;
+    if (scaler_cols > 0)
+    {
+        offset = align_up(offset + matrix_bytes(1, scaler_cols));
+        offset = align_up(offset + matrix_bytes(1, scaler_cols));
+    }
+    for (const auto &spec : specs)
+    {
+        layout.blocks.push_back(offset);
+        offset = align_up(offset + matrix_bytes(spec.inputs, spec.outputs));
+        layout.blocks.push_back(offset);
+        offset = align_up(offset + matrix_bytes(1, spec.outputs));
+    }
+    layout.file_size = offset;
+    return layout;
+}
+
+// Validated view of a binary model held in memory
+struct BinaryImage
+{
+    BinaryHeader header;
+    std::vector<LayerSpec> specs;
+    BinaryLayout layout;
+};
+
+BinaryHeader read_header(const char *data, size_t size, const std::string &filepath)
+{
+    if (size < sizeof(BinaryHeader))
+    {
+        throw std::runtime_error("Model file is truncated: " + filepath);
+    }
+    BinaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    {
+        throw std::runtime_error("Not a binary model file: " + filepath);
+    }
+    if (header.version < 1 || header.version > kVersion)
+    {
+        throw std::runtime_error("Unsupported binary model version " + std::to_string(header.version));
+    }
+    if (header.endian_tag != kEndianTag)
+    {
+        throw std::runtime_error("Binary model was written with a different byte order.");
+    }
+    if (header.version == 1)
+    {
+        header.flags &= kFlagInputFolded;
+        header.scaler_cols = 0;
+        header.scaler_count = 0;
+    }
+    return header;
+}
+
+std::vector<LayerSpec> read_layer_table(const BinaryHeader &header, const char *data, size_t size,
+                                        const std::string &filepath)
+{
+    size_t record_size = header.version == 1 ? sizeof(BinaryLayerRecordV1) : sizeof(BinaryLayerRecord);
+    if (sizeof(BinaryHeader) + static_cast<size_t>(header.layer_count) * record_size > size)
+    {
+        throw std::runtime_error("Model file is truncated: " + filepath);
+    }
+    std::vector<LayerSpec> specs(header.layer_count);
+    const char *table = data + sizeof(BinaryHeader);
+    for (uint32_t l = 0; l < header.layer_count; ++l)
+    {
+        LayerSpec &spec = specs[l];
+        spec.regularizer = "none";
+        if (header.version == 1)
+        {
+            BinaryLayerRecordV1 record;
+            std::memcpy(&record, table + l * record_size, sizeof(record));
+            spec.inputs = record.rows;
+            spec.outputs = record.cols;
+            spec.activation = read_name(record.activation, sizeof(record.activation));
+            continue;
+        }
+        BinaryLayerRecord record;
+        std::memcpy(&record, table + l * record_size, sizeof(record));
+        spec.inputs = record.rows;
+        spec.outputs = record.cols;
+        spec.activation = read_name(record.activation, sizeof(record.activation));
+        spec.regularizer = read_name(record.regularizer, sizeof(record.regularizer));
+        if (spec.regularizer == "elasticnet")
+            spec.regularizer_params.assign(record.regularizer_params, record.regularizer_params + 2);
+        else if (spec.regularizer != "none")
+            spec.regularizer_params.assign(record.regularizer_params, record.regularizer_params + 1);
+    }
+    return specs;
+}
+
+BinaryImage parse_image(const char *data, size_t size, const std::string &filepath, bool verify_checksum = true)
+{
+    BinaryImage image;
+    image.header = read_header(data, size, filepath);
+    if (image.header.file_size != size)
+    {
+        throw std::runtime_error("Model file is truncated: " + filepath);
+    }
+    if (verify_checksum &&
+        checksum(data + sizeof(BinaryHeader), size - sizeof(BinaryHeader)) != image.header.checksum)
+    {
+        throw std::runtime_error("Model file checksum mismatch: " + filepath);
+    }
+    image.specs = read_layer_table(image.header, data, size, filepath);
+    size_t record_size = image.header.version == 1 ? sizeof(BinaryLayerRecordV1) : sizeof(BinaryLayerRecord);
+    image.layout = compute_layout(image.specs, record_size, image.header.scaler_cols);
+    if (image.layout.file_size != size)
+    {
+        throw std::runtime_error("Model file layout does not match its layer table: " + filepath);
+    }
+    return image;
+}
+
+// Scaler statistics stored after the layer table
+void read_scaler(const BinaryImage &image, const char *data, StandardScaler &scaler)
+{
+    scaler.reset();
+    if (!(image.header.flags & kFlagScaler))
+        return;
+    int cols = static_cast<int>(image.header.scaler_cols);
+    size_t mean_offset = image.layout.scaler_offset;
+    size_t std_offset = align_up(mean_offset + matrix_bytes(1, cols));
+    Matrix mean(1, cols);
+    Matrix std(1, cols);
+    std::memcpy(mean.data(), data + mean_offset, matrix_bytes(1, cols));
+    std::memcpy(std.data(), data + std_offset, matrix_bytes(1, cols));
+    scaler.set_statistics(mean, std, static_cast<long long>(image.header.scaler_count));
+}
+} // namespace
+
+bool Model::is_binary_file(const std::string &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[sizeof(kMagic)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+std::vector<LayerSpec> Model::read_binary_architecture(const std::string &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not open file for loading: " + filepath);
+    }
+    // Header and layer table only; the weights are checked when loading
+    std::vector<char> head(sizeof(BinaryHeader));
+    file.read(head.data(), head.size());
+    BinaryHeader header = read_header(head.data(), file.gcount(), filepath);
+    size_t record_size = header.version == 1 ? sizeof(BinaryLayerRecordV1) : sizeof(BinaryLayerRecord);
+    head.resize(sizeof(BinaryHeader) + static_cast<size_t>(header.layer_count) * record_size);
+    file.read(head.data() + sizeof(BinaryHeader), head.size() - sizeof(BinaryHeader));
+    return read_layer_table(header, head.data(), sizeof(BinaryHeader) + file.gcount(), filepath);
+}
+
+void Model::save_binary(const std::string &filepath) const
+{
+    std::vector<LayerSpec> specs = describe();
+    std::vector<BinaryLayerRecord> records(specs.size());
+    for (size_t l = 0; l < specs.size(); ++l)
+    {
+        std::memset(&records[l], 0, sizeof(BinaryLayerRecord));
+        records[l].rows = specs[l].inputs;
+        records[l].cols = specs[l].outputs;
+        copy_name(records[l].activation, sizeof(records[l].activation), specs[l].activation);
+        copy_name(records[l].regularizer, sizeof(records[l].regularizer), specs[l].regularizer);
+        if (specs[l].regularizer_params.size() > 2)
+        {
+            throw std::runtime_error("Too many regularizer parameters for binary model format.");
+        }
+        for (size_t p = 0; p < specs[l].regularizer_params.size(); ++p)
+        {
+            records[l].regularizer_params[p] = specs[l].regularizer_params[p];
+        }
+    }
+
+    size_t scaler_cols = hasScaler() ? m_scaler.getMean().getCols() : 0;
+    BinaryLayout layout = compute_layout(specs, sizeof(BinaryLayerRecord), scaler_cols);
+    std::vector<char> buffer(layout.file_size, 0);
+    std::memcpy(buffer.data() + sizeof(BinaryHeader), records.data(), records.size() * sizeof(BinaryLayerRecord));
+    if (scaler_cols > 0)
+    {
+        size_t mean_offset = layout.scaler_offset;
+        size_t std_offset = align_up(mean_offset + matrix_bytes(1, scaler_cols));
+        std::memcpy(buffer.data() + mean_offset, m_scaler.getMean().data(), matrix_bytes(1, scaler_cols));
+        std::memcpy(buffer.data() + std_offset, m_scaler.getStd().data(), matrix_bytes(1, scaler_cols));
+    }
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const Matrix &weights = m_layers[l].getWeights();
+        const Matrix &biases = m_layers[l].getBiases();
+        std::memcpy(buffer.data() + layout.blocks[2 * l], weights.data(), matrix_bytes(weights.getRows(), weights.getCols()));
+        std::memcpy(buffer.data() + layout.blocks[2 * l + 1], biases.data(), matrix_bytes(1, biases.getCols()));
+    }
+
+    BinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.layer_count = static_cast<uint32_t>(m_layers.size());
+    header.flags = (m_input_folded ? kFlagInputFolded : 0) | (scaler_cols > 0 ? kFlagScaler : 0);
+    header.file_size = layout.file_size;
+    header.scaler_cols = static_cast<uint32_t>(scaler_cols);
+    header.scaler_count = scaler_cols > 0 ? static_cast<uint64_t>(m_scaler.getCount()) : 0;
+    header.checksum = checksum(buffer.data() + sizeof(BinaryHeader), layout.file_size - sizeof(BinaryHeader));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not open file for saving: " + filepath);
+    }
+    file.write(buffer.data(), buffer.size());
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write model file: " + filepath);
+    }
+}
+
+void Model::load_binary(const std::string &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not open file for loading: " + filepath);
+    }
+    size_t size = static_cast<size_t>(file.tellg());
+    // One read for the whole file
+    std::vector<char> buffer(size);
+    file.seekg(0);
+    if (!file.read(buffer.data(), size))
+    {
+        throw std::runtime_error("Failed to read model file: " + filepath);
+    }
+
+    BinaryImage image = parse_image(buffer.data(), size, filepath);
+    check_architecture(image.specs);
+
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const LayerSpec &spec = image.specs[l];
+        std::memcpy(m_layers[l].getWeights().data(), buffer.data() + image.layout.blocks[2 * l],
+                    matrix_bytes(spec.inputs, spec.outputs));
+        std::memcpy(m_layers[l].getBiases().data(), buffer.data() + image.layout.blocks[2 * l + 1],
+                    matrix_bytes(1, spec.outputs));
+    }
+
+    m_input_folded = (image.header.flags & kFlagInputFolded) != 0;
+    read_scaler(image, buffer.data(), m_scaler);
+}
+
+Model Model::map_file(const std::string &filepath, bool verify_checksum)
+{
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open file for loading: " + filepath);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinaryHeader)))
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a binary model file: " + filepath);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED)
+    {
+        throw std::runtime_error("Could not map model file: " + filepath);
+    }
+    std::shared_ptr<const char> mapping(static_cast<const char *>(addr), [size](const char *p)
+                                        { ::munmap(const_cast<char *>(p), size); });
+
+    BinaryImage image = parse_image(mapping.get(), size, filepath, verify_checksum);
+    Model model;
+    for (size_t l = 0; l < image.specs.size(); ++l)
+    {
+        const LayerSpec &spec = image.specs[l];
+        // PROT_READ pages: the views must never be written, which isMapped() guards
+        double *weights = reinterpret_cast<double *>(const_cast<char *>(mapping.get() + image.layout.blocks[2 * l]));
+        double *biases = reinterpret_cast<double *>(const_cast<char *>(mapping.get() + image.layout.blocks[2 * l + 1]));
+        model.add(DenseLayer(Matrix::view(weights, spec.inputs, spec.outputs), Matrix::view(biases, 1, spec.outputs),
+                             Activation::create(spec.activation),
+                             Regularizer::create(spec.regularizer, spec.regularizer_params)));
+    }
+    model.m_input_folded = (image.header.flags & kFlagInputFolded) != 0;
+    read_scaler(image, mapping.get(), model.m_scaler);
+    model.m_mapping = mapping;
+    return model;
+}
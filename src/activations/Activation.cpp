@@ -0,0 +1,43 @@
+#include "activations/Activation.hpp"
+#include "activations/GELU.hpp"
+#include "activations/LinearActivation.hpp"
+#include "activations/ReLU.hpp"
+#include "activations/Sigmoid.hpp"
+#include "activations/Softmax.hpp"
+#include "activations/Tanh.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void Activation::forward_in_place(Matrix &values)
+{
+    Matrix output = forward(values);
+    std::copy(output.data(), output.data() + output.size(), values.data());
+}
+
+void Activation::backward_in_place(const Matrix &, Matrix &gradient)
+{
+    Matrix d_input = backward(gradient);
+    std::copy(d_input.data(), d_input.data() + d_input.size(), gradient.data());
+}
+
+bool Activation::needs_input() const
+{
+    return false;
+}
+
+std::shared_ptr<Activation> Activation::create(const std::string &name)
+{
+    if (name == "relu")
+        return std::make_shared<ReLU>();
+    if (name == "linear")
+        return std::make_shared<LinearActivation>();
+    if (name == "softmax")
+        return std::make_shared<Softmax>();
+    if (name == "sigmoid")
+        return std::make_shared<Sigmoid>();
+    if (name == "tanh")
+        return std::make_shared<Tanh>();
+    if (name == "gelu")
+        return std::make_shared<GELU>();
+    throw std::invalid_argument("Unknown activation: " + name);
+}
@@ -0,0 +1,52 @@
+#include "activations/GELU.hpp"
+#include "math/VectorMath.hpp"
+#include <algorithm>
+
+GELU::GELU() : m_input(0, 0) {}
+
+std::string GELU::name() const
+{
+    return "gelu";
+}
+
+Matrix GELU::forward(const Matrix &input)
+{
+    m_input = input;
+    Matrix output(input.getRows(), input.getCols());
+    vector_gelu(input.data(), output.data(), input.size());
+    return output;
+}
+
+Matrix GELU::backward(const Matrix &d_output)
+{
+    Matrix d_input = d_output;
+    backward_in_place(m_input, d_input);
+    return d_input;
+}
+
+void GELU::forward_in_place(Matrix &values)
+{
+    vector_gelu(values.data(), values.data(), values.size());
+}
+
+// From the input, a block at a time through a small buffer on the stack
+void GELU::backward_in_place(const Matrix &input, Matrix &gradient)
+{
+    const size_t kBlock = 256;
+    double derivative[kBlock];
+    double *grad = gradient.data();
+    for (size_t begin = 0; begin < gradient.size(); begin += kBlock)
+    {
+        size_t count = std::min(kBlock, gradient.size() - begin);
+        vector_gelu_derivative(input.data() + begin, derivative, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            grad[begin + i] *= derivative[i];
+        }
+    }
+}
+
+bool GELU::needs_input() const
+{
+    return true;
+}
@@ -2,6 +2,10 @@
 
 LinearActivation::LinearActivation() {}
 
+std::string LinearActivation::name() const {
+    return "linear";
+}
+
 // Forward pass just returns the input
 Matrix LinearActivation::forward(const Matrix& input) {
     return input;
@@ -10,4 +14,8 @@ Matrix LinearActivation::forward(const Matrix& input) {
 // Backward pass just returns the gradient (derivative is 1)
 Matrix LinearActivation::backward(const Matrix& d_output) {
     return d_output;
-}
\ No newline at end of file
+}
+
+void LinearActivation::forward_in_place(Matrix&) {}
+
+void LinearActivation::backward_in_place(const Matrix&, Matrix&) {}
@@ -2,6 +2,11 @@
 
 ReLU::ReLU() : m_input(0, 0) {}
 
+std::string ReLU::name() const
+{
+    return "relu";
+}
+
 Matrix ReLU::forward(const Matrix &input)
 {
     m_input = input;
@@ -27,3 +32,20 @@ Matrix ReLU::backward(const Matrix &d_output)
     }
     return d_input;
 }
+
+void ReLU::forward_in_place(Matrix &values)
+{
+    values.map([](double val)
+               { return val > 0 ? val : 0; });
+}
+
+// The output is positive exactly where the input was
+void ReLU::backward_in_place(const Matrix &output, Matrix &gradient)
+{
+    const double *out = output.data();
+    double *grad = gradient.data();
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        grad[i] *= out[i] > 0 ? 1.0 : 0.0;
+    }
+}
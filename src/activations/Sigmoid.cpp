@@ -0,0 +1,40 @@
+#include "activations/Sigmoid.hpp"
+#include "math/VectorMath.hpp"
+
+Sigmoid::Sigmoid() : m_output(0, 0) {}
+
+std::string Sigmoid::name() const
+{
+    return "sigmoid";
+}
+
+Matrix Sigmoid::forward(const Matrix &input)
+{
+    Matrix output(input.getRows(), input.getCols());
+    vector_sigmoid(input.data(), output.data(), input.size());
+    m_output = output;
+    return output;
+}
+
+// s' = s (1 - s), from the output
+Matrix Sigmoid::backward(const Matrix &d_output)
+{
+    Matrix d_input = d_output;
+    backward_in_place(m_output, d_input);
+    return d_input;
+}
+
+void Sigmoid::forward_in_place(Matrix &values)
+{
+    vector_sigmoid(values.data(), values.data(), values.size());
+}
+
+void Sigmoid::backward_in_place(const Matrix &output, Matrix &gradient)
+{
+    const double *out = output.data();
+    double *grad = gradient.data();
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        grad[i] *= out[i] * (1.0 - out[i]);
+    }
+}
@@ -1,37 +1,22 @@
 #include "activations/Softmax.hpp"
-#include <cmath>
-#include <numeric>
+#include "math/VectorMath.hpp"
 
 Softmax::Softmax() {}
 
+std::string Softmax::name() const
+{
+    return "softmax";
+}
+
+// Each row in one call of the vector kernel: max, exponentials and their sum,
+// then a multiplication by the reciprocal
 Matrix Softmax::forward(const Matrix &input)
 {
     Matrix output(input.getRows(), input.getCols());
+    const size_t cols = input.getCols();
     for (int i = 0; i < input.getRows(); ++i)
     {
-        // Find max value in the row for stability
-        double max_val = input(i, 0);
-        for (int j = 1; j < input.getCols(); ++j)
-        {
-            if (input(i, j) > max_val)
-            {
-                max_val = input(i, j);
-            }
-        }
-
-        // Exponentiate and sum
-        double sum = 0.0;
-        for (int j = 0; j < input.getCols(); ++j)
-        {
-            output(i, j) = std::exp(input(i, j) - max_val);
-            sum += output(i, j);
-        }
-
-        // Normalize to get probabilities
-        for (int j = 0; j < input.getCols(); ++j)
-        {
-            output(i, j) /= sum;
-        }
+        vector_softmax(input.data() + i * cols, output.data() + i * cols, cols);
     }
     return output;
 }
@@ -43,4 +28,17 @@ Matrix Softmax::backward(const Matrix &d_output)
     // This function will thus not be used in our final training loop for classification.
     // For now, we just pass the gradient through.
     return d_output;
-}
\ No newline at end of file
+}
+
+void Softmax::forward_in_place(Matrix &values)
+{
+    const int cols = values.getCols();
+    for (int i = 0; i < values.getRows(); ++i)
+    {
+        double *row = values.data() + static_cast<size_t>(i) * cols;
+        vector_softmax(row, row, cols);
+    }
+}
+
+// Passes the gradient through, like backward(): the loss supplies the combined gradient
+void Softmax::backward_in_place(const Matrix &, Matrix &) {}
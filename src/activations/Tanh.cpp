@@ -0,0 +1,40 @@
+#include "activations/Tanh.hpp"
+#include "math/VectorMath.hpp"
+
+Tanh::Tanh() : m_output(0, 0) {}
+
+std::string Tanh::name() const
+{
+    return "tanh";
+}
+
+Matrix Tanh::forward(const Matrix &input)
+{
+    Matrix output(input.getRows(), input.getCols());
+    vector_tanh(input.data(), output.data(), input.size());
+    m_output = output;
+    return output;
+}
+
+// tanh' = 1 - tanh^2, from the output
+Matrix Tanh::backward(const Matrix &d_output)
+{
+    Matrix d_input = d_output;
+    backward_in_place(m_output, d_input);
+    return d_input;
+}
+
+void Tanh::forward_in_place(Matrix &values)
+{
+    vector_tanh(values.data(), values.data(), values.size());
+}
+
+void Tanh::backward_in_place(const Matrix &output, Matrix &gradient)
+{
+    const double *out = output.data();
+    double *grad = gradient.data();
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        grad[i] *= (1.0 - out[i] * out[i]);
+    }
+}
@@ -0,0 +1,304 @@
+#include "codegen/CodeGenerator.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace
+{
+// Shortest text that reads back as exactly the same double
+std::string literal(double value)
+{
+    if (!std::isfinite(value))
+    {
+        throw std::runtime_error("Cannot generate code for a model with non-finite parameters.");
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+void write_array(std::ostream &out, const double *values, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        out << (i % 8 == 0 ? "\n        " : " ") << literal(values[i]) << ",";
+    }
+}
+
+// Runs a shell command, returning its exit status and everything it printed
+int run_command(const std::string &command, std::string &output)
+{
+    FILE *pipe = popen((command + " 2>&1").c_str(), "r");
+    if (!pipe)
+    {
+        throw std::runtime_error("Could not run: " + command);
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    {
+        output.append(buffer, read);
+    }
+    return pclose(pipe);
+}
+
+std::string quoted(const std::string &path)
+{
+    std::string result = "'";
+    for (char c : path)
+    {
+        result += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return result + "'";
+}
+} // namespace
+
+CodeGenerator::CodeGenerator(Model &model, const Matrix &shift, const Matrix &scale, const std::string &name)
+    : m_name(name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])) ||
+        !std::all_of(name.begin(), name.end(), [](char c)
+                     { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }))
+    {
+        throw std::invalid_argument("Not a C++ identifier: " + name);
+    }
+    if (model.getLayers().empty())
+    {
+        throw std::invalid_argument("Cannot generate code for an empty model.");
+    }
+    // The generated code takes raw features, so fold the preprocessing into a copy
+    Model folded = model.snapshot();
+    folded.fold_input_transform(shift, scale);
+    std::vector<DenseLayer> &layers = folded.getLayers();
+
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        Layer layer{layers[l].getWeights().getRows(), layers[l].getWeights().getCols(),
+                    layers[l].getActivation()->name(), layers[l].getWeights(), layers[l].getBiases()};
+        bool elementwise = layer.activation == "relu" || layer.activation == "linear" ||
+                           layer.activation == "sigmoid" || layer.activation == "tanh" || layer.activation == "gelu";
+        if (!elementwise && (layer.activation != "softmax" || l + 1 != layers.size()))
+        {
+            throw std::invalid_argument("Code generation does not support a layer with activation: " +
+                                        layer.activation);
+        }
+        m_layers.push_back(std::move(layer));
+    }
+}
+
+std::string CodeGenerator::header() const
+{
+    std::string guard = "MLP_GENERATED_" + m_name + "_HPP";
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](char c)
+                   { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+    std::string shape = std::to_string(m_layers.front().inputs);
+    std::string activations;
+    for (const Layer &layer : m_layers)
+    {
+        shape += "-" + std::to_string(layer.outputs);
+        activations += (activations.empty() ? "" : ", ") + layer.activation;
+    }
+    bool softmax = m_layers.back().activation == "softmax";
+    bool cmath = false;
+    for (const Layer &layer : m_layers)
+        cmath = cmath || (layer.activation != "relu" && layer.activation != "linear");
+
+    std::ostringstream out;
+    out << "// Generated by mlp from a trained model; do not edit.\n"
+        << "// Layers " << shape << " (" << activations << "). Takes raw features: the input\n"
+        << "// preprocessing is folded into the first layer. Requires C++17.\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    if (cmath)
+        out << "#include <cmath>\n\n";
+    out << "namespace " << m_name << "\n{\n"
+        << "constexpr int kInputs = " << m_layers.front().inputs << ";\n"
+        << "constexpr int kOutputs = " << m_layers.back().outputs << ";\n\n"
+        << "namespace detail\n{\n";
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const Layer &layer = m_layers[l];
+        out << "alignas(64) inline constexpr double w" << l << "[" << layer.inputs << "][" << layer.outputs
+            << "] = {";
+        for (int i = 0; i < layer.inputs; ++i)
+        {
+            out << "\n    {";
+            write_array(out, layer.weights.data() + static_cast<size_t>(i) * layer.outputs, layer.outputs);
+            out << "\n    },";
+        }
+        out << "\n};\n";
+        out << "alignas(64) inline constexpr double b" << l << "[" << layer.outputs << "] = {";
+        write_array(out, layer.biases.data(), layer.outputs);
+        out << "\n};\n";
+    }
+    out << "} // namespace detail\n\n"
+        << "// Scores one row: input holds kInputs raw features, output receives kOutputs values\n"
+        << "inline void predict(const double *input, double *output) noexcept\n{\n"
+        << "    using namespace detail;\n";
+
+    // Each layer accumulates x * W in input order, as Matrix::multiply does,
+    // then adds the bias; the inner loop runs along a row of W and vectorizes.
+    // Zero inputs (blank pixels, inactive ReLUs) skip their row of W entirely.
+    std::string previous = "input";
+    for (size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const Layer &layer = m_layers[l];
+        bool last = l + 1 == m_layers.size();
+        std::string h = "h" + std::to_string(l);
+        std::string outputs = std::to_string(layer.outputs);
+        out << "\n    // Layer " << l << ": " << layer.inputs << " -> " << layer.outputs << ", " << layer.activation
+            << "\n"
+            << "    alignas(64) double " << h << "[" << outputs << "] = {};\n"
+            << "    for (int i = 0; i < " << layer.inputs << "; ++i)\n    {\n"
+            << "        const double x = " << previous << "[i];\n"
+            << "        if (x == 0.0)\n"
+            << "            continue;\n"
+            << "        for (int o = 0; o < " << outputs << "; ++o)\n"
+            << "            " << h << "[o] += x * w" << l << "[i][o];\n    }\n";
+        std::string target = last ? "output" : h;
+        out << "    for (int o = 0; o < " << outputs << "; ++o)\n    {\n"
+            << "        const double z = " << h << "[o] + b" << l << "[o];\n";
+        if (layer.activation == "relu")
+            out << "        " << target << "[o] = z > 0.0 ? z : 0.0;\n";
+        else if (layer.activation == "sigmoid")
+            out << "        " << target << "[o] = 1.0 / (1.0 + std::exp(-z));\n";
+        else if (layer.activation == "tanh")
+            out << "        " << target << "[o] = std::tanh(z);\n";
+        else if (layer.activation == "gelu")
+            out << "        " << target
+                << "[o] = 0.5 * z * (1.0 + std::tanh(0.7978845608028654 * (z + 0.044715 * z * z * z)));\n";
+        else
+            out << "        " << target << "[o] = z;\n";
+        out << "    }\n";
+        previous = h;
+    }
+    if (softmax)
+    {
+        out << "\n    double largest = output[0];\n"
+            << "    for (int o = 1; o < kOutputs; ++o)\n"
+            << "        largest = output[o] > largest ? output[o] : largest;\n"
+            << "    double sum = 0.0;\n"
+            << "    for (int o = 0; o < kOutputs; ++o)\n    {\n"
+            << "        output[o] = std::exp(output[o] - largest);\n"
+            << "        sum += output[o];\n    }\n"
+            << "    for (int o = 0; o < kOutputs; ++o)\n"
+            << "        output[o] /= sum;\n";
+    }
+    out << "}\n} // namespace " << m_name << "\n\n#endif // " << guard << "\n";
+    return out.str();
+}
+
+void CodeGenerator::write_header(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    file << header();
+    if (!file)
+    {
+        throw std::runtime_error("Could not write generated code: " + filename);
+    }
+}
+
+double CodeGenerator::benchmark(const std::string &header_path, const std::string &compiler, const Matrix &input,
+                                const Matrix &expected, double &largest_difference) const
+{
+    if (input.getCols() != m_layers.front().inputs || expected.getCols() != m_layers.back().outputs ||
+        input.getRows() != expected.getRows() || input.getRows() == 0)
+    {
+        throw std::invalid_argument("Benchmark rows do not match the model.");
+    }
+    char resolved[PATH_MAX];
+    if (!realpath(header_path.c_str(), resolved))
+    {
+        throw std::runtime_error("Generated header not found: " + header_path);
+    }
+    char directory[] = "/tmp/mlp-codegen-XXXXXX";
+    if (!mkdtemp(directory))
+    {
+        throw std::runtime_error("Could not create a directory for the benchmark.");
+    }
+    std::string dir = directory;
+    std::string source = dir + "/benchmark.cpp", program = dir + "/benchmark", rows = dir + "/rows.bin";
+
+    // Rows file: row count, the inputs, then the expected outputs
+    {
+        std::ofstream file(rows, std::ios::binary);
+        long long count = input.getRows();
+        file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char *>(input.data()), input.size() * sizeof(double));
+        file.write(reinterpret_cast<const char *>(expected.data()), expected.size() * sizeof(double));
+    }
+    {
+        std::ofstream file(source);
+        file << "#include \"" << resolved << "\"\n"
+             << "#include <chrono>\n#include <cmath>\n#include <cstdio>\n#include <vector>\n"
+             << "using namespace " << m_name << ";\n"
+             << "int main(int, char **argv)\n{\n"
+             << "    std::FILE *file = std::fopen(argv[1], \"rb\");\n"
+             << "    long long rows = 0;\n"
+             << "    if (!file || std::fread(&rows, sizeof(rows), 1, file) != 1) return 1;\n"
+             << "    std::vector<double> input(rows * kInputs), expected(rows * kOutputs), output(rows * kOutputs);\n"
+             << "    if (std::fread(input.data(), sizeof(double), input.size(), file) != input.size() ||\n"
+             << "        std::fread(expected.data(), sizeof(double), expected.size(), file) != expected.size()) return 1;\n"
+             << "    double difference = 0.0;\n"
+             << "    for (long long r = 0; r < rows; ++r)\n"
+             << "        predict(&input[r * kInputs], &output[r * kOutputs]);\n"
+             << "    for (size_t i = 0; i < output.size(); ++i)\n"
+             << "        difference = std::fmax(difference, std::fabs(output[i] - expected[i]));\n"
+             << "    long long scored = 0;\n"
+             << "    double seconds = 0.0;\n"
+             << "    auto start = std::chrono::steady_clock::now();\n"
+             << "    while (seconds < 0.25)\n    {\n"
+             << "        for (long long r = 0; r < rows; ++r)\n"
+             << "            predict(&input[r * kInputs], &output[r * kOutputs]);\n"
+             << "        scored += rows;\n"
+             << "        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();\n"
+             << "    }\n"
+             << "    // Printing an output keeps the timed calls from being optimized away\n"
+             << "    std::printf(\"%.17g %.17g %.17g\\n\", 1e6 * seconds / scored, difference, output[0]);\n"
+             << "}\n";
+    }
+
+    std::string log;
+    int status = run_command(compiler + " -std=c++17 -o " + quoted(program) + " " + quoted(source), log);
+    std::string result;
+    if (status == 0)
+    {
+        status = run_command(quoted(program) + " " + quoted(rows), result);
+    }
+    std::remove(source.c_str());
+    std::remove(program.c_str());
+    std::remove(rows.c_str());
+    rmdir(directory);
+    if (status != 0)
+    {
+        throw std::runtime_error("Benchmark of the generated code failed:\n" + log + result);
+    }
+
+    double microseconds = 0.0;
+    std::istringstream parsed(result);
+    if (!(parsed >> microseconds >> largest_difference))
+    {
+        throw std::runtime_error("Unexpected benchmark output: " + result);
+    }
+    return microseconds;
+}
+
+std::string CodeGenerator::identifier_for(const std::string &filename)
+{
+    std::string stem = filename.substr(filename.find_last_of('/') + 1);
+    stem = stem.substr(0, stem.find('.'));
+    for (char &c : stem)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)))
+            c = '_';
+    }
+    if (stem.empty() || std::isdigit(static_cast<unsigned char>(stem[0])))
+        stem = "model_" + stem;
+    return stem;
+}
@@ -0,0 +1,177 @@
+#include "factorization/LowRank.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+// Columns count as orthogonal once their cosine is below this
+const double kTolerance = 1e-13;
+const int kMaxSweeps = 100;
+
+double dot(const double *a, const double *b, int n)
+{
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// (a, b) <- (c a - s b, s a + c b)
+void rotate(double *a, double *b, int n, double c, double s)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        double x = a[i], y = b[i];
+        a[i] = c * x - s * y;
+        b[i] = s * x + c * y;
+    }
+}
+} // namespace
+
+SingularValueDecomposition singular_value_decomposition(const Matrix &matrix)
+{
+    // Jacobi rotations orthogonalize the columns of a tall A (A V = U diag(s));
+    // a wide matrix is decomposed through its transpose
+    bool transposed = matrix.getRows() < matrix.getCols();
+    int m = std::max(matrix.getRows(), matrix.getCols());
+    int n = std::min(matrix.getRows(), matrix.getCols());
+
+    // Column-major, so every rotation runs over contiguous columns
+    std::vector<double> a(static_cast<size_t>(m) * n), v(static_cast<size_t>(n) * n, 0.0);
+    for (int i = 0; i < matrix.getRows(); ++i)
+    {
+        for (int j = 0; j < matrix.getCols(); ++j)
+        {
+            if (transposed)
+                a[static_cast<size_t>(i) * m + j] = matrix(i, j);
+            else
+                a[static_cast<size_t>(j) * m + i] = matrix(i, j);
+        }
+    }
+    for (int j = 0; j < n; ++j)
+        v[static_cast<size_t>(j) * n + j] = 1.0;
+
+    for (int sweep = 0; sweep < kMaxSweeps; ++sweep)
+    {
+        bool rotated = false;
+        for (int p = 0; p + 1 < n; ++p)
+        {
+            for (int q = p + 1; q < n; ++q)
+            {
+                double *ap = &a[static_cast<size_t>(p) * m], *aq = &a[static_cast<size_t>(q) * m];
+                double alpha = dot(ap, ap, m), beta = dot(aq, aq, m), gamma = dot(ap, aq, m);
+                if (alpha == 0.0 || beta == 0.0 || std::fabs(gamma) <= kTolerance * std::sqrt(alpha * beta))
+                    continue;
+                // The rotation that zeroes the (p, q) entry of A^T A
+                double zeta = (beta - alpha) / (2.0 * gamma);
+                double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / std::sqrt(1.0 + t * t);
+                double s = c * t;
+                rotate(ap, aq, m, c, s);
+                rotate(&v[static_cast<size_t>(p) * n], &v[static_cast<size_t>(q) * n], n, c, s);
+                rotated = true;
+            }
+        }
+        if (!rotated)
+            break;
+    }
+
+    std::vector<double> norms(n);
+    for (int j = 0; j < n; ++j)
+        norms[j] = std::sqrt(dot(&a[static_cast<size_t>(j) * m], &a[static_cast<size_t>(j) * m], m));
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int x, int y)
+                     { return norms[x] > norms[y]; });
+
+    // A = U diag(s) V^T; for a transposed input, matrix = V diag(s) U^T
+    Matrix u(m, n), right(n, n);
+    SingularValueDecomposition svd{Matrix(0, 0), std::vector<double>(n), Matrix(0, 0)};
+    for (int k = 0; k < n; ++k)
+    {
+        int j = order[k];
+        double norm = norms[j];
+        svd.singular[k] = norm;
+        for (int i = 0; i < m; ++i)
+            u(i, k) = norm > 0.0 ? a[static_cast<size_t>(j) * m + i] / norm : 0.0;
+        for (int i = 0; i < n; ++i)
+            right(i, k) = v[static_cast<size_t>(j) * n + i];
+    }
+    svd.left = transposed ? std::move(right) : std::move(u);
+    svd.right = transposed ? std::move(u) : std::move(right);
+    return svd;
+}
+
+int rank_for_energy(const std::vector<double> &singular, double energy)
+{
+    if (energy <= 0.0 || energy > 1.0)
+    {
+        throw std::invalid_argument("Energy must be in (0, 1].");
+    }
+    double total = 0.0;
+    for (double s : singular)
+        total += s * s;
+    double kept = 0.0;
+    for (size_t r = 0; r < singular.size(); ++r)
+    {
+        kept += singular[r] * singular[r];
+        if (kept >= energy * total)
+            return static_cast<int>(r) + 1;
+    }
+    return std::max<int>(1, static_cast<int>(singular.size()));
+}
+
+double retained_energy(const std::vector<double> &singular, int rank)
+{
+    double total = 0.0, kept = 0.0;
+    for (size_t r = 0; r < singular.size(); ++r)
+    {
+        total += singular[r] * singular[r];
+        if (static_cast<int>(r) < rank)
+            kept += singular[r] * singular[r];
+    }
+    return total > 0.0 ? kept / total : 1.0;
+}
+
+bool factorization_saves_work(int inputs, int outputs, int rank)
+{
+    return static_cast<long long>(rank) * (inputs + outputs) < static_cast<long long>(inputs) * outputs;
+}
+
+std::vector<DenseLayer> factorize_layer(const DenseLayer &layer, int rank)
+{
+    return factorize_layer(layer, singular_value_decomposition(layer.getWeights()), rank);
+}
+
+std::vector<DenseLayer> factorize_layer(const DenseLayer &layer, const SingularValueDecomposition &svd, int rank)
+{
+    const Matrix &weights = layer.getWeights();
+    int inputs = weights.getRows();
+    int outputs = weights.getCols();
+    if (rank < 1 || rank > static_cast<int>(svd.singular.size()) || svd.left.getRows() != inputs ||
+        svd.right.getRows() != outputs)
+    {
+        throw std::invalid_argument("Rank " + std::to_string(rank) + " is out of range for a " +
+                                    std::to_string(inputs) + "x" + std::to_string(outputs) + " layer.");
+    }
+
+    Matrix first(inputs, rank), second(rank, outputs);
+    for (int k = 0; k < rank; ++k)
+    {
+        double root = std::sqrt(svd.singular[k]);
+        for (int i = 0; i < inputs; ++i)
+            first(i, k) = svd.left(i, k) * root;
+        for (int o = 0; o < outputs; ++o)
+            second(k, o) = root * svd.right(o, k);
+    }
+
+    // The bottleneck's biases start at zero, so the factors compute x W + b exactly
+    // up to truncation; fine-tuning may move them like any other parameter
+    std::vector<DenseLayer> factors;
+    factors.emplace_back(std::move(first), Matrix(1, rank), Activation::create("linear"), layer.getRegularizer());
+    factors.emplace_back(std::move(second), layer.getBiases(), Activation::create(layer.getActivation()->name()),
+                         layer.getRegularizer());
+    return factors;
+}
@@ -4,16 +4,19 @@
 DenseLayer::DenseLayer(int inputSize, int outputSize, std::shared_ptr<Activation> activation,
                        std::shared_ptr<Regularizer> regularizer,
                        WeightInitType init_type)
-    : m_weights(Matrix::random(inputSize, outputSize)),
-      m_biases(Matrix::random(1, outputSize)),
+    : m_weights(inputSize, outputSize),
+      m_biases(1, outputSize),
       m_activation(activation),
       m_input(0, 0), // Initialize m_input before m_regularizer
       m_regularizer(regularizer),
       m_d_weights(inputSize, outputSize),
-      m_d_biases(1, outputSize)
+      m_d_biases(1, outputSize),
+      m_precision(Precision::DOUBLE)
 {
     switch (init_type)
     {
+    case WeightInitType::ZERO:
+        return;
     case WeightInitType::HE:
         m_weights = Matrix::he(inputSize, outputSize);
         break;
@@ -22,16 +25,38 @@ DenseLayer::DenseLayer(int inputSize, int outputSize, std::shared_ptr<Activation
         m_weights = Matrix::random(inputSize, outputSize);
         break;
     }
+    m_biases = Matrix::random(1, outputSize);
 }
 
-Matrix DenseLayer::backward(const Matrix &d_output)
+DenseLayer::DenseLayer(Matrix weights, Matrix biases, std::shared_ptr<Activation> activation,
+                       std::shared_ptr<Regularizer> regularizer)
+    : m_weights(std::move(weights)),
+      m_biases(std::move(biases)),
+      m_activation(activation),
+      m_input(0, 0),
+      m_regularizer(regularizer),
+      m_d_weights(0, 0),
+      m_d_biases(1, m_biases.getCols()),
+      m_precision(Precision::DOUBLE)
+{
+    if (m_biases.getRows() != 1 || m_biases.getCols() != m_weights.getCols())
+    {
+        throw std::invalid_argument("Biases must be a 1 x outputSize matrix.");
+    }
+}
+
+Matrix DenseLayer::backward(const Matrix &d_output, bool input_gradient, bool regularize)
 {
     Matrix d_linear = m_activation->backward(d_output);
+    if (m_precision == Precision::BF16)
+    {
+        return backward_bf16(d_linear, input_gradient, regularize);
+    }
     m_d_weights = Matrix::multiply(m_input.transpose(), d_linear);
 
-    if (m_regularizer)
+    if (m_regularizer && regularize)
     {
-        m_d_weights = m_d_weights + m_regularizer->gradient(m_weights);
+        m_regularizer->add_gradient(m_weights, m_d_weights);
     }
     for (int j = 0; j < m_d_biases.getCols(); ++j)
     {
@@ -43,6 +68,10 @@ Matrix DenseLayer::backward(const Matrix &d_output)
         m_d_biases(0, j) = sum;
     }
 
+    if (!input_gradient)
+    {
+        return Matrix(0, 0);
+    }
     Matrix d_input = Matrix::multiply(d_linear, m_weights.transpose());
     return d_input;
 }
@@ -50,6 +79,20 @@ Matrix DenseLayer::backward(const Matrix &d_output)
 const Matrix &DenseLayer::getWeightsGradient() const { return m_d_weights; }
 const Matrix &DenseLayer::getBiasesGradient() const { return m_d_biases; }
 
+Matrix &DenseLayer::getWeightsGradient()
+{
+    if (m_d_weights.getRows() != m_weights.getRows() || m_d_weights.getCols() != m_weights.getCols())
+    {
+        m_d_weights = Matrix(m_weights.getRows(), m_weights.getCols());
+    }
+    return m_d_weights;
+}
+
+Matrix &DenseLayer::getBiasesGradient()
+{
+    return m_d_biases;
+}
+
 Matrix &DenseLayer::getWeights() { return m_weights; }
 Matrix &DenseLayer::getBiases() { return m_biases; }
 const Matrix &DenseLayer::getWeights() const { return m_weights; }
@@ -75,6 +118,10 @@ void DenseLayer::setBiases(const Matrix& biases) {
 
 Matrix DenseLayer::forward(const Matrix &inputData)
 {
+    if (m_precision == Precision::BF16)
+    {
+        return forward_bf16(inputData);
+    }
     m_input = inputData; // Store a copy of the input
 
     Matrix z = Matrix::multiply(inputData, m_weights);
@@ -87,4 +134,74 @@ Matrix DenseLayer::forward(const Matrix &inputData)
     }
 
     return m_activation->forward(z);
-}
\ No newline at end of file
+}
+
+void DenseLayer::setPrecision(Precision precision)
+{
+    m_precision = precision;
+    m_input = Matrix(0, 0);
+    m_bf16_input_t.clear();
+    m_bf16_operand.clear();
+    m_bf16_weights.clear();
+}
+
+Precision DenseLayer::getPrecision() const
+{
+    return m_precision;
+}
+
+Matrix DenseLayer::forward_bf16(const Matrix &inputData)
+{
+    // Only the transposed bf16 copy is kept for backward, a quarter of the double input
+    m_bf16_input_t.pack(inputData, true);
+    m_bf16_operand.pack(inputData);
+    m_bf16_weights.pack(m_weights, true);
+
+    Matrix z(inputData.getRows(), m_weights.getCols());
+    gemm_bf16_nt(m_bf16_operand, m_bf16_weights, z);
+    // The row-major copy is only this GEMM's operand; backward packs its own
+    m_bf16_operand.clear();
+    for (int i = 0; i < z.getRows(); ++i)
+    {
+        for (int j = 0; j < z.getCols(); ++j)
+        {
+            z(i, j) += m_biases(0, j);
+        }
+    }
+    return m_activation->forward(z);
+}
+
+Matrix DenseLayer::backward_bf16(const Matrix &d_linear, bool input_gradient, bool regularize)
+{
+    // dW = X^T dZ: rows of X^T against rows of dZ^T
+    m_bf16_operand.pack(d_linear, true);
+    getWeightsGradient(); // Sizes the buffer
+    gemm_bf16_nt(m_bf16_input_t, m_bf16_operand, m_d_weights);
+    if (m_regularizer && regularize)
+    {
+        m_regularizer->add_gradient(m_weights, m_d_weights);
+    }
+    // Bias gradients are plain sums, kept in double
+    for (int j = 0; j < m_d_biases.getCols(); ++j)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < d_linear.getRows(); ++i)
+        {
+            sum += d_linear(i, j);
+        }
+        m_d_biases(0, j) = sum;
+    }
+
+    if (!input_gradient)
+    {
+        m_bf16_operand.clear();
+        return Matrix(0, 0);
+    }
+    // dX = dZ W^T: rows of dZ against rows of W
+    m_bf16_operand.pack(d_linear);
+    m_bf16_weights.pack(m_weights);
+    Matrix d_input(d_linear.getRows(), m_weights.getRows());
+    gemm_bf16_nt(m_bf16_operand, m_bf16_weights, d_input);
+    m_bf16_operand.clear();
+    return d_input;
+}
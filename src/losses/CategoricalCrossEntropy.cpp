@@ -1,7 +1,9 @@
 #include "losses/CategoricalCrossEntropy.hpp"
-#include <cmath>
+#include "math/VectorMath.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <limits>
+#include <vector>
 
 double CategoricalCrossEntropy::calculate(const Matrix &y_pred, const Matrix &y_true)
 {
@@ -15,15 +17,19 @@ double CategoricalCrossEntropy::calculate(const Matrix &y_pred, const Matrix &y_
     double total_loss = 0.0;
     double epsilon = std::numeric_limits<double>::epsilon();
 
+    // Clip predictions to avoid log(0), then take a row's logs in one call
+    std::vector<double> logs(classes);
     for (int i = 0; i < samples; ++i)
     {
+        const double *pred = y_pred.data() + static_cast<size_t>(i) * classes;
         for (int j = 0; j < classes; ++j)
         {
-            // Clip predictions to avoid log(0)
-            double pred_clipped = std::max(epsilon, y_pred(i, j));
-            pred_clipped = std::min(1.0 - epsilon, pred_clipped);
-
-            total_loss += y_true(i, j) * std::log(pred_clipped);
+            logs[j] = std::min(1.0 - epsilon, std::max(epsilon, pred[j]));
+        }
+        vector_log(logs.data(), logs.data(), classes);
+        for (int j = 0; j < classes; ++j)
+        {
+            total_loss += y_true(i, j) * logs[j];
         }
     }
 
@@ -38,4 +44,23 @@ Matrix CategoricalCrossEntropy::backward(const Matrix &y_pred, const Matrix &y_t
     }
     // This is the combined, simplified gradient of CCE+Softmax
     return y_pred - y_true;
-}
\ No newline at end of file
+}
+
+void CategoricalCrossEntropy::backward_into(const Matrix &y_pred, const Matrix &y_true, Matrix &gradient)
+{
+    if (y_pred.getRows() != y_true.getRows() || y_pred.getCols() != y_true.getCols() ||
+        gradient.getRows() != y_pred.getRows() || gradient.getCols() != y_pred.getCols())
+    {
+        throw std::invalid_argument("Prediction, true value and gradient matrices must have the same dimensions.");
+    }
+
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        gradient.data()[i] = y_pred.data()[i] - y_true.data()[i];
+    }
+}
+
+bool CategoricalCrossEntropy::gradient_is_mean() const
+{
+    return false;
+}
@@ -0,0 +1,18 @@
+#include "losses/Loss.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void Loss::backward_into(const Matrix &y_pred, const Matrix &y_true, Matrix &gradient)
+{
+    Matrix result = backward(y_pred, y_true);
+    if (result.getRows() != gradient.getRows() || result.getCols() != gradient.getCols())
+    {
+        throw std::invalid_argument("Gradient buffer must have the same dimensions as the predictions.");
+    }
+    std::copy(result.data(), result.data() + result.size(), gradient.data());
+}
+
+bool Loss::gradient_is_mean() const
+{
+    return true;
+}
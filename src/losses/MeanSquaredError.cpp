@@ -32,4 +32,19 @@ Matrix MeanSquaredError::backward(const Matrix &y_pred, const Matrix &y_true)
     Matrix grad = y_pred - y_true;
     double normalizer = 2.0 / y_pred.getRows();
     return grad * normalizer;
-}
\ No newline at end of file
+}
+
+void MeanSquaredError::backward_into(const Matrix &y_pred, const Matrix &y_true, Matrix &gradient)
+{
+    if (y_pred.getRows() != y_true.getRows() || y_pred.getCols() != y_true.getCols() ||
+        gradient.getRows() != y_pred.getRows() || gradient.getCols() != y_pred.getCols())
+    {
+        throw std::invalid_argument("Prediction, true value and gradient matrices must have the same dimensions.");
+    }
+
+    double normalizer = 2.0 / y_pred.getRows();
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        gradient.data()[i] = (y_pred.data()[i] - y_true.data()[i]) * normalizer;
+    }
+}
@@ -6,7 +6,7 @@
 // Include all necessary headers for the actual implementations
 #include "Model.hpp"
 #include "layers/DenseLayer.hpp"
-#include "activations/ReLU.hpp"
+#include "activations/Activation.hpp"
 #include "activations/LinearActivation.hpp"
 #include "activations/Softmax.hpp"
 #include "losses/MeanSquaredError.hpp"
@@ -14,7 +14,32 @@
 #include "optimizers/Adam.hpp"
 #include "utils/DataHandler.hpp"
 #include "utils/Evaluation.hpp"
+#include "utils/AsyncValidator.hpp"
+#include "utils/Checkpoint.hpp"
+#include "utils/Random.hpp"
+#include "utils/StreamingDataset.hpp"
+#include "utils/StreamingPredictor.hpp"
+#include "serving/InferenceServer.hpp"
+#include "serving/PredictionCache.hpp"
+#include "quantization/QuantizedModel.hpp"
+#include "pruning/Pruning.hpp"
+#include "pruning/SparseModel.hpp"
+#include "factorization/LowRank.hpp"
+#include "codegen/CodeGenerator.hpp"
+#include "precision/LossScaling.hpp"
+#include <csignal>
+#include "training/DataParallelTrainer.hpp"
+#include "training/HogwildTrainer.hpp"
+#include "training/MultiProcessTrainer.hpp"
+#include "training/PipelineExecutor.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <memory>
 #include <limits>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 
 // A struct to hold our configuration
@@ -24,9 +49,48 @@ struct Config
     std::string dataset_path;
     std::string load_model_path;
     std::string save_model_path;
+    std::string export_model_path; // Serving model with preprocessing folded in
+    std::string convert_model_path; // Model to rewrite in the format chosen by --save
+    std::vector<int> hidden_layers; // Hidden layer sizes; empty uses the task default
+    std::string hidden_activation = "relu"; // Activation of new models' hidden layers
     int epochs = 100; // Default value
     bool train = false;
     bool predict = false;
+    bool mmap_model = false; // Serve weights straight from a shared mapping of a binary model
+    std::string checkpoint_path;
+    int checkpoint_every = 0; // Epochs between background checkpoints; 0 disables them
+    bool has_seed = false;
+    unsigned int seed = 0;
+    int workers = 1; // Data-parallel training threads; 1 keeps the single-threaded loop
+    bool hogwild = false; // Lock-free asynchronous mini-batch training on `workers` threads
+    int batch_size = 64;  // Mini-batch size for --hogwild and --stream
+    int processes = 1;    // Training processes exchanging gradients through shared memory
+    int pipeline_stages = 0; // Pipeline-parallel stages; 0 runs the layers one after another
+    int micro_batches = 4;   // Micro-batches per batch for --pipeline
+    int recompute_every = 0; // Keep every n-th layer's output in training, recomputing the rest; 0 keeps all
+    bool stream = false;          // Stream the training file in mini-batches instead of loading it
+    size_t shuffle_buffer = 4096; // Rows shuffled together while streaming; 0 keeps file order
+    std::string convert_dataset_path; // CSV dataset to rewrite in the binary format at --save
+    std::string output_path; // Prediction output file (CSV, or binary dataset for .bin); empty prints only
+    int chunk_size = 4096;   // Rows per streamed chunk in prediction mode
+    std::string serve_path;      // Unix socket to serve predictions on; empty runs batch prediction
+    int max_batch = 64;          // Requests answered by one forward pass in --serve mode
+    double max_latency_ms = 2.0; // Longest a request waits for others to batch with
+    int cache_mb = 0;            // Prediction cache size in prediction mode; 0 disables it
+    std::string quantize_model_path; // Model to quantize to int8 and save at --save
+    int calibration_rows = 1000;     // Rows of training data the int8 ranges are calibrated on
+    std::string prune_model_path;    // Model to prune and save as a sparse model at --save
+    std::vector<double> sparsity_levels = {0.5, 0.8, 0.95}; // Increasing fractions of weights pruned
+    double prune_threshold = 0.0;    // Prune |w| below this instead of by sparsity levels; 0 disables it
+    SparseFormat sparse_format = SparseFormat::CSR; // BSR also prunes whole blocks
+    int fine_tune_epochs = 10;       // Training epochs after each pruning step or factorization
+    std::string factorize_model_path; // Model to factorize by truncated SVD and save at --save
+    std::vector<int> ranks = {64, 32, 16, 8}; // Ranks --factorize tries, each from the original model
+    std::vector<double> energies;    // Energy thresholds to pick each layer's rank by, in place of ranks
+    std::string generate_model_path; // Model to compile into a standalone C++ header at --save
+    Precision precision = Precision::DOUBLE; // Arithmetic of the training passes
+    double loss_scale = 0.0;                 // Initial dynamic loss scale; 0 disables loss scaling
+    std::string benchmark;
 };
 
 // Helper to separate last column as target (for Boston dataset)
@@ -44,9 +108,417 @@ static std::pair<Matrix, Matrix> separate_features_target(const Matrix& data) {
     return {features, target};
 }
 
+// Writes a serving copy of a trained model with its input preprocessing folded
+// into the first layer. Consumes the model: it expects raw features afterwards.
+template <typename FoldFn>
+static void export_serving_model(Model &model, const std::string &path, FoldFn fold)
+{
+    if (path.empty())
+        return;
+    std::cout << "Exporting serving model to: " << path << std::endl;
+    try {
+        fold(model);
+        model.save(path);
+        std::cout << "Model exported successfully!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error exporting model: " << e.what() << std::endl;
+    }
+}
+
+// Default network architectures of the two tasks, with optional custom hidden layers
+static Model build_boston_model(int input_size, std::vector<int> hidden = {}, const std::string &activation = "relu")
+{
+    if (hidden.empty())
+        hidden = {64, 64};
+    Model model;
+    int inputs = input_size;
+    for (int units : hidden)
+    {
+        model.add(DenseLayer(inputs, units, Activation::create(activation)));
+        inputs = units;
+    }
+    model.add(DenseLayer(inputs, 1, std::make_shared<LinearActivation>())); // Output layer: 1 neuron, linear activation
+    return model;
+}
+
+static Model build_mnist_model(std::vector<int> hidden = {}, const std::string &activation = "relu")
+{
+    if (hidden.empty())
+        hidden = {128};
+    Model model;
+    int inputs = 784;
+    for (int units : hidden)
+    {
+        model.add(DenseLayer(inputs, units, Activation::create(activation)));
+        inputs = units;
+    }
+    model.add(DenseLayer(inputs, 10, std::make_shared<Softmax>()));
+    return model;
+}
+
+// Loads a model file with the architecture it records. Legacy files without
+// one are loaded into the architecture given by build_default.
+static Model load_model_file(const std::string &path, const std::function<Model()> &build_default)
+{
+    if (!Model::read_architecture(path).empty())
+    {
+        return Model::from_file(path);
+    }
+    Model model = build_default();
+    model.load(path);
+    return model;
+}
+
+// Background checkpoint writer for --checkpoint-every, or nullptr when disabled
+static std::unique_ptr<Checkpointer> make_checkpointer(const Config &config)
+{
+    if (config.checkpoint_every <= 0)
+        return nullptr;
+    std::cout << "Checkpointing every " << config.checkpoint_every << " epochs to: " << config.checkpoint_path << std::endl;
+    return std::unique_ptr<Checkpointer>(new Checkpointer(config.checkpoint_path, config.checkpoint_every));
+}
+
+// Hands a copy of the full training state to the checkpoint writer when one is due
+static void checkpoint_if_due(Checkpointer *checkpointer, int epoch, const Model &model, const Optimizer &optimizer)
+{
+    if (checkpointer && checkpointer->due(epoch))
+    {
+        TrainingState state;
+        state.epoch = epoch;
+        state.optimizer = optimizer.getState();
+        state.rng_state = save_rng_state();
+        checkpointer->submit(model.snapshot(), std::move(state));
+    }
+}
+
+// When the loaded model file is a checkpoint, restores the optimizer and RNG
+// state saved with it and returns the epoch to resume at (0 otherwise).
+static int resume_training_state(const Config &config, bool model_loaded, Optimizer &optimizer)
+{
+    TrainingState state;
+    if (!model_loaded || Model::is_binary_file(config.load_model_path) ||
+        !Checkpointer::read_state(config.load_model_path, state))
+    {
+        return 0;
+    }
+    try {
+        optimizer.setState(state.optimizer);
+        restore_rng_state(state.rng_state);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Could not restore training state: " << e.what() << std::endl;
+        return 0;
+    }
+    std::cout << "Resuming from checkpoint after epoch " << state.epoch << std::endl;
+    return state.epoch + 1;
+}
+
+// The parallel training strategy chosen on the command line. With none set,
+// training runs the plain single-threaded full-batch loop.
+struct Trainers
+{
+    std::unique_ptr<SharedMemoryGroup> group; // --processes
+    std::unique_ptr<MultiProcessTrainer> multi_process;
+    std::unique_ptr<DataParallelTrainer> data_parallel; // --workers
+    std::unique_ptr<HogwildTrainer> hogwild;            // --hogwild
+    std::unique_ptr<PipelineExecutor> pipeline;         // --pipeline
+    std::unique_ptr<ExecutionPlan> plan;                // The single-threaded loop, compiled on first use
+    int recompute_every = 0;                            // --recompute, for the plan
+
+    // Only rank 0 of a multi-process run logs, checkpoints and saves
+    bool is_rank0() const { return !group || group->rank() == 0; }
+};
+
+// Sets up the trainer for --processes, --hogwild or --workers. With --processes
+// this forks, so it must run before any background thread is started.
+static Trainers make_trainers(const Config &config, Model &model, Loss &loss_fn, double learning_rate)
+{
+    if (model.isMapped())
+    {
+        // The optimizer writes the weights, and a mapping's pages are read-only
+        throw std::runtime_error("Cannot train a read-only memory-mapped model.");
+    }
+    Trainers trainers;
+    if (config.processes > 1)
+    {
+        std::cout << "Training in " << config.processes << " processes over shared memory" << std::endl;
+        trainers.group = SharedMemoryGroup::launch(config.processes, MultiProcessTrainer::buffer_size(model));
+        if (!trainers.is_rank0())
+        {
+            std::cout.rdbuf(nullptr); // Silences the replica's log output
+        }
+        trainers.multi_process.reset(new MultiProcessTrainer(model, loss_fn, *trainers.group));
+    }
+    else if (config.hogwild)
+    {
+        // Each thread gets its own Adam
+        trainers.hogwild.reset(new HogwildTrainer(
+            model, loss_fn, [learning_rate](std::vector<DenseLayer> &layers)
+            { return std::unique_ptr<Optimizer>(new Adam(layers, learning_rate)); },
+            config.workers, config.batch_size));
+        std::cout << "Hogwild training on " << trainers.hogwild->getThreads() << " threads, batch size "
+                  << trainers.hogwild->getBatchSize() << std::endl;
+    }
+    else if (config.pipeline_stages > 0)
+    {
+        trainers.pipeline.reset(new PipelineExecutor(model, config.pipeline_stages, config.micro_batches));
+        std::cout << "Pipeline-parallel training in " << trainers.pipeline->getStages() << " stages, "
+                  << config.micro_batches << " micro-batches" << std::endl;
+    }
+    else if (config.workers != 1)
+    {
+        trainers.data_parallel.reset(new DataParallelTrainer(model, loss_fn, config.workers));
+        std::cout << "Data-parallel training on " << trainers.data_parallel->getWorkers() << " workers" << std::endl;
+    }
+    else if (config.recompute_every > 1)
+    {
+        trainers.recompute_every = config.recompute_every;
+        std::cout << "Activation recomputation: keeping one layer output in " << config.recompute_every
+                  << ", recomputing the others in backward" << std::endl;
+    }
+    return trainers;
+}
+
+// --precision and --loss-scale: the layers' arithmetic, plus the loss and
+// optimizer wrappers that apply loss scaling when it is on
+struct MixedPrecision
+{
+    std::unique_ptr<LossScaler> scaler;
+    std::unique_ptr<ScaledLoss> loss;
+    std::unique_ptr<ScaledOptimizer> optimizer;
+
+    Loss &training_loss(Loss &loss_fn) { return loss ? *loss : loss_fn; }
+    Optimizer &training_optimizer(Optimizer &base) { return optimizer ? *optimizer : base; }
+};
+
+// Must run before make_trainers, whose replicas copy the layers' precision
+static MixedPrecision setup_precision(const Config &config, Model &model, Loss &loss_fn, Optimizer &optimizer)
+{
+    MixedPrecision precision;
+    if (config.precision == Precision::BF16)
+    {
+        model.setPrecision(Precision::BF16);
+        std::cout << "Mixed-precision training: bfloat16 operands, float32 accumulation, double master weights ("
+                  << bf16_kernel_name() << " kernel)" << std::endl;
+    }
+    if (config.loss_scale > 0.0)
+    {
+        precision.scaler.reset(new LossScaler(config.loss_scale));
+        precision.loss.reset(new ScaledLoss(loss_fn, *precision.scaler));
+        precision.optimizer.reset(new ScaledOptimizer(model.getLayers(), optimizer, *precision.scaler));
+        std::cout << "Dynamic loss scaling from " << config.loss_scale << std::endl;
+    }
+    return precision;
+}
+
+// Evaluation and saving after training run in double again
+static void finish_precision(const MixedPrecision &precision, Model &model)
+{
+    model.setPrecision(Precision::DOUBLE);
+    if (precision.scaler)
+    {
+        std::cout << "Final loss scale: " << precision.scaler->getScale() << ", steps skipped on overflow: "
+                  << precision.scaler->getSkippedSteps() << std::endl;
+    }
+}
+
+// One training epoch: a Hogwild pass over mini-batches, or a full-batch step
+// (sharded across the worker threads or processes when there are any)
+static void train_epoch(Trainers &trainers, Model &model, Loss &loss_fn, Optimizer &optimizer,
+                        const Matrix &X, const Matrix &y)
+{
+    if (trainers.multi_process)
+    {
+        trainers.multi_process->step(X, y, optimizer);
+        return;
+    }
+    if (trainers.hogwild)
+    {
+        trainers.hogwild->epoch(X, y);
+        return;
+    }
+    if (trainers.data_parallel)
+    {
+        trainers.data_parallel->step(X, y, optimizer);
+        return;
+    }
+    if (trainers.pipeline)
+    {
+        trainers.pipeline->forward_backward(X, y, loss_fn);
+        optimizer.step();
+        return;
+    }
+    if (model.getLayers().front().getPrecision() == Precision::DOUBLE)
+    {
+        // The same arithmetic as below, without allocating every step
+        if (!trainers.plan || !trainers.plan->matches(model.getLayers(), X.getRows()))
+        {
+            trainers.plan.reset(new ExecutionPlan(model.compile(X.getRows(), true, trainers.recompute_every)));
+        }
+        loss_fn.backward_into(trainers.plan->forward(X), y, trainers.plan->output_gradient());
+        trainers.plan->backward();
+        optimizer.step();
+        return;
+    }
+    Matrix y_pred = model.predict(X);
+    Matrix grad = loss_fn.backward(y_pred, y);
+    model.backward(grad);
+    optimizer.step();
+}
+
+// Prediction over a whole dataset, pipelined across --pipeline stages when requested.
+// With a cache, rows seen before skip the forward pass.
+static Matrix run_inference(const Config &config, Model &model, const Matrix &X, PredictionCache *cache = nullptr)
+{
+    auto forward = [&](const Matrix &input)
+    {
+        if (config.pipeline_stages > 0)
+        {
+            PipelineExecutor pipeline(model, config.pipeline_stages, config.micro_batches);
+            return pipeline.predict(input);
+        }
+        return model.predict(input);
+    };
+    return cache ? cache->predict(X, forward) : forward(X);
+}
+
+// An int8 (--quantize) or sparse (--prune) model: inference only, with the
+// preprocessing folded in, so it takes raw features
+struct RawFeatureModel
+{
+    std::function<Matrix(const Matrix &)> predict;
+    int input_size;
+    uint64_t fingerprint;
+};
+
+// Loads the model at path if it is an int8 or sparse model; null for any other file
+static std::unique_ptr<RawFeatureModel> load_raw_feature_model(const std::string &path)
+{
+    std::unique_ptr<RawFeatureModel> raw;
+    if (QuantizedModel::is_quantized_file(path))
+    {
+        auto model = std::make_shared<QuantizedModel>(QuantizedModel::from_file(path));
+        std::string kernel = QuantizedModel::kernel_name();
+        std::cout << "Int8 model, " << kernel << " kernel" << std::endl;
+        raw.reset(new RawFeatureModel{[model](const Matrix &X)
+                                      { return model->predict(X); },
+                                      model->getInputSize(), model->fingerprint()});
+    }
+    else if (SparseModel::is_sparse_file(path))
+    {
+        auto model = std::make_shared<SparseModel>(SparseModel::from_file(path));
+        std::cout << "Sparse model, " << 100.0 * model->density() << "% of weights stored" << std::endl;
+        raw.reset(new RawFeatureModel{[model](const Matrix &X)
+                                      { return model->predict(X); },
+                                      model->getInputSize(), model->fingerprint()});
+    }
+    return raw;
+}
+
+static Matrix run_inference(const RawFeatureModel &model, const Matrix &X, PredictionCache *cache = nullptr)
+{
+    return cache ? cache->predict(X, model.predict) : model.predict(X);
+}
+
+static int model_input_size(Model &model)
+{
+    return model.getLayers().front().getWeights().getRows();
+}
+
+// Applies preprocessing given as an affine (shift, scale) pair: x' = (x - shift) * scale
+static void apply_input_transform(Matrix &X, const std::pair<Matrix, Matrix> &transform)
+{
+    for (int i = 0; i < X.getRows(); ++i)
+    {
+        for (int j = 0; j < X.getCols(); ++j)
+        {
+            X(i, j) = (X(i, j) - transform.first(0, j)) * transform.second(0, j);
+        }
+    }
+}
+
+// --cache-mb: an LRU cache of predictions, keyed to the model's fingerprint
+static std::unique_ptr<PredictionCache> make_prediction_cache(const Config &config, uint64_t model_fingerprint)
+{
+    if (config.cache_mb <= 0)
+        return nullptr;
+    return std::unique_ptr<PredictionCache>(
+        new PredictionCache(static_cast<size_t>(config.cache_mb) << 20, model_fingerprint));
+}
+
+// Class probabilities with the predicted class (argmax) prepended as column 0
+static Matrix with_predicted_class(const Matrix &probabilities)
+{
+    Matrix output(probabilities.getRows(), probabilities.getCols() + 1);
+    for (int i = 0; i < probabilities.getRows(); ++i)
+    {
+        int predicted_class = 0;
+        for (int j = 0; j < probabilities.getCols(); ++j)
+        {
+            output(i, j + 1) = probabilities(i, j);
+            if (probabilities(i, j) > probabilities(i, predicted_class))
+                predicted_class = j;
+        }
+        output(i, 0) = predicted_class;
+    }
+    return output;
+}
+
+static void print_prediction_stats(const Config &config, const PredictionStats &stats, const PredictionCache *cache)
+{
+    std::cout << "Predicted " << stats.rows << " rows in " << stats.seconds << " s ("
+              << static_cast<long long>(stats.rows_per_second) << " rows/sec)" << std::endl;
+    if (cache)
+        std::cout << "Prediction cache: " << cache->stats() << std::endl;
+    if (!config.output_path.empty())
+        std::cout << "Predictions written to: " << config.output_path << std::endl;
+}
+
+static InferenceServer *g_server = nullptr;
+
+static void stop_server(int)
+{
+    if (g_server)
+        g_server->stop();
+}
+
+// --serve: answers requests over a Unix socket until SIGINT or SIGTERM. A
+// server that fails (e.g. cannot listen) throws, so the run exits non-zero.
+static void run_server(const Config &config, int input_size, const ChunkInference &infer, const PredictionCache *cache)
+{
+    InferenceServer server(infer, input_size, config.max_batch, config.max_latency_ms);
+    if (cache)
+        server.add_stats_source([cache]()
+                                { return cache->stats(); });
+    g_server = &server;
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    std::cout << "Serving on " << config.serve_path << " (" << input_size << " features per request, batches of up to "
+              << config.max_batch << ", max latency " << config.max_latency_ms << " ms)" << std::endl;
+    auto restore_signals = []()
+    {
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        g_server = nullptr;
+    };
+    try {
+        server.serve(config.serve_path);
+    } catch (const std::exception& e) {
+        restore_signals();
+        throw std::runtime_error(std::string("serving failed: ") + e.what());
+    }
+    restore_signals();
+    std::cout << "\nServer stopped. " << server.stats() << std::endl;
+}
+
 // Forward declarations for the specific task implementations
 void run_boston_task(const Config &config);
 void run_mnist_task(const Config &config);
+void run_convert_task(const Config &config);
+void run_convert_dataset_task(const Config &config);
+void run_quantize_task(const Config &config);
+void run_prune_task(const Config &config);
+void run_factorize_task(const Config &config);
+void run_generate_task(const Config &config);
 
 // This function dispatches to the appropriate task based on configuration
 void run_task(const Config &config)
@@ -62,9 +534,44 @@ void run_task(const Config &config)
         std::cout << "Load Model Path: " << config.load_model_path << std::endl;
     if (!config.save_model_path.empty())
         std::cout << "Save Model Path: " << config.save_model_path << std::endl;
+    if (!config.export_model_path.empty())
+        std::cout << "Export Model Path: " << config.export_model_path << std::endl;
+    if (!config.hidden_layers.empty())
+    {
+        std::cout << "Hidden Layers:";
+        for (int units : config.hidden_layers)
+            std::cout << " " << units;
+        std::cout << std::endl;
+    }
+    if (config.hidden_activation != "relu")
+        std::cout << "Hidden Activation: " << config.hidden_activation << std::endl;
 
     // Dispatch to the appropriate task
-    if (config.task_mode == "boston")
+    if (!config.convert_model_path.empty())
+    {
+        run_convert_task(config);
+    }
+    else if (!config.convert_dataset_path.empty())
+    {
+        run_convert_dataset_task(config);
+    }
+    else if (!config.quantize_model_path.empty())
+    {
+        run_quantize_task(config);
+    }
+    else if (!config.prune_model_path.empty())
+    {
+        run_prune_task(config);
+    }
+    else if (!config.factorize_model_path.empty())
+    {
+        run_factorize_task(config);
+    }
+    else if (!config.generate_model_path.empty())
+    {
+        run_generate_task(config);
+    }
+    else if (config.task_mode == "boston")
     {
         run_boston_task(config);
     }
@@ -102,23 +609,19 @@ void run_boston_task(const Config &config)
         Matrix X_val = X_all.slice(train_size, X_all.getRows());
         Matrix y_val = y_all.slice(train_size, y_all.getRows());
 
-        // Scale features
-        StandardScaler scaler;
-        X_train = scaler.fit_transform(X_train);
-        X_val = scaler.transform(X_val);
-
         // --- 2. Define Regression Model ---
-        Model model;
-        model.add(DenseLayer(X_train.getCols(), 64, std::make_shared<ReLU>()));
-        model.add(DenseLayer(64, 64, std::make_shared<ReLU>()));
-        model.add(DenseLayer(64, 1, std::make_shared<LinearActivation>())); // Output layer: 1 neuron, linear activation
+        auto build_model = [&]()
+        { return build_boston_model(X_train.getCols(), config.hidden_layers, config.hidden_activation); };
+        Model model = build_model();
+        bool model_loaded = false;
 
         // Load existing model if specified
         if (!config.load_model_path.empty())
         {
             std::cout << "Loading existing model from: " << config.load_model_path << std::endl;
             try {
-                model.load(config.load_model_path);
+                model = load_model_file(config.load_model_path, build_model);
+                model_loaded = true;
                 std::cout << "Model loaded successfully!" << std::endl;
             } catch (const std::exception& e) {
                 std::cerr << "Warning: Could not load model: " << e.what() << std::endl;
@@ -126,23 +629,62 @@ void run_boston_task(const Config &config)
             }
         }
 
+        // Scale features, keeping the statistics a loaded model was trained with
+        StandardScaler scaler;
+        if (model.hasScaler())
+            scaler = model.getScaler();
+        else
+            scaler.fit(X_train);
+        scaler.transform_inplace(X_train);
+        scaler.transform_inplace(X_val);
+        if (model.hasFoldedInput())
+        {
+            // Exported model: take its folded scaling back out, exactly, so it trains on scaled features
+            model.unfold_scaler(scaler);
+        }
+        model.setScaler(scaler);
+
         // --- 3. Train the Model ---
         MeanSquaredError loss_fn;
-        Adam optimizer(model.getLayers(), 0.01);
+        const double learning_rate = 0.01;
+        Adam optimizer(model.getLayers(), learning_rate);
+        int start_epoch = resume_training_state(config, model_loaded, optimizer);
+        MixedPrecision precision = setup_precision(config, model, loss_fn, optimizer);
+        Loss &train_loss = precision.training_loss(loss_fn);
+        Optimizer &train_optimizer = precision.training_optimizer(optimizer);
+        Trainers trainers = make_trainers(config, model, train_loss, learning_rate);
+        std::unique_ptr<Checkpointer> checkpointer;
+        if (trainers.is_rank0())
+            checkpointer = make_checkpointer(config);
+
+        // Validation runs on parameter snapshots in the background while training continues
+        AsyncValidator validator(X_val, y_val, std::make_shared<MeanSquaredError>(), Matrix(0, 0));
+        ValidationResult result;
+        auto report_validation = [&]() {
+            while (validator.poll(result)) {
+                std::cout << "Epoch: " << result.epoch << ", Validation MSE: " << result.loss << std::endl;
+            }
+        };
 
         std::cout << "\nStarting Training for " << config.epochs << " epochs..." << std::endl;
-        for (int epoch = 0; epoch <= config.epochs; ++epoch) {
-            Matrix y_pred = model.predict(X_train);
-            Matrix grad = loss_fn.backward(y_pred, y_train);
-            model.backward(grad);
-            optimizer.step();
-
-            if (epoch % 10 == 0) {
-                Matrix val_pred = model.predict(X_val);
-                double val_loss = loss_fn.calculate(val_pred, y_val);
-                std::cout << "Epoch: " << epoch << ", Validation MSE: " << val_loss << std::endl;
+        for (int epoch = start_epoch; epoch <= config.epochs; ++epoch) {
+            train_epoch(trainers, model, train_loss, train_optimizer, X_train, y_train);
+            checkpoint_if_due(checkpointer.get(), epoch, model, optimizer);
+
+            // A snapshot still holding a result is freed by taking the result
+            while (epoch % 10 == 0 && !validator.submit(epoch, model)) {
+                report_validation();
             }
+            report_validation();
+        }
+        while (validator.wait(result)) {
+            std::cout << "Epoch: " << result.epoch << ", Validation MSE: " << result.loss << std::endl;
+        }
+        if (trainers.group)
+        {
+            trainers.group->finish(); // Only rank 0 continues
         }
+        finish_precision(precision, model);
 
         std::cout << "\nTraining Complete." << std::endl;
         Matrix final_preds = model.predict(X_val);
@@ -164,51 +706,95 @@ void run_boston_task(const Config &config)
         for(int i=0; i<10 && i<final_preds.getRows(); ++i) {
             std::cout << "Pred: " << final_preds(i,0) << ", True: " << y_val(i,0) << std::endl;
         }
+
+        export_serving_model(model, config.export_model_path, [&](Model &m)
+                             { m.fold_scaler(scaler); });
     }
     else if (config.predict)
     {
         std::cout << "=== PREDICTION MODE ===" << std::endl;
-        
-        // Load data for prediction
-        auto raw_data_with_labels = read_csv_boston(dataset_path);
-        auto separated_data = separate_features_target(raw_data_with_labels);
-        Matrix X_all = separated_data.first;
-        Matrix y_all = separated_data.second; // For comparison if available
-
-        // Scale features (Note: In production, you'd want to save/load scaler parameters)
-        StandardScaler scaler;
-        Matrix X_scaled = scaler.fit_transform(X_all);
 
         // --- Create and Load Model ---
         Model model;
-        model.add(DenseLayer(X_scaled.getCols(), 64, std::make_shared<ReLU>()));
-        model.add(DenseLayer(64, 64, std::make_shared<ReLU>()));
-        model.add(DenseLayer(64, 1, std::make_shared<LinearActivation>()));
-
+        std::unique_ptr<RawFeatureModel> raw; // Set for an int8 or sparse model
         std::cout << "Loading model from: " << config.load_model_path << std::endl;
         try {
-            model.load(config.load_model_path);
+            raw = load_raw_feature_model(config.load_model_path);
+            if (!raw)
+                model = config.mmap_model ? Model::map_file(config.load_model_path)
+                                          : load_model_file(config.load_model_path, [&]()
+                                                            { return build_boston_model(StreamingDataset::column_count(dataset_path) - 1,
+                                                                                        config.hidden_layers, config.hidden_activation); });
             std::cout << "Model loaded successfully!" << std::endl;
         } catch (const std::exception& e) {
             std::cerr << "Error loading model: " << e.what() << std::endl;
             return;
         }
 
+        // Exported, int8 and sparse models carry the training-time scaling in their first layer;
+        // otherwise use the scaler saved with the model, re-fitting only for legacy files
+        StandardScaler scaler;
+        bool scale_input = !raw && !model.hasFoldedInput();
+        if (scale_input && model.hasScaler())
+        {
+            scaler = model.getScaler();
+        }
+        else if (scale_input)
+        {
+            std::cout << "Model has no stored scaler, fitting one on the prediction data." << std::endl;
+            StreamingDataset fit_input(dataset_path, LabelColumn::LAST, config.chunk_size);
+            DataBatch batch;
+            while (fit_input.next(batch))
+            {
+                scaler.partial_fit(batch.features);
+            }
+        }
+        std::unique_ptr<PredictionCache> cache =
+            make_prediction_cache(config, raw ? raw->fingerprint : model.fingerprint());
+        auto infer = [&](Matrix &features)
+        {
+            if (raw)
+                return run_inference(*raw, features, cache.get());
+            if (scale_input)
+                scaler.transform_inplace(features);
+            return run_inference(config, model, features, cache.get());
+        };
+
+        if (!config.serve_path.empty())
+        {
+            run_server(config, raw ? raw->input_size : model_input_size(model), infer, cache.get());
+            return;
+        }
+
         // --- Make Predictions ---
-        Matrix predictions = model.predict(X_scaled);
-        
+        // Rows are streamed in chunks, so the input file can be of any size
+        std::cout << "Streaming predictions from: " << dataset_path << std::endl;
+        StreamingDataset input(dataset_path, LabelColumn::LAST, config.chunk_size);
         std::cout << "\nPredictions:" << std::endl;
-        for(int i = 0; i < std::min(20, predictions.getRows()); ++i) {
-            std::cout << "Sample " << i+1 << " - Predicted: " << predictions(i,0);
-            if (i < y_all.getRows()) {
-                std::cout << ", Actual: " << y_all(i,0);
-            }
-            std::cout << std::endl;
+        double squared_error = 0.0;
+        PredictionStats stats = stream_predictions(
+            input, config.output_path, {"prediction"}, infer,
+            [&](const Matrix &predictions, const Matrix &actual, long long first_row)
+            {
+                for (int i = 0; i < predictions.getRows(); ++i)
+                {
+                    double error = predictions(i, 0) - actual(i, 0);
+                    squared_error += error * error;
+                    if (first_row + i < 20)
+                    {
+                        std::cout << "Sample " << first_row + i + 1 << " - Predicted: " << predictions(i, 0)
+                                  << ", Actual: " << actual(i, 0) << std::endl;
+                    }
+                }
+            });
+
+        if (stats.rows > 20) {
+            std::cout << "... and " << (stats.rows - 20) << " more predictions." << std::endl;
         }
-        
-        if (predictions.getRows() > 20) {
-            std::cout << "... and " << (predictions.getRows() - 20) << " more predictions." << std::endl;
+        if (stats.rows > 0) {
+            std::cout << "\nOverall MSE: " << squared_error / stats.rows << std::endl;
         }
+        print_prediction_stats(config, stats, cache.get());
     }
 }
 
@@ -225,30 +811,58 @@ void run_mnist_task(const Config &config)
         std::cout << "=== TRAINING MODE ===" << std::endl;
         
         // --- 1. Load and Preprocess Data ---
-        std::cout << "Loading and preprocessing data..." << std::endl;
-        auto all_data = read_csv_mnist(train_dataset_path);
         int train_size = 5000;
         int val_size = 1000;
-        Matrix X_train = all_data.first.slice(0, train_size);
-        Matrix y_train_raw = all_data.second.slice(0, train_size);
-        Matrix X_val = all_data.first.slice(train_size, train_size + val_size);
-        Matrix y_val_raw = all_data.second.slice(train_size, train_size + val_size);
-        normalize_features(X_train);
+        Matrix X_train(0, 0), y_train(0, 0), X_val(0, 0), y_val_raw(0, 0);
+        int num_features;
+        if (config.stream)
+        {
+            // Out-of-core: the first val_size rows are held out for validation and
+            // the rest of the file is streamed in mini-batches every epoch
+            std::cout << "Streaming training data from: " << train_dataset_path << std::endl;
+            StreamingDataset held_out(train_dataset_path, LabelColumn::FIRST, val_size);
+            DataBatch val_batch;
+            if (!held_out.next(val_batch))
+            {
+                throw std::runtime_error("Dataset has no rows: " + train_dataset_path);
+            }
+            X_val = std::move(val_batch.features);
+            y_val_raw = std::move(val_batch.labels);
+            num_features = held_out.getFeatureCount();
+        }
+        else
+        {
+            std::cout << "Loading and preprocessing data..." << std::endl;
+            auto all_data = read_csv_mnist(train_dataset_path);
+            X_train = all_data.first.slice(0, train_size);
+            Matrix y_train_raw = all_data.second.slice(0, train_size);
+            X_val = all_data.first.slice(train_size, train_size + val_size);
+            y_val_raw = all_data.second.slice(train_size, train_size + val_size);
+            normalize_features(X_train);
+            y_train = one_hot_encode(y_train_raw, 10);
+            num_features = X_train.getCols();
+        }
         normalize_features(X_val);
-        Matrix y_train = one_hot_encode(y_train_raw, 10);
         Matrix y_val = one_hot_encode(y_val_raw, 10);
 
         // --- 2. Define Model and Training Parameters ---
-        Model model;
-        model.add(DenseLayer(784, 128, std::make_shared<ReLU>()));
-        model.add(DenseLayer(128, 10, std::make_shared<Softmax>()));
+        auto build_model = [&]()
+        { return build_mnist_model(config.hidden_layers, config.hidden_activation); };
+        Model model = build_model();
+        bool model_loaded = false;
         
         // Load existing model if specified
         if (!config.load_model_path.empty())
         {
             std::cout << "Loading existing model from: " << config.load_model_path << std::endl;
             try {
-                model.load(config.load_model_path);
+                model = load_model_file(config.load_model_path, build_model);
+                model_loaded = true;
+                if (model.hasFoldedInput())
+                {
+                    auto normalization = normalization_transform(num_features);
+                    model.unfold_input_transform(normalization.first, normalization.second);
+                }
                 std::cout << "Model loaded successfully!" << std::endl;
             } catch (const std::exception& e) {
                 std::cerr << "Warning: Could not load model: " << e.what() << std::endl;
@@ -257,48 +871,55 @@ void run_mnist_task(const Config &config)
         }
         
         CategoricalCrossEntropy loss_fn;
-        Adam optimizer(model.getLayers(), 0.002);
+        const double learning_rate = 0.002;
+        Adam optimizer(model.getLayers(), learning_rate);
+        int start_epoch = resume_training_state(config, model_loaded, optimizer);
+        MixedPrecision precision = setup_precision(config, model, loss_fn, optimizer);
+        Loss &train_loss = precision.training_loss(loss_fn);
+        Optimizer &train_optimizer = precision.training_optimizer(optimizer);
+        Trainers trainers = make_trainers(config, model, train_loss, learning_rate);
+        std::unique_ptr<Checkpointer> checkpointer;
+        if (trainers.is_rank0())
+            checkpointer = make_checkpointer(config);
+        // Started after make_trainers so the prefetch thread is not lost to a fork
+        std::unique_ptr<StreamingDataset> stream;
+        if (config.stream)
+        {
+            stream.reset(new StreamingDataset(train_dataset_path, LabelColumn::FIRST, config.batch_size,
+                                              config.shuffle_buffer, val_size));
+        }
 
         // --- 3. Early Stopping Parameters ---
         int patience = 10;
         int epochs_no_improve = 0;
         double best_val_loss = std::numeric_limits<double>::max();
-        std::vector<Matrix> best_weights;
-        std::vector<Matrix> best_biases;
+        bool stopped = false;
+        bool stop_training = false;
 
-        std::cout << "\nStarting Training for up to " << config.epochs << " epochs..." << std::endl;
-        for (int epoch = 0; epoch < config.epochs; ++epoch)
+        // Each epoch's parameters are validated in the background while the next
+        // epoch trains. Results arrive in epoch order and drive early stopping
+        // exactly as a synchronous loop would; epochs trained past the stopping
+        // point are discarded when the best weights are restored.
+        AsyncValidator validator(X_val, y_val, std::make_shared<CategoricalCrossEntropy>(), y_val_raw);
+        ValidationResult result;
+        auto consume_validation = [&](ValidationResult &validated)
         {
-            // --- Training Step on Training Data ---
-            Matrix y_pred_train = model.predict(X_train);
-            Matrix train_loss_grad = loss_fn.backward(y_pred_train, y_train);
-            model.backward(train_loss_grad);
-            optimizer.step();
+            if (stopped)
+                return;
 
-            // --- Validation Step on Validation Data ---
-            Matrix y_pred_val = model.predict(X_val);
-            double val_loss = loss_fn.calculate(y_pred_val, y_val);
-
-            if (epoch % 5 == 0)
+            if (validated.epoch % 5 == 0)
             {
-                double accuracy = calculate_accuracy(y_pred_val, y_val_raw);
-                std::cout << "Epoch: " << epoch << ", Validation Loss: " << val_loss 
-                         << ", Accuracy: " << accuracy * 100.0 << "%" << std::endl;
+                std::cout << "Epoch: " << validated.epoch << ", Validation Loss: " << validated.loss
+                         << ", Accuracy: " << validated.accuracy * 100.0 << "%" << std::endl;
             }
 
             // --- Early Stopping Logic ---
-            if (val_loss < best_val_loss)
+            if (validated.loss < best_val_loss)
             {
-                best_val_loss = val_loss;
+                best_val_loss = validated.loss;
                 epochs_no_improve = 0;
-                // Save a snapshot of the best model weights
-                best_weights.clear();
-                best_biases.clear();
-                for (auto &layer : model.getLayers())
-                {
-                    best_weights.push_back(layer.getWeights());
-                    best_biases.push_back(layer.getBiases());
-                }
+                // Keep the validated snapshot's weights as the best model
+                model.save_best(*validated.snapshot);
             }
             else
             {
@@ -307,19 +928,66 @@ void run_mnist_task(const Config &config)
 
             if (epochs_no_improve >= patience)
             {
-                std::cout << "\nEarly stopping triggered at epoch " << epoch << "!" << std::endl;
-                // Restore the best weights found
-                if (!best_weights.empty())
+                std::cout << "\nEarly stopping triggered at epoch " << validated.epoch << "!" << std::endl;
+                stopped = true;
+            }
+        };
+
+        std::cout << "\nStarting Training for up to " << config.epochs << " epochs..." << std::endl;
+        for (int epoch = start_epoch; epoch < config.epochs && !stop_training; ++epoch)
+        {
+            // --- Training Step on Training Data ---
+            if (stream)
+            {
+                // One optimizer step per mini-batch; the next batch is read meanwhile
+                if (epoch > start_epoch)
+                    stream->rewind();
+                DataBatch batch;
+                while (stream->next(batch))
                 {
-                    for (size_t i = 0; i < model.getLayers().size(); ++i)
-                    {
-                        model.getLayers()[i].setWeights(best_weights[i]);
-                        model.getLayers()[i].setBiases(best_biases[i]);
-                    }
+                    normalize_features(batch.features);
+                    train_epoch(trainers, model, train_loss, train_optimizer, batch.features,
+                                one_hot_encode(batch.labels, 10));
+                }
+            }
+            else
+            {
+                train_epoch(trainers, model, train_loss, train_optimizer, X_train, y_train);
+            }
+            checkpoint_if_due(checkpointer.get(), epoch, model, optimizer);
+
+            // --- Validation Step, overlapped with the next epoch ---
+            // A snapshot still holding a result is freed by taking the result
+            while (!validator.submit(epoch, model))
+            {
+                while (validator.poll(result))
+                {
+                    consume_validation(result);
                 }
-                break; // Exit the training loop
             }
+            while (validator.poll(result))
+            {
+                consume_validation(result);
+            }
+            // Processes see validation results at different times; stop them all
+            // at the same step once any has seen early stopping trigger
+            stop_training = trainers.group ? trainers.group->any(stopped) : stopped;
+        }
+        while (validator.wait(result))
+        {
+            consume_validation(result);
+        }
+
+        if (stopped && model.hasBest())
+        {
+            // Restore the best weights found
+            model.restore_best();
+        }
+        if (trainers.group)
+        {
+            trainers.group->finish(); // Only rank 0 continues
         }
+        finish_precision(precision, model);
 
         // --- 4. Final Evaluation using the Best Model ---
         std::cout << "\n--- Evaluation using Best Model ---" << std::endl;
@@ -338,64 +1006,625 @@ void run_mnist_task(const Config &config)
                 std::cerr << "Error saving model: " << e.what() << std::endl;
             }
         }
+
+        export_serving_model(model, config.export_model_path, [&](Model &m)
+                             {
+            auto normalization = normalization_transform(num_features);
+            m.fold_input_transform(normalization.first, normalization.second); });
     }
     else if (config.predict)
     {
         std::cout << "=== PREDICTION MODE ===" << std::endl;
-        
-        // --- Load Data for Prediction ---
-        std::cout << "Loading data for prediction..." << std::endl;
-        auto test_data = read_csv_mnist(test_dataset_path);
-        Matrix X_test = test_data.first;
-        Matrix y_test_raw = test_data.second; // For comparison if available
-        normalize_features(X_test);
 
         // --- Create and Load Model ---
         Model model;
-        model.add(DenseLayer(784, 128, std::make_shared<ReLU>()));
-        model.add(DenseLayer(128, 10, std::make_shared<Softmax>()));
-
+        std::unique_ptr<RawFeatureModel> raw; // Set for an int8 or sparse model
         std::cout << "Loading model from: " << config.load_model_path << std::endl;
         try {
-            model.load(config.load_model_path);
+            raw = load_raw_feature_model(config.load_model_path);
+            if (!raw)
+                model = config.mmap_model ? Model::map_file(config.load_model_path)
+                                          : load_model_file(config.load_model_path, [&]()
+                                                            { return build_mnist_model(config.hidden_layers, config.hidden_activation); });
             std::cout << "Model loaded successfully!" << std::endl;
         } catch (const std::exception& e) {
             std::cerr << "Error loading model: " << e.what() << std::endl;
             return;
         }
 
+        // Output rows: the predicted class, then every class probability
+        std::unique_ptr<PredictionCache> cache =
+            make_prediction_cache(config, raw ? raw->fingerprint : model.fingerprint());
+        auto infer = [&](Matrix &features)
+        {
+            if (raw)
+                return with_predicted_class(run_inference(*raw, features, cache.get()));
+            if (!model.hasFoldedInput())
+                normalize_features(features);
+            return with_predicted_class(run_inference(config, model, features, cache.get()));
+        };
+
+        if (!config.serve_path.empty())
+        {
+            run_server(config, raw ? raw->input_size : model_input_size(model), infer, cache.get());
+            return;
+        }
+
         // --- Make Predictions ---
-        Matrix predictions = model.predict(X_test);
-        
-        // Convert predictions to class labels
+        // Rows are streamed in chunks, so the input file can be of any size
+        std::string predict_dataset_path = config.dataset_path.empty() ? test_dataset_path : config.dataset_path;
+        std::cout << "Streaming predictions from: " << predict_dataset_path << std::endl;
+        StreamingDataset input(predict_dataset_path, LabelColumn::FIRST, config.chunk_size);
+
+        const int num_classes = 10;
+        std::vector<std::string> columns = {"label"};
+        for (int c = 0; c < num_classes; ++c)
+            columns.push_back("p" + std::to_string(c));
+
         std::cout << "\nPredictions:" << std::endl;
-        for(int i = 0; i < std::min(20, predictions.getRows()); ++i) {
-            // Find the class with highest probability
-            int predicted_class = 0;
-            double max_prob = predictions(i, 0);
-            for(int j = 1; j < predictions.getCols(); ++j) {
-                if (predictions(i, j) > max_prob) {
-                    max_prob = predictions(i, j);
-                    predicted_class = j;
+        long long correct = 0;
+        PredictionStats stats = stream_predictions(
+            input, config.output_path, columns, infer,
+            [&](const Matrix &output, const Matrix &actual, long long first_row)
+            {
+                for (int i = 0; i < output.getRows(); ++i)
+                {
+                    int predicted_class = static_cast<int>(output(i, 0));
+                    if (predicted_class == static_cast<int>(actual(i, 0)))
+                        ++correct;
+                    if (first_row + i < 20)
+                    {
+                        std::cout << "Sample " << first_row + i + 1 << " - Predicted: " << predicted_class
+                                  << ", Actual: " << (int)actual(i, 0)
+                                  << " (confidence: " << output(i, predicted_class + 1) << ")" << std::endl;
+                    }
                 }
-            }
-            
-            std::cout << "Sample " << i+1 << " - Predicted: " << predicted_class;
-            if (i < y_test_raw.getRows()) {
-                std::cout << ", Actual: " << (int)y_test_raw(i,0);
-            }
-            std::cout << " (confidence: " << max_prob << ")" << std::endl;
+            });
+
+        if (stats.rows > 20) {
+            std::cout << "... and " << (stats.rows - 20) << " more predictions." << std::endl;
         }
-        
-        if (predictions.getRows() > 20) {
-            std::cout << "... and " << (predictions.getRows() - 20) << " more predictions." << std::endl;
+        if (stats.rows > 0) {
+            std::cout << "\nOverall Test Accuracy: " << 100.0 * correct / stats.rows << "%" << std::endl;
         }
+        print_prediction_stats(config, stats, cache.get());
+    }
+}
+
+void run_convert_task(const Config &config)
+{
+    std::cout << "\n=== CONVERT MODE ===" << std::endl;
+    if (config.task_mode != "boston" && config.task_mode != "mnist")
+    {
+        std::cerr << "Error: Unknown task mode '" << config.task_mode << "'. Use 'boston' or 'mnist'." << std::endl;
+        return;
+    }
+    try {
+        // Legacy text models do not record their architecture, so the task provides it
+        Model model = load_model_file(config.convert_model_path, [&]()
+                                      { return config.task_mode == "boston"
+                                                   ? build_boston_model(13, config.hidden_layers, config.hidden_activation)
+                                                   : build_mnist_model(config.hidden_layers, config.hidden_activation); });
+        model.save(config.save_model_path);
+        std::cout << "Converted " << config.convert_model_path << " -> " << config.save_model_path
+                  << (Model::is_binary_file(config.save_model_path) ? " (binary)" : " (text)") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error converting model: " << e.what() << std::endl;
+    }
+}
+
+void run_convert_dataset_task(const Config &config)
+{
+    std::cout << "\n--- Dataset Conversion ---" << std::endl;
+    try {
+        StreamingDataset::convert_csv(config.convert_dataset_path, config.save_model_path);
+        std::cout << "Converted " << config.convert_dataset_path << " -> " << config.save_model_path
+                  << " (binary dataset)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error converting dataset: " << e.what() << std::endl;
+    }
+}
+
+static int predicted_class(const Matrix &probabilities, int row)
+{
+    int best = 0;
+    for (int j = 1; j < probabilities.getCols(); ++j)
+    {
+        if (probabilities(row, j) > probabilities(row, best))
+            best = j;
+    }
+    return best;
+}
+
+// Accuracy (MNIST) or MSE (Boston), agreement and throughput of the double and
+// int8 models over a dataset, read in --chunk-size chunks
+static void compare_quantized(const Config &config, Model &model, const QuantizedModel &quantized,
+                              const std::pair<Matrix, Matrix> &preprocessing, const std::string &path,
+                              LabelColumn label_column)
+{
+    bool classification = label_column == LabelColumn::FIRST;
+    StreamingDataset input(path, label_column, config.chunk_size);
+    DataBatch batch;
+    long long rows = 0, agreeing = 0;
+    double reference_metric = 0.0, quantized_metric = 0.0, largest_difference = 0.0;
+    double reference_seconds = 0.0, quantized_seconds = 0.0;
+    while (input.next(batch))
+    {
+        auto start = std::chrono::steady_clock::now();
+        Matrix features = batch.features;
+        apply_input_transform(features, preprocessing);
+        Matrix reference = run_inference(config, model, features);
+        auto middle = std::chrono::steady_clock::now();
+        Matrix approximate = quantized.predict(batch.features);
+        auto finish = std::chrono::steady_clock::now();
+        reference_seconds += std::chrono::duration<double>(middle - start).count();
+        quantized_seconds += std::chrono::duration<double>(finish - middle).count();
+
+        for (int i = 0; i < batch.features.getRows(); ++i)
+        {
+            if (classification)
+            {
+                int label = static_cast<int>(batch.labels(i, 0));
+                int expected = predicted_class(reference, i);
+                int actual = predicted_class(approximate, i);
+                reference_metric += expected == label;
+                quantized_metric += actual == label;
+                agreeing += expected == actual;
+            }
+            else
+            {
+                double target = batch.labels(i, 0);
+                reference_metric += (reference(i, 0) - target) * (reference(i, 0) - target);
+                quantized_metric += (approximate(i, 0) - target) * (approximate(i, 0) - target);
+                largest_difference = std::max(largest_difference, std::fabs(approximate(i, 0) - reference(i, 0)));
+            }
+        }
+        rows += batch.features.getRows();
+    }
+    if (rows == 0)
+    {
+        throw std::runtime_error("Dataset has no rows: " + path);
+    }
+
+    std::cout << "\n--- Int8 vs double on " << path << " (" << rows << " rows) ---" << std::endl;
+    if (classification)
+    {
+        double reference_accuracy = 100.0 * reference_metric / rows;
+        double quantized_accuracy = 100.0 * quantized_metric / rows;
+        std::cout << "Accuracy: double " << reference_accuracy << "%, int8 " << quantized_accuracy << "% (delta "
+                  << quantized_accuracy - reference_accuracy << " points)" << std::endl;
+        std::cout << "Predicted classes agreeing: " << 100.0 * agreeing / rows << "%" << std::endl;
+    }
+    else
+    {
+        double reference_mse = reference_metric / rows;
+        double quantized_mse = quantized_metric / rows;
+        std::cout << "MSE: double " << reference_mse << ", int8 " << quantized_mse << " (delta "
+                  << quantized_mse - reference_mse << ")" << std::endl;
+        std::cout << "Largest prediction difference: " << largest_difference << std::endl;
+    }
+    double reference_rate = rows / reference_seconds;
+    double quantized_rate = rows / quantized_seconds;
+    std::cout << "Throughput: double " << static_cast<long long>(reference_rate) << " rows/sec, int8 "
+              << static_cast<long long>(quantized_rate) << " rows/sec (" << quantized_rate / reference_rate << "x)"
+              << std::endl;
+}
+
+void run_quantize_task(const Config &config)
+{
+    std::cout << "\n=== QUANTIZE MODE ===" << std::endl;
+    bool mnist = config.task_mode == "mnist";
+    if (!mnist && config.task_mode != "boston")
+    {
+        std::cerr << "Error: Unknown task mode '" << config.task_mode << "'. Use 'boston' or 'mnist'." << std::endl;
+        return;
+    }
+    LabelColumn label_column = mnist ? LabelColumn::FIRST : LabelColumn::LAST;
+    std::string calibration_path = !config.dataset_path.empty() ? config.dataset_path
+                                   : mnist                      ? "data/mnist_train.csv"
+                                                                : "data/boston_housing.csv";
+    // Boston has no separate test set, so it is compared on the dataset itself
+    std::string eval_path = mnist ? "data/mnist_test.csv" : calibration_path;
+    try {
+        Model model = load_model_file(config.quantize_model_path, [&]()
+                                      { return mnist ? build_mnist_model(config.hidden_layers, config.hidden_activation)
+                                                     : build_boston_model(StreamingDataset::column_count(calibration_path) - 1,
+                                                                          config.hidden_layers, config.hidden_activation); });
+        StreamingDataset calibration_input(calibration_path, label_column, config.calibration_rows);
+        DataBatch calibration;
+        if (!calibration_input.next(calibration))
+        {
+            throw std::runtime_error("Dataset has no rows: " + calibration_path);
+        }
+
+        // The preprocessing the double model expects; none once it is folded in
+        int features = calibration.features.getCols();
+        std::pair<Matrix, Matrix> preprocessing = {Matrix(1, features), Matrix(1, features)};
+        preprocessing.second.map([](double)
+                                 { return 1.0; });
+        if (!model.hasFoldedInput() && mnist)
+        {
+            preprocessing = normalization_transform(features);
+        }
+        else if (!model.hasFoldedInput())
+        {
+            StandardScaler scaler;
+            if (model.hasScaler())
+            {
+                scaler = model.getScaler();
+            }
+            else
+            {
+                std::cout << "Model has no stored scaler, fitting one on the calibration data." << std::endl;
+                scaler.fit(calibration.features);
+            }
+            preprocessing = scaler_transform(scaler);
+        }
+
+        QuantizedModel quantized =
+            QuantizedModel::quantize(model, calibration.features, preprocessing.first, preprocessing.second);
+        quantized.save(config.save_model_path);
+        std::cout << "Quantized " << config.quantize_model_path << " -> " << config.save_model_path << " (calibrated on "
+                  << calibration.features.getRows() << " rows of " << calibration_path << ")" << std::endl;
 
-        // Calculate overall accuracy if we have labels
-        if (y_test_raw.getRows() > 0) {
-            double accuracy = calculate_accuracy(predictions, y_test_raw);
-            std::cout << "\nOverall Test Accuracy: " << accuracy * 100.0 << "%" << std::endl;
+        size_t double_bytes = 0;
+        for (const DenseLayer &layer : model.getLayers())
+        {
+            double_bytes += (static_cast<size_t>(layer.getWeights().getRows()) + 1) * layer.getWeights().getCols() *
+                            sizeof(double);
         }
+        std::cout << "Int8 kernel: " << QuantizedModel::kernel_name() << std::endl;
+        std::cout << "Parameters: double " << double_bytes / (1024.0 * 1024.0) << " MB, int8 "
+                  << quantized.parameter_bytes() / (1024.0 * 1024.0) << " MB ("
+                  << static_cast<double>(double_bytes) / quantized.parameter_bytes() << "x smaller)" << std::endl;
+        compare_quantized(config, model, quantized, preprocessing, eval_path, label_column);
+    } catch (const std::exception& e) {
+        std::cerr << "Error quantizing model: " << e.what() << std::endl;
+    }
+}
+
+// Rows per second of predict over X, repeated until a quarter second has passed
+static double measure_rows_per_second(const std::function<Matrix(const Matrix &)> &predict, const Matrix &X)
+{
+    long long rows = 0;
+    double seconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (seconds < 0.25)
+    {
+        predict(X);
+        rows += X.getRows();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return rows / seconds;
+}
+
+// Accuracy in percent (MNIST, against class labels) or MSE (Boston)
+static double prediction_metric(const Matrix &predictions, const Matrix &labels, bool classification)
+{
+    double metric = 0.0;
+    for (int i = 0; i < predictions.getRows(); ++i)
+    {
+        if (classification)
+            metric += predicted_class(predictions, i) == static_cast<int>(labels(i, 0));
+        else
+            metric += (predictions(i, 0) - labels(i, 0)) * (predictions(i, 0) - labels(i, 0));
+    }
+    return (classification ? 100.0 : 1.0) * metric / predictions.getRows();
+}
+
+// Rows the model tools (--prune, --factorize, --generate) fine-tune and evaluate on, with the same
+// splits as training: MNIST fine-tunes on 5000 training rows and is evaluated
+// on the test set, Boston on its first 400 rows and the rest
+struct CompressionData
+{
+    Matrix X_train{0, 0}; // Preprocessed, as the model expects them
+    Matrix y_train{0, 0}; // One-hot for MNIST
+    Matrix X_eval{0, 0};  // Raw features
+    Matrix X_eval_input{0, 0};
+    Matrix y_eval{0, 0}; // Class labels or targets
+    std::pair<Matrix, Matrix> preprocessing{Matrix(0, 0), Matrix(0, 0)}; // Raw to model input
+    bool input_folded = false; // Whether the model file had preprocessing folded in
+};
+
+// Loads the data and a model to compress, with any folded preprocessing taken
+// back out of the first layer so the model can be fine-tuned
+static Model load_compression_task(const Config &config, const std::string &model_path, CompressionData &data)
+{
+    bool mnist = config.task_mode == "mnist";
+    std::string dataset_path = !config.dataset_path.empty() ? config.dataset_path
+                               : mnist                      ? "data/mnist_train.csv"
+                                                            : "data/boston_housing.csv";
+    if (mnist)
+    {
+        auto train = read_csv_mnist(dataset_path);
+        int train_size = std::min(5000, train.first.getRows());
+        data.X_train = train.first.slice(0, train_size);
+        data.y_train = one_hot_encode(train.second.slice(0, train_size), 10);
+        auto test = read_csv_mnist("data/mnist_test.csv");
+        data.X_eval = std::move(test.first);
+        data.y_eval = std::move(test.second);
+    }
+    else
+    {
+        auto separated = separate_features_target(read_csv_boston(dataset_path));
+        int train_size = std::min(400, separated.first.getRows() - 1);
+        data.X_train = separated.first.slice(0, train_size);
+        data.y_train = separated.second.slice(0, train_size);
+        data.X_eval = separated.first.slice(train_size, separated.first.getRows());
+        data.y_eval = separated.second.slice(train_size, separated.second.getRows());
+    }
+
+    Model model = load_model_file(model_path, [&]()
+                                  { return mnist ? build_mnist_model(config.hidden_layers, config.hidden_activation)
+                                                 : build_boston_model(data.X_train.getCols(), config.hidden_layers,
+                                                                      config.hidden_activation); });
+    data.input_folded = model.hasFoldedInput();
+    data.preprocessing = normalization_transform(data.X_train.getCols());
+    if (!mnist)
+    {
+        StandardScaler scaler;
+        if (model.hasScaler())
+            scaler = model.getScaler();
+        else
+            scaler.fit(data.X_train);
+        model.setScaler(scaler);
+        data.preprocessing = scaler_transform(scaler);
+    }
+    if (data.input_folded)
+    {
+        model.unfold_input_transform(data.preprocessing.first, data.preprocessing.second);
+    }
+    apply_input_transform(data.X_train, data.preprocessing);
+    data.X_eval_input = data.X_eval;
+    apply_input_transform(data.X_eval_input, data.preprocessing);
+    return model;
+}
+
+static std::unique_ptr<Loss> make_task_loss(bool mnist)
+{
+    if (mnist)
+        return std::unique_ptr<Loss>(new CategoricalCrossEntropy());
+    return std::unique_ptr<Loss>(new MeanSquaredError());
+}
+
+void run_prune_task(const Config &config)
+{
+    std::cout << "\n=== PRUNE MODE ===" << std::endl;
+    bool mnist = config.task_mode == "mnist";
+    if (!mnist && config.task_mode != "boston")
+    {
+        std::cerr << "Error: Unknown task mode '" << config.task_mode << "'. Use 'boston' or 'mnist'." << std::endl;
+        return;
+    }
+    try {
+        CompressionData data;
+        Model model = load_compression_task(config, config.prune_model_path, data);
+
+        std::unique_ptr<Loss> loss_fn = make_task_loss(mnist);
+        const double learning_rate = mnist ? 0.002 : 0.01;
+        bool blocks = config.sparse_format == SparseFormat::BSR;
+        std::vector<DenseLayer> &layers = model.getLayers();
+
+        std::cout << "Pruning " << config.prune_model_path << " ("
+                  << (blocks ? std::to_string(kSparseBlock) + "x" + std::to_string(kSparseBlock) + " blocks, BSR"
+                             : "single weights, CSR")
+                  << "), " << config.fine_tune_epochs << " fine-tuning epochs per step" << std::endl;
+        std::cout << "\nSparsity | " << (mnist ? "Accuracy" : "MSE     ")
+                  << " | Dense rows/sec | Sparse rows/sec | Speedup | Sparse MB" << std::endl;
+        auto report = [&]()
+        {
+            SparseModel sparse = SparseModel::from_model(model, data.preprocessing.first, data.preprocessing.second,
+                                                         config.sparse_format);
+            auto dense_predict = [&](const Matrix &X)
+            { return model.predict(X); };
+            auto sparse_predict = [&](const Matrix &X)
+            { return sparse.predict(X); };
+            double metric = prediction_metric(sparse.predict(data.X_eval), data.y_eval, mnist);
+            double dense_rate = measure_rows_per_second(dense_predict, data.X_eval_input);
+            double sparse_rate = measure_rows_per_second(sparse_predict, data.X_eval);
+            std::cout << std::fixed << std::setprecision(1) << std::setw(7) << 100.0 * weight_sparsity(layers)
+                      << "% | " << std::setprecision(mnist ? 2 : 4) << std::setw(8) << metric << " | "
+                      << std::setw(14) << static_cast<long long>(dense_rate) << " | " << std::setw(15)
+                      << static_cast<long long>(sparse_rate) << " | " << std::setprecision(2) << std::setw(6)
+                      << sparse_rate / dense_rate << "x | " << std::setprecision(3) << std::setw(9)
+                      << sparse.parameter_bytes() / (1024.0 * 1024.0) << std::defaultfloat << std::endl;
+            return sparse;
+        };
+
+        // Every level prunes the fine-tuned result of the one before
+        SparseModel sparse = report();
+        std::vector<double> levels = config.prune_threshold > 0.0 ? std::vector<double>{0.0} : config.sparsity_levels;
+        for (double level : levels)
+        {
+            PruningMask mask = config.prune_threshold > 0.0 ? PruningMask::by_threshold(layers, config.prune_threshold)
+                                                            : PruningMask::by_sparsity(layers, level, blocks);
+            Adam adam(layers, learning_rate);
+            MaskedOptimizer optimizer(layers, adam, mask);
+            Trainers single_threaded; // Its cached plan belongs to this level's training
+            for (int epoch = 0; epoch < config.fine_tune_epochs; ++epoch)
+            {
+                train_epoch(single_threaded, model, *loss_fn, optimizer, data.X_train, data.y_train);
+            }
+            sparse = report();
+        }
+
+        sparse.save(config.save_model_path);
+        std::cout << "\nSaved the last sparse model (" << 100.0 * sparse.density() << "% of weights stored) to "
+                  << config.save_model_path << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error pruning model: " << e.what() << std::endl;
+    }
+}
+
+// Multiply-adds per predicted row
+static long long multiply_adds(Model &model)
+{
+    long long total = 0;
+    for (const DenseLayer &layer : model.getLayers())
+        total += static_cast<long long>(layer.getWeights().getRows()) * layer.getWeights().getCols();
+    return total;
+}
+
+void run_factorize_task(const Config &config)
+{
+    std::cout << "\n=== FACTORIZE MODE ===" << std::endl;
+    bool mnist = config.task_mode == "mnist";
+    if (!mnist && config.task_mode != "boston")
+    {
+        std::cerr << "Error: Unknown task mode '" << config.task_mode << "'. Use 'boston' or 'mnist'." << std::endl;
+        return;
+    }
+    try {
+        CompressionData data;
+        Model model = load_compression_task(config, config.factorize_model_path, data);
+        std::unique_ptr<Loss> loss_fn = make_task_loss(mnist);
+        const double learning_rate = mnist ? 0.002 : 0.01;
+
+        // One decomposition per layer serves every rank
+        std::vector<SingularValueDecomposition> decompositions;
+        for (const DenseLayer &layer : model.getLayers())
+        {
+            decompositions.push_back(singular_value_decomposition(layer.getWeights()));
+        }
+
+        std::cout << "Factorizing " << config.factorize_model_path << ", " << config.fine_tune_epochs
+                  << " fine-tuning epochs per rank (layers a factorization would not speed up are kept)" << std::endl;
+        std::string metric_name = mnist ? "Accuracy" : "MSE";
+        std::cout << "\nRanks        | FLOPs/row | Min energy | " << metric_name << " SVD | " << metric_name
+                  << " tuned | Latency us/row | Speedup" << std::endl;
+        auto measure = [&](Model &candidate)
+        {
+            return measure_rows_per_second([&](const Matrix &X)
+                                           { return candidate.predict(X); },
+                                           data.X_eval_input);
+        };
+        double dense_rate = measure(model);
+        auto report = [&](const std::string &ranks, Model &candidate, double energy, double before, double after)
+        {
+            double rate = measure(candidate);
+            std::cout << std::left << std::setw(12) << ranks << std::right << " | " << std::setw(9)
+                      << 2 * multiply_adds(candidate) << " | " << std::fixed << std::setprecision(1)
+                      << std::setw(9) << 100.0 * energy << "% | " << std::setprecision(mnist ? 2 : 4)
+                      << std::setw(metric_name.size() + 4) << before << " | " << std::setw(metric_name.size() + 6)
+                      << after << " | " << std::setprecision(2) << std::setw(14) << 1e6 / rate << " | "
+                      << std::setw(6) << rate / dense_rate << "x" << std::defaultfloat << std::endl;
+        };
+        double dense_metric = prediction_metric(model.predict(data.X_eval_input), data.y_eval, mnist);
+        report("dense", model, 1.0, dense_metric, dense_metric);
+
+        // Every rank starts from the original model
+        Model factorized = model.snapshot();
+        size_t targets = config.energies.empty() ? config.ranks.size() : config.energies.size();
+        for (size_t t = 0; t < targets; ++t)
+        {
+            Model candidate = model.snapshot();
+            std::vector<DenseLayer> layers;
+            std::string ranks;
+            double energy = 1.0;
+            for (size_t l = 0; l < decompositions.size(); ++l)
+            {
+                const DenseLayer &layer = candidate.getLayers()[l];
+                int inputs = layer.getWeights().getRows();
+                int outputs = layer.getWeights().getCols();
+                const std::vector<double> &singular = decompositions[l].singular;
+                int rank = config.energies.empty() ? std::min<int>(config.ranks[t], static_cast<int>(singular.size()))
+                                                   : rank_for_energy(singular, config.energies[t]);
+                ranks += l == 0 ? "" : ",";
+                if (factorization_saves_work(inputs, outputs, rank))
+                {
+                    std::vector<DenseLayer> factors = factorize_layer(layer, decompositions[l], rank);
+                    layers.insert(layers.end(), factors.begin(), factors.end());
+                    energy = std::min(energy, retained_energy(singular, rank));
+                    ranks += std::to_string(rank);
+                }
+                else
+                {
+                    layers.push_back(layer);
+                    ranks += "-";
+                }
+            }
+            candidate.getLayers() = std::move(layers);
+
+            double before = prediction_metric(candidate.predict(data.X_eval_input), data.y_eval, mnist);
+            Adam optimizer(candidate.getLayers(), learning_rate);
+            Trainers single_threaded; // Its cached plan belongs to this candidate's layers
+            for (int epoch = 0; epoch < config.fine_tune_epochs; ++epoch)
+            {
+                train_epoch(single_threaded, candidate, *loss_fn, optimizer, data.X_train, data.y_train);
+            }
+            double after = prediction_metric(candidate.predict(data.X_eval_input), data.y_eval, mnist);
+            report(ranks, candidate, energy, before, after);
+            factorized = std::move(candidate);
+        }
+
+        // Saved in the form the original was in
+        if (data.input_folded)
+        {
+            factorized.fold_input_transform(data.preprocessing.first, data.preprocessing.second);
+        }
+        factorized.save(config.save_model_path);
+        std::cout << "\nSaved the last factorized model (" << factorized.getLayers().size() << " layers) to "
+                  << config.save_model_path << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error factorizing model: " << e.what() << std::endl;
+    }
+}
+
+void run_generate_task(const Config &config)
+{
+    std::cout << "\n=== GENERATE MODE ===" << std::endl;
+    bool mnist = config.task_mode == "mnist";
+    if (!mnist && config.task_mode != "boston")
+    {
+        std::cerr << "Error: Unknown task mode '" << config.task_mode << "'. Use 'boston' or 'mnist'." << std::endl;
+        return;
+    }
+    try {
+        CompressionData data;
+        Model model = load_compression_task(config, config.generate_model_path, data);
+        std::string name = CodeGenerator::identifier_for(config.save_model_path);
+        CodeGenerator generator(model, data.preprocessing.first, data.preprocessing.second, name);
+        generator.write_header(config.save_model_path);
+        std::cout << "Generated " << config.save_model_path << ": " << name << "::predict(const double *input, double *output)"
+                  << std::endl;
+
+        // One row per call, as an embedded scorer is called, and whole batches
+        Matrix expected = model.predict(data.X_eval_input);
+        int rows = data.X_eval_input.getRows();
+        long long scored = 0;
+        double seconds = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        while (seconds < 0.25)
+        {
+            for (int i = 0; i < rows; ++i)
+            {
+                model.predict(data.X_eval_input.slice(i, i + 1));
+            }
+            scored += rows;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        double single_row = 1e6 * seconds / scored;
+        double batched = 1e6 / measure_rows_per_second([&](const Matrix &X)
+                                                       { return model.predict(X); },
+                                                       data.X_eval_input);
+
+        const char *cxx = std::getenv("CXX");
+        std::string compiler = std::string(cxx && *cxx ? cxx : "c++") + " -O2 -march=native";
+        std::cout << "\nLatency over " << rows << " rows, one row per call (generated code built with: " << compiler
+                  << ")" << std::endl;
+        std::cout << "Model::predict, one row:   " << single_row << " us/row" << std::endl;
+        std::cout << "Model::predict, all rows:  " << batched << " us/row" << std::endl;
+        try {
+            double difference = 0.0;
+            double generated = generator.benchmark(config.save_model_path, compiler, data.X_eval, expected, difference);
+            std::cout << "Generated predict, one row: " << generated << " us/row (" << single_row / generated
+                      << "x faster than Model::predict)" << std::endl;
+            std::cout << "Largest difference from Model::predict: " << difference << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error generating code: " << e.what() << std::endl;
     }
 }
 
@@ -404,18 +1633,70 @@ void print_usage() {
     std::cout << "Required arguments:" << std::endl;
     std::cout << "  --mode <task>          Task mode: 'mnist' or 'boston'" << std::endl;
     std::cout << "  --train OR --predict   Training or prediction mode" << std::endl;
+    std::cout << "  OR --convert <path>    Convert a model file to the format given by --save" << std::endl;
+    std::cout << "  OR --convert-dataset <csv>  Convert a CSV dataset to the binary dataset format at --save" << std::endl;
+    std::cout << "  OR --quantize <path>   Quantize a model to int8 at --save and compare it with the original" << std::endl;
+    std::cout << "  OR --prune <path>      Prune and fine-tune a model step by step, report each step, save the sparse model at --save" << std::endl;
+    std::cout << "  OR --factorize <path>  Factorize a model's layers by truncated SVD at several ranks, report each, save the last at --save" << std::endl;
+    std::cout << "  OR --generate <path>   Compile a model into a standalone C++ header at --save and benchmark it" << std::endl;
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --epochs <num>         Number of training epochs (default: 100)" << std::endl;
     std::cout << "  --dataset <path>       Path to dataset file" << std::endl;
     std::cout << "  --load <path>          Load existing model from file" << std::endl;
-    std::cout << "  --save <path>          Save trained model to file" << std::endl;
+    std::cout << "  --save <path>          Save trained model to file (binary if it ends in .bin)" << std::endl;
+    std::cout << "  --export <path>        Save a serving model with input scaling folded in" << std::endl;
+    std::cout << "  --checkpoint-every <n> Write a full training checkpoint every n epochs (in the background)" << std::endl;
+    std::cout << "  --checkpoint <path>    Checkpoint file (default: <save path>.ckpt); resume with --load <path>" << std::endl;
+    std::cout << "  --workers <n>          Data-parallel training threads (0 = one per core, default: 1)" << std::endl;
+    std::cout << "  --processes <n>        Train in n processes exchanging gradients through shared memory" << std::endl;
+    std::cout << "  --pipeline <stages>    Pipeline-parallel execution: layers split into stages on separate threads" << std::endl;
+    std::cout << "  --micro-batches <n>    Micro-batches per batch for --pipeline (default: 4)" << std::endl;
+    std::cout << "  --hogwild              Lock-free asynchronous mini-batch training on --workers threads" << std::endl;
+    std::cout << "  --batch-size <n>       Mini-batch size for --hogwild and --stream (default: 64)" << std::endl;
+    std::cout << "  --recompute <k>        Keep every k-th layer's activations in training and recompute the rest (0 = keep all)" << std::endl;
+    std::cout << "  --precision <p>        Training arithmetic: double (default) or bf16 (bfloat16 operands, float32 accumulation)" << std::endl;
+    std::cout << "  --loss-scale <s>       Dynamic loss scaling starting at s (e.g. 65536); 0 disables it (default)" << std::endl;
+    std::cout << "  --stream               Stream the training file in mini-batches with a prefetch thread (MNIST)" << std::endl;
+    std::cout << "  --output <path>        Write predictions to a CSV file (binary dataset if it ends in .bin)" << std::endl;
+    std::cout << "  --chunk-size <n>       Rows per streamed chunk in prediction mode (default: 4096)" << std::endl;
+    std::cout << "  --serve <socket>       Prediction server on a Unix socket: one CSV feature row per line in, one output line back" << std::endl;
+    std::cout << "  --max-batch <n>        Requests batched into one forward pass by --serve (default: 64)" << std::endl;
+    std::cout << "  --max-latency <ms>     Longest a --serve request waits to be batched (default: 2)" << std::endl;
+    std::cout << "  --cache-mb <n>         Cache predictions of repeated input rows in up to n MB (prediction and --serve)" << std::endl;
+    std::cout << "  --calibration-rows <n> Training rows --quantize calibrates activation ranges on (default: 1000)" << std::endl;
+    std::cout << "  --sparsity <s,s,...>   Increasing fractions of weights --prune removes (default: 0.5,0.8,0.95)" << std::endl;
+    std::cout << "  --prune-threshold <t>  Prune weights with |w| < t in one step instead of --sparsity" << std::endl;
+    std::cout << "  --sparse-format <f>    csr (default) or bsr (prunes and stores 4x4 weight blocks)" << std::endl;
+    std::cout << "  --fine-tune <epochs>   Training epochs after each pruning step or factorization (default: 10)" << std::endl;
+    std::cout << "  --rank <r,r,...>       Ranks --factorize tries (default: 64,32,16,8)" << std::endl;
+    std::cout << "  --energy <e,e,...>     Instead, give each layer the smallest rank keeping this fraction of its energy" << std::endl;
+    std::cout << "  --shuffle-buffer <n>   Rows shuffled together while streaming, 0 keeps file order (default: 4096)" << std::endl;
+    std::cout << "  --benchmark hogwild    Compare Hogwild and synchronous convergence over wall-clock time (MNIST data)" << std::endl;
+    std::cout << "  --benchmark static     Compare the compile-time StaticMLP with Model on the default network (--epochs steps)" << std::endl;
+    std::cout << "  --benchmark plan       Compare Model with its compiled execution plan over --epochs of --batch-size steps" << std::endl;
+    std::cout << "  --benchmark math       Accuracy and speed of the vectorized exp, log, tanh and sigmoid, and of Softmax" << std::endl;
+    std::cout << "  --benchmark parallel   Check --workers, --processes and --pipeline gradients against the single-threaded Model (--epochs steps)" << std::endl;
+    std::cout << "  --seed <n>             Seed the random generator for reproducible runs" << std::endl;
+    std::cout << "  --mmap                 Predict with a read-only, shared mmap of a binary model" << std::endl;
+    std::cout << "  --hidden <n,n,...>     Hidden layer sizes for new models (default: 64,64 boston, 128 mnist)" << std::endl;
+    std::cout << "  --activation <a>       Hidden layer activation for new models: relu (default), sigmoid, tanh or gelu" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  ./mlp --mode mnist --train --epochs 150 --save models/mnist_model.txt" << std::endl;
     std::cout << "  ./mlp --mode mnist --predict --load models/mnist_model.txt" << std::endl;
+    std::cout << "  ./mlp --mode mnist --predict --load models/mnist_model.txt --dataset big.csv --output preds.csv" << std::endl;
+    std::cout << "  ./mlp --mode boston --predict --load models/boston_model.txt --serve /tmp/mlp.sock" << std::endl;
     std::cout << "  ./mlp --mode boston --train --dataset data/custom_boston.csv --save models/boston_model.txt" << std::endl;
     std::cout << "  ./mlp --mode boston --predict --load models/boston_model.txt" << std::endl;
+    std::cout << "  ./mlp --mode mnist --convert models/mnist_test.txt --save models/mnist_test.bin" << std::endl;
+    std::cout << "  ./mlp --mode mnist --convert-dataset data/mnist_train.csv --save data/mnist_train.bin" << std::endl;
+    std::cout << "  ./mlp --mode mnist --quantize models/mnist_model.bin --save models/mnist_model.q8" << std::endl;
+    std::cout << "  ./mlp --mode mnist --predict --load models/mnist_model.q8" << std::endl;
+    std::cout << "  ./mlp --mode mnist --prune models/mnist_model.bin --sparse-format bsr --save models/mnist_model.sparse" << std::endl;
+    std::cout << "  ./mlp --mode mnist --factorize models/mnist_model.bin --rank 32 --save models/mnist_model_r32.bin" << std::endl;
+    std::cout << "  ./mlp --mode boston --generate models/boston_model.txt --save boston_model.hpp" << std::endl;
+    std::cout << "  ./mlp --mode mnist --train --stream --dataset data/mnist_train.bin --batch-size 128" << std::endl;
 }
 
 int main(int argc, char *argv[])
@@ -449,6 +1730,7 @@ int main(int argc, char *argv[])
 
     config.train = parser.option_exists("--train");
     config.predict = parser.option_exists("--predict");
+    config.mmap_model = parser.option_exists("--mmap");
 
     const std::string &epochs_str = parser.get_option("--epochs");
     if (!epochs_str.empty())
@@ -456,23 +1738,474 @@ int main(int argc, char *argv[])
         config.epochs = std::stoi(epochs_str);
     }
 
+    const std::string &hidden_str = parser.get_option("--hidden");
+    if (!hidden_str.empty())
+    {
+        std::stringstream ss(hidden_str);
+        std::string units;
+        while (std::getline(ss, units, ','))
+        {
+            int size = std::stoi(units);
+            if (size <= 0)
+            {
+                std::cerr << "Error: --hidden sizes must be positive." << std::endl;
+                return 1;
+            }
+            config.hidden_layers.push_back(size);
+        }
+    }
+
+    const std::string &activation_str = parser.get_option("--activation");
+    if (!activation_str.empty())
+    {
+        if (activation_str != "relu" && activation_str != "sigmoid" && activation_str != "tanh" &&
+            activation_str != "gelu")
+        {
+            std::cerr << "Error: --activation must be relu, sigmoid, tanh or gelu." << std::endl;
+            return 1;
+        }
+        config.hidden_activation = activation_str;
+    }
+
+    const std::string &checkpoint_every_str = parser.get_option("--checkpoint-every");
+    if (!checkpoint_every_str.empty())
+    {
+        config.checkpoint_every = std::stoi(checkpoint_every_str);
+    }
+    config.checkpoint_path = parser.get_option("--checkpoint");
+    if (config.checkpoint_path.empty() && !parser.get_option("--save").empty())
+    {
+        config.checkpoint_path = parser.get_option("--save") + ".ckpt";
+    }
+
+    const std::string &workers_str = parser.get_option("--workers");
+    if (!workers_str.empty())
+    {
+        config.workers = std::stoi(workers_str);
+        if (config.workers < 0)
+        {
+            std::cerr << "Error: --workers must be 0 (one per core) or positive." << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string &processes_str = parser.get_option("--processes");
+    if (!processes_str.empty())
+    {
+        config.processes = std::stoi(processes_str);
+        if (config.processes < 1)
+        {
+            std::cerr << "Error: --processes must be positive." << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string &pipeline_str = parser.get_option("--pipeline");
+    if (!pipeline_str.empty())
+    {
+        config.pipeline_stages = std::stoi(pipeline_str);
+        if (config.pipeline_stages < 1)
+        {
+            std::cerr << "Error: --pipeline needs at least one stage." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &micro_batches_str = parser.get_option("--micro-batches");
+    if (!micro_batches_str.empty())
+    {
+        config.micro_batches = std::stoi(micro_batches_str);
+        if (config.micro_batches < 1)
+        {
+            std::cerr << "Error: --micro-batches must be positive." << std::endl;
+            return 1;
+        }
+    }
+
+    config.hogwild = parser.option_exists("--hogwild");
+    const std::string &batch_size_str = parser.get_option("--batch-size");
+    if (!batch_size_str.empty())
+    {
+        config.batch_size = std::stoi(batch_size_str);
+        if (config.batch_size <= 0)
+        {
+            std::cerr << "Error: --batch-size must be positive." << std::endl;
+            return 1;
+        }
+    }
+    config.benchmark = parser.get_option("--benchmark");
+    const std::string &recompute_str = parser.get_option("--recompute");
+    if (!recompute_str.empty())
+    {
+        config.recompute_every = std::stoi(recompute_str);
+        if (config.recompute_every < 0)
+        {
+            std::cerr << "Error: --recompute cannot be negative." << std::endl;
+            return 1;
+        }
+    }
+
+    config.stream = parser.option_exists("--stream");
+    const std::string &precision_str = parser.get_option("--precision");
+    if (precision_str == "bf16")
+    {
+        config.precision = Precision::BF16;
+    }
+    else if (!precision_str.empty() && precision_str != "double")
+    {
+        std::cerr << "Error: --precision must be 'double' or 'bf16'." << std::endl;
+        return 1;
+    }
+    const std::string &loss_scale_str = parser.get_option("--loss-scale");
+    if (!loss_scale_str.empty())
+    {
+        config.loss_scale = std::stod(loss_scale_str);
+        if (config.loss_scale < 0.0)
+        {
+            std::cerr << "Error: --loss-scale must be 0 or positive." << std::endl;
+            return 1;
+        }
+    }
+    config.output_path = parser.get_option("--output");
+    config.serve_path = parser.get_option("--serve");
+    const std::string &max_batch_str = parser.get_option("--max-batch");
+    if (!max_batch_str.empty())
+    {
+        config.max_batch = std::stoi(max_batch_str);
+        if (config.max_batch <= 0)
+        {
+            std::cerr << "Error: --max-batch must be positive." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &cache_mb_str = parser.get_option("--cache-mb");
+    if (!cache_mb_str.empty())
+    {
+        config.cache_mb = std::stoi(cache_mb_str);
+        if (config.cache_mb < 0)
+        {
+            std::cerr << "Error: --cache-mb must be 0 or positive." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &max_latency_str = parser.get_option("--max-latency");
+    if (!max_latency_str.empty())
+    {
+        config.max_latency_ms = std::stod(max_latency_str);
+        if (config.max_latency_ms < 0.0)
+        {
+            std::cerr << "Error: --max-latency must be 0 or positive." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &chunk_size_str = parser.get_option("--chunk-size");
+    if (!chunk_size_str.empty())
+    {
+        config.chunk_size = std::stoi(chunk_size_str);
+        if (config.chunk_size <= 0)
+        {
+            std::cerr << "Error: --chunk-size must be positive." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &shuffle_buffer_str = parser.get_option("--shuffle-buffer");
+    if (!shuffle_buffer_str.empty())
+    {
+        int rows = std::stoi(shuffle_buffer_str);
+        if (rows < 0)
+        {
+            std::cerr << "Error: --shuffle-buffer must be 0 or positive." << std::endl;
+            return 1;
+        }
+        config.shuffle_buffer = static_cast<size_t>(rows);
+    }
+
+    const std::string &seed_str = parser.get_option("--seed");
+    if (!seed_str.empty())
+    {
+        config.has_seed = true;
+        config.seed = static_cast<unsigned int>(std::stoul(seed_str));
+    }
+
     config.dataset_path = parser.get_option("--dataset");
     config.load_model_path = parser.get_option("--load");
     config.save_model_path = parser.get_option("--save");
+    config.export_model_path = parser.get_option("--export");
+    config.convert_model_path = parser.get_option("--convert");
+    config.convert_dataset_path = parser.get_option("--convert-dataset");
+    config.quantize_model_path = parser.get_option("--quantize");
+    const std::string &calibration_rows_str = parser.get_option("--calibration-rows");
+    if (!calibration_rows_str.empty())
+    {
+        config.calibration_rows = std::stoi(calibration_rows_str);
+        if (config.calibration_rows <= 0)
+        {
+            std::cerr << "Error: --calibration-rows must be positive." << std::endl;
+            return 1;
+        }
+    }
+
+    config.prune_model_path = parser.get_option("--prune");
+    const std::string &sparsity_str = parser.get_option("--sparsity");
+    if (!sparsity_str.empty())
+    {
+        config.sparsity_levels.clear();
+        std::stringstream ss(sparsity_str);
+        std::string level;
+        while (std::getline(ss, level, ','))
+        {
+            double sparsity = std::stod(level);
+            if (sparsity < 0.0 || sparsity >= 1.0 ||
+                (!config.sparsity_levels.empty() && sparsity <= config.sparsity_levels.back()))
+            {
+                std::cerr << "Error: --sparsity levels must increase and lie in [0, 1)." << std::endl;
+                return 1;
+            }
+            config.sparsity_levels.push_back(sparsity);
+        }
+    }
+    const std::string &prune_threshold_str = parser.get_option("--prune-threshold");
+    if (!prune_threshold_str.empty())
+    {
+        config.prune_threshold = std::stod(prune_threshold_str);
+        if (config.prune_threshold <= 0.0 || !sparsity_str.empty())
+        {
+            std::cerr << "Error: --prune-threshold must be positive and replaces --sparsity." << std::endl;
+            return 1;
+        }
+    }
+    const std::string &sparse_format_str = parser.get_option("--sparse-format");
+    if (sparse_format_str == "bsr")
+    {
+        config.sparse_format = SparseFormat::BSR;
+    }
+    else if (!sparse_format_str.empty() && sparse_format_str != "csr")
+    {
+        std::cerr << "Error: --sparse-format must be 'csr' or 'bsr'." << std::endl;
+        return 1;
+    }
+    const std::string &fine_tune_str = parser.get_option("--fine-tune");
+    if (!fine_tune_str.empty())
+    {
+        config.fine_tune_epochs = std::stoi(fine_tune_str);
+        if (config.fine_tune_epochs < 0)
+        {
+            std::cerr << "Error: --fine-tune must be 0 or positive." << std::endl;
+            return 1;
+        }
+    }
+
+    config.factorize_model_path = parser.get_option("--factorize");
+    config.generate_model_path = parser.get_option("--generate");
+    const std::string &rank_str = parser.get_option("--rank");
+    if (!rank_str.empty())
+    {
+        config.ranks.clear();
+        std::stringstream ss(rank_str);
+        std::string rank;
+        while (std::getline(ss, rank, ','))
+        {
+            config.ranks.push_back(std::stoi(rank));
+            if (config.ranks.back() <= 0)
+            {
+                std::cerr << "Error: --rank values must be positive." << std::endl;
+                return 1;
+            }
+        }
+    }
+    const std::string &energy_str = parser.get_option("--energy");
+    if (!energy_str.empty())
+    {
+        std::stringstream ss(energy_str);
+        std::string energy;
+        while (std::getline(ss, energy, ','))
+        {
+            config.energies.push_back(std::stod(energy));
+            if (config.energies.back() <= 0.0 || config.energies.back() > 1.0 || !rank_str.empty())
+            {
+                std::cerr << "Error: --energy values must be in (0, 1] and replace --rank." << std::endl;
+                return 1;
+            }
+        }
+    }
 
     // --- Basic validation ---
-    if (config.train == config.predict)
+    if (!config.benchmark.empty())
+    {
+        bool hogwild_benchmark = config.benchmark == "hogwild" && config.task_mode == "mnist";
+        bool task_benchmark = (config.benchmark == "static" || config.benchmark == "plan" || config.benchmark == "math" ||
+                               config.benchmark == "parallel") &&
+                              (config.task_mode == "boston" || config.task_mode == "mnist");
+        if ((!hogwild_benchmark && !task_benchmark) || config.train || config.predict)
+        {
+            std::cerr << "Error: --benchmark hogwild runs with --mode mnist and --benchmark static, plan, math or parallel with "
+                         "--mode boston or mnist, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.convert_model_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --convert takes an input model and --save <output>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.convert_dataset_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --convert-dataset takes a CSV file and --save <output>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.quantize_model_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --quantize takes a model and --save <output>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.prune_model_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --prune takes a model and --save <output>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.factorize_model_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --factorize takes a model and --save <output>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (!config.generate_model_path.empty())
+    {
+        if (config.train || config.predict || config.save_model_path.empty())
+        {
+            std::cerr << "Error: --generate takes a model and --save <header>, without --train or --predict." << std::endl;
+            return 1;
+        }
+    }
+    else if (config.train == config.predict)
     {
         std::cerr << "Error: Please specify exactly one of --train or --predict." << std::endl;
         return 1;
     }
+    if (config.checkpoint_every > 0 && (!config.train || config.checkpoint_path.empty()))
+    {
+        std::cerr << "Error: --checkpoint-every needs --train and a --checkpoint or --save path." << std::endl;
+        return 1;
+    }
+    if (config.checkpoint_every > 0 && config.hogwild)
+    {
+        // Every Hogwild thread has its own Adam state, which one checkpoint cannot resume
+        std::cerr << "Error: --checkpoint-every cannot be combined with --hogwild." << std::endl;
+        return 1;
+    }
+    if (config.processes > 1 && config.benchmark != "parallel" &&
+        (!config.train || config.hogwild || config.workers != 1))
+    {
+        std::cerr << "Error: --processes is a training mode and cannot be combined with --workers or --hogwild." << std::endl;
+        return 1;
+    }
+    if (config.pipeline_stages > 0 && config.benchmark != "parallel" &&
+        (config.processes > 1 || config.hogwild || config.workers != 1 || config.mmap_model))
+    {
+        std::cerr << "Error: --pipeline cannot be combined with --processes, --workers, --hogwild or --mmap." << std::endl;
+        return 1;
+    }
+    if (config.stream && (!config.train || config.task_mode != "mnist" || config.hogwild || config.processes > 1))
+    {
+        std::cerr << "Error: --stream trains MNIST models and cannot be combined with --hogwild or --processes." << std::endl;
+        return 1;
+    }
+    if ((config.precision != Precision::DOUBLE || config.loss_scale > 0.0) && (!config.train || config.hogwild))
+    {
+        std::cerr << "Error: --precision and --loss-scale are training options and cannot be combined with --hogwild." << std::endl;
+        return 1;
+    }
+    if (config.recompute_every > 0 &&
+        (!(config.train || config.benchmark == "plan") || config.workers != 1 || config.hogwild ||
+         config.processes > 1 || config.pipeline_stages > 0 || config.precision != Precision::DOUBLE))
+    {
+        std::cerr << "Error: --recompute applies to single-threaded double-precision training (or --benchmark plan)." << std::endl;
+        return 1;
+    }
+    if (config.precision != Precision::DOUBLE && config.pipeline_stages > 0)
+    {
+        std::cerr << "Error: --precision bf16 cannot be combined with --pipeline." << std::endl;
+        return 1;
+    }
+    if (!config.serve_path.empty() && (!config.predict || !config.output_path.empty()))
+    {
+        std::cerr << "Error: --serve runs in prediction mode and answers over the socket instead of --output." << std::endl;
+        return 1;
+    }
+    if (config.cache_mb > 0 && !config.predict)
+    {
+        std::cerr << "Error: --cache-mb is only available in prediction mode." << std::endl;
+        return 1;
+    }
+    if (!config.output_path.empty() && !config.predict)
+    {
+        std::cerr << "Error: --output is only available in prediction mode." << std::endl;
+        return 1;
+    }
+    if (config.mmap_model && !config.predict)
+    {
+        std::cerr << "Error: --mmap is only available in prediction mode." << std::endl;
+        return 1;
+    }
+    if (!config.export_model_path.empty() && !config.train)
+    {
+        std::cerr << "Error: --export is only available in training mode." << std::endl;
+        return 1;
+    }
     if (config.predict && config.load_model_path.empty())
     {
         std::cerr << "Error: Prediction mode requires a model file. Use --load <path_to_model>" << std::endl;
         return 1;
     }
 
-    run_task(config);
+    if (config.has_seed)
+    {
+        seed_global_rng(config.seed);
+    }
+
+    if (config.benchmark == "static")
+    {
+        return static_benchmark(config.task_mode, config.dataset_path, config.epochs);
+    }
+    if (config.benchmark == "plan")
+    {
+        return plan_benchmark(config.task_mode, config.dataset_path, config.epochs, config.batch_size,
+                              config.hidden_layers, config.hidden_activation, config.recompute_every);
+    }
+    if (config.benchmark == "math")
+    {
+        return math_benchmark();
+    }
+    if (config.benchmark == "parallel")
+    {
+        return parallel_benchmark(config.task_mode, config.dataset_path, config.epochs, config.workers,
+                                  config.processes, config.pipeline_stages, config.micro_batches);
+    }
+    if (!config.benchmark.empty())
+    {
+        return hogwild_benchmark(config.dataset_path.empty() ? "data/mnist_train.csv" : config.dataset_path,
+                                 config.workers, config.epochs, config.batch_size);
+    }
+
+    try {
+        run_task(config);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "math/VectorMath.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// Each function is written once over GCC vector types of N doubles, whose
+// operators act lane by lane and whose ?: selects per lane. Everything is
+// inlined into one entry point per instruction set, so the same source is
+// compiled to AVX-512, to AVX2 with FMA and to baseline code.
+// The helpers update vectors in place rather than returning them: GCC warns
+// (-Wpsabi) about a function returning a vector wider than the baseline ISA,
+// and reports it at the end of the file, where no pragma can scope it.
+#define VM_INLINE inline __attribute__((always_inline))
+
+namespace
+{
+template <int N>
+struct Lanes
+{
+    typedef double Double __attribute__((vector_size(N * sizeof(double))));
+    typedef int64_t Mask __attribute__((vector_size(N * sizeof(int64_t))));
+    typedef uint64_t Bits __attribute__((vector_size(N * sizeof(uint64_t))));
+};
+
+const double kShift = 0x1.8p52; // Adding it rounds to an integer, kept in the low bits
+const uint64_t kShiftBits = 0x4338000000000000;
+const uint64_t kSignBit = 0x8000000000000000;
+const double kInf = __builtin_inf();
+
+// n + kShift in, 2^n out, for integral n in [-1022, 1023]
+template <int N>
+VM_INLINE void pow2(typename Lanes<N>::Double &shifted)
+{
+    typedef typename Lanes<N>::Bits Bits;
+    shifted = (typename Lanes<N>::Double)(((Bits)shifted + (1023 - kShiftBits)) << 52);
+}
+
+// x = n ln2 + r with |r| <= ln2 / 2; replaces x with e^r - 1 and sets n. The
+// ln2 split (Cody-Waite) keeps r exact, and the Taylor series through r^13 is
+// within 0.02 ulp of e^r on that interval.
+template <int N>
+VM_INLINE void expm1_reduced(typename Lanes<N>::Double &x, typename Lanes<N>::Double &n)
+{
+    typedef typename Lanes<N>::Double Double;
+    const double ln2_hi = 6.93147180369123816490e-01; // 32 bits: n * ln2_hi is exact
+    const double ln2_lo = 1.90821492927058770002e-10;
+    n = (x * 1.44269504088896338700 + kShift) - kShift;
+    Double r = x - n * ln2_hi;
+    r = r - n * ln2_lo;
+
+    Double q = Double{} + 1.0 / 6227020800.0; // 1/13!
+    q = q * r + 1.0 / 479001600.0;
+    q = q * r + 1.0 / 39916800.0;
+    q = q * r + 1.0 / 3628800.0;
+    q = q * r + 1.0 / 362880.0;
+    q = q * r + 1.0 / 40320.0;
+    q = q * r + 1.0 / 5040.0;
+    q = q * r + 1.0 / 720.0;
+    q = q * r + 1.0 / 120.0;
+    q = q * r + 1.0 / 24.0;
+    q = q * r + 1.0 / 6.0;
+    q = q * r + 0.5;
+    x = r + r * r * q;
+}
+
+template <int N>
+VM_INLINE void exp_lanes(typename Lanes<N>::Double &x)
+{
+    typedef typename Lanes<N>::Double Double;
+    // Beyond these e^x is inf or 0 anyway; NaN passes both tests unchanged
+    x = x > 710.0 ? Double{} + 710.0 : x;
+    x = x < -746.0 ? Double{} - 746.0 : x;
+    Double n;
+    expm1_reduced<N>(x, n);
+    // 2^n in two factors, so that results down in the subnormal range (and the
+    // overflow to inf) come out of the multiplications correctly rounded
+    Double half = (n * 0.5 + kShift) - kShift;
+    Double low = half + kShift, high = n - half + kShift;
+    pow2<N>(low);
+    pow2<N>(high);
+    x = (1.0 + x) * low * high;
+}
+
+// tanh x = -u / (u + 2) with u = e^(-2|x|) - 1, which stays accurate as x -> 0
+template <int N>
+VM_INLINE void tanh_lanes(typename Lanes<N>::Double &x)
+{
+    typedef typename Lanes<N>::Double Double;
+    typedef typename Lanes<N>::Bits Bits;
+    Bits sign = (Bits)x & kSignBit;
+    Double p = -2.0 * (Double)((Bits)x & ~kSignBit);
+    p = p < -40.0 ? Double{} - 40.0 : p; // tanh 20 rounds to 1
+    Double n;
+    expm1_reduced<N>(p, n);
+    Double scale = n + kShift;
+    pow2<N>(scale);
+    Double u = p * scale + (scale - 1.0);
+    x = (Double)((Bits)(-u / (u + 2.0)) | sign);
+}
+
+// With e = e^-|x|: 1 / (1 + e) for x >= 0 and e / (1 + e) below, so neither
+// side overflows and tiny results keep their precision
+template <int N>
+VM_INLINE void sigmoid_lanes(typename Lanes<N>::Double &x)
+{
+    typedef typename Lanes<N>::Double Double;
+    typedef typename Lanes<N>::Bits Bits;
+    Double e = (Double)((Bits)x | kSignBit);
+    exp_lanes<N>(e);
+    Double r = 1.0 / (1.0 + e);
+    x = x < 0.0 ? e * r : r;
+}
+
+// The argument of the tanh in GELU, doubled: gelu(x) = x sigmoid(2z)
+template <int N>
+VM_INLINE void gelu_argument(typename Lanes<N>::Double &x)
+{
+    const double two_k = 2.0 * 0.7978845608028654; // 2 sqrt(2 / pi)
+    x = two_k * (x + 0.044715 * x * x * x);
+}
+
+template <int N>
+VM_INLINE void gelu_lanes(typename Lanes<N>::Double &x)
+{
+    typename Lanes<N>::Double s = x;
+    gelu_argument<N>(s);
+    sigmoid_lanes<N>(s);
+    x = x * s;
+}
+
+template <int N>
+VM_INLINE void gelu_derivative_lanes(typename Lanes<N>::Double &x)
+{
+    const double two_k = 2.0 * 0.7978845608028654;
+    typename Lanes<N>::Double s = x;
+    gelu_argument<N>(s);
+    sigmoid_lanes<N>(s);
+    x = s + x * s * (1.0 - s) * two_k * (1.0 + 3.0 * 0.044715 * x * x);
+}
+
+// Reduces x to 2^e (1 + f) with 1 + f in [sqrt(2)/2, sqrt(2)), then
+// log(1 + f) = 2 atanh(s), s = f / (2 + f), as fdlibm does (< 1 ulp)
+template <int N>
+VM_INLINE void log_lanes(typename Lanes<N>::Double &x)
+{
+    typedef typename Lanes<N>::Double Double;
+    typedef typename Lanes<N>::Bits Bits;
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+    const double Lg1 = 6.666666666666735130e-01, Lg2 = 3.999999999940941908e-01, Lg3 = 2.857142874366239149e-01,
+                 Lg4 = 2.222219843214978396e-01, Lg5 = 1.818357216161805012e-01, Lg6 = 1.531383769920937332e-01,
+                 Lg7 = 1.479819860511658591e-01;
+
+    // Subnormals are scaled into the normal range first
+    auto subnormal = x < 0x1p-1022;
+    Double scaled = subnormal ? x * 0x1p54 : x;
+    Double bias = subnormal ? Double{} - 54.0 : Double{};
+
+    // Offsetting the bits by 1 - sqrt(2)/2 makes the exponent field round the
+    // mantissa to the nearer power of two
+    Bits bits = (Bits)scaled + (0x3ff0000000000000 - 0x3fe6a09e00000000);
+    Double e = (Double)((bits >> 52) + (kShiftBits - 1023)) - kShift + bias;
+    Double f = (Double)((bits & 0x000fffffffffffff) + 0x3fe6a09e00000000) - 1.0;
+
+    Double hfsq = 0.5 * f * f;
+    Double s = f / (2.0 + f);
+    Double z = s * s;
+    Double w = z * z;
+    Double t1 = w * (Lg2 + w * (Lg4 + w * Lg6));
+    Double t2 = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7)));
+    Double r = s * (hfsq + t1 + t2) + e * ln2_lo - hfsq + f + e * ln2_hi;
+
+    r = x == kInf ? x : r;
+    r = x == 0.0 ? Double{} - kInf : r;
+    r = x < 0.0 ? Double{} + __builtin_nan("") : r;
+    x = x != x ? x : r;
+}
+
+enum class Function
+{
+    Exp,
+    Log,
+    Tanh,
+    Sigmoid,
+    Gelu,
+    GeluDerivative
+};
+
+template <int N, Function F>
+VM_INLINE void evaluate(typename Lanes<N>::Double &x)
+{
+    if constexpr (F == Function::Exp)
+        exp_lanes<N>(x);
+    else if constexpr (F == Function::Log)
+        log_lanes<N>(x);
+    else if constexpr (F == Function::Tanh)
+        tanh_lanes<N>(x);
+    else if constexpr (F == Function::Sigmoid)
+        sigmoid_lanes<N>(x);
+    else if constexpr (F == Function::Gelu)
+        gelu_lanes<N>(x);
+    else
+        gelu_derivative_lanes<N>(x);
+}
+
+template <int N, Function F>
+VM_INLINE void map_array(const double *in, double *out, size_t n)
+{
+    typedef typename Lanes<N>::Double Double;
+    size_t i = 0;
+    for (; i + N <= n; i += N)
+    {
+        Double x;
+        std::memcpy(&x, in + i, sizeof(x));
+        evaluate<N, F>(x);
+        std::memcpy(out + i, &x, sizeof(x));
+    }
+    if (i < n)
+    {
+        // The remainder goes through one padded vector
+        Double x = Double{} + 1.0;
+        std::memcpy(&x, in + i, (n - i) * sizeof(double));
+        evaluate<N, F>(x);
+        std::memcpy(out + i, &x, (n - i) * sizeof(double));
+    }
+}
+
+// The function is picked once per call, outside the loop
+template <int N>
+VM_INLINE void map(Function function, const double *in, double *out, size_t n)
+{
+    switch (function)
+    {
+    case Function::Exp:
+        return map_array<N, Function::Exp>(in, out, n);
+    case Function::Log:
+        return map_array<N, Function::Log>(in, out, n);
+    case Function::Tanh:
+        return map_array<N, Function::Tanh>(in, out, n);
+    case Function::Sigmoid:
+        return map_array<N, Function::Sigmoid>(in, out, n);
+    case Function::Gelu:
+        return map_array<N, Function::Gelu>(in, out, n);
+    case Function::GeluDerivative:
+        return map_array<N, Function::GeluDerivative>(in, out, n);
+    }
+}
+
+// Max, exponentials and their sum, then the scaling, each pass in lanes.
+// The remainder is padded with -inf, whose exponential adds nothing.
+template <int N>
+VM_INLINE void softmax_array(const double *in, double *out, size_t n)
+{
+    typedef typename Lanes<N>::Double Double;
+    const size_t full = n / N * N;
+    Double x;
+    Double largest = Double{} - kInf;
+    for (size_t i = 0; i < n; i += N)
+    {
+        x = Double{} - kInf;
+        std::memcpy(&x, in + i, (i < full ? N : n - i) * sizeof(double));
+        largest = x > largest ? x : largest;
+    }
+    double max_val = largest[0];
+    for (int lane = 1; lane < N; ++lane)
+        max_val = largest[lane] > max_val ? largest[lane] : max_val;
+
+    Double sums = {};
+    for (size_t i = 0; i < n; i += N)
+    {
+        size_t count = i < full ? N : n - i;
+        x = Double{} - kInf;
+        std::memcpy(&x, in + i, count * sizeof(double));
+        x -= max_val;
+        exp_lanes<N>(x);
+        sums += x;
+        std::memcpy(out + i, &x, count * sizeof(double));
+    }
+    double sum = 0.0;
+    for (int lane = 0; lane < N; ++lane)
+        sum += sums[lane];
+
+    const double scale = 1.0 / sum;
+    for (size_t i = 0; i < n; i += N)
+    {
+        size_t count = i < full ? N : n - i;
+        std::memcpy(&x, out + i, count * sizeof(double));
+        x *= scale;
+        std::memcpy(out + i, &x, count * sizeof(double));
+    }
+}
+
+using MapKernel = void (*)(Function function, const double *in, double *out, size_t n);
+using SoftmaxKernel = void (*)(const double *in, double *out, size_t n);
+
+// Two lanes: SSE2 on any x86-64, and whatever the target has elsewhere
+void map_generic(Function function, const double *in, double *out, size_t n)
+{
+    map<2>(function, in, out, n);
+}
+
+void softmax_generic(const double *in, double *out, size_t n)
+{
+    softmax_array<2>(in, out, n);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma"))) void map_avx2(Function function, const double *in, double *out, size_t n)
+{
+    map<4>(function, in, out, n);
+}
+
+__attribute__((target("avx2,fma"))) void softmax_avx2(const double *in, double *out, size_t n)
+{
+    softmax_array<4>(in, out, n);
+}
+
+__attribute__((target("avx512f"))) void map_avx512(Function function, const double *in, double *out, size_t n)
+{
+    map<8>(function, in, out, n);
+}
+
+__attribute__((target("avx512f"))) void softmax_avx512(const double *in, double *out, size_t n)
+{
+    softmax_array<8>(in, out, n);
+}
+#endif
+
+struct Kernel
+{
+    const char *name;
+    MapKernel map;
+    SoftmaxKernel softmax;
+};
+
+Kernel select_kernel()
+{
+    std::vector<Kernel> kernels;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        kernels.push_back({"avx512", map_avx512, softmax_avx512});
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        kernels.push_back({"avx2", map_avx2, softmax_avx2});
+#endif
+    kernels.push_back({"generic", map_generic, softmax_generic});
+
+    const char *forced = std::getenv("MLP_MATH_KERNEL");
+    if (forced == nullptr || *forced == '\0')
+        return kernels.front();
+    for (const Kernel &kernel : kernels)
+    {
+        if (std::string(kernel.name) == forced)
+            return kernel;
+    }
+    throw std::runtime_error(std::string("MLP_MATH_KERNEL=") + forced + " is not available on this CPU.");
+}
+
+const Kernel &active_kernel()
+{
+    static const Kernel kernel = select_kernel();
+    return kernel;
+}
+} // namespace
+
+#undef VM_INLINE
+
+void vector_exp(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::Exp, in, out, n);
+}
+
+void vector_log(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::Log, in, out, n);
+}
+
+void vector_tanh(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::Tanh, in, out, n);
+}
+
+void vector_sigmoid(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::Sigmoid, in, out, n);
+}
+
+void vector_gelu(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::Gelu, in, out, n);
+}
+
+void vector_gelu_derivative(const double *in, double *out, size_t n)
+{
+    active_kernel().map(Function::GeluDerivative, in, out, n);
+}
+
+void vector_softmax(const double *in, double *out, size_t n)
+{
+    active_kernel().softmax(in, out, n);
+}
+
+std::string math_kernel_name()
+{
+    return active_kernel().name;
+}
@@ -1,5 +1,6 @@
 #include "optimizers/Adam.hpp"
 #include <cmath>
+#include <stdexcept>
 
 Adam::Adam(std::vector<DenseLayer> &layers, double learning_rate,
            double beta1, double beta2, double epsilon)
@@ -16,53 +17,91 @@ Adam::Adam(std::vector<DenseLayer> &layers, double learning_rate,
     }
 }
 
-void Adam::step()
+namespace
 {
-    m_t++;
-
-    for (size_t i = 0; i < m_layers.size(); ++i)
+// One Adam update, element by element in place: no temporaries per step
+void adam_update(Matrix &parameters, const Matrix &gradients, Matrix &m, Matrix &v, double beta1, double beta2,
+                 double epsilon, double first_correction, double second_correction, double learning_rate)
+{
+    if (gradients.size() != parameters.size())
+    {
+        throw std::invalid_argument("Gradients must have the same dimensions as the parameters.");
+    }
+    double *p = parameters.data();
+    const double *g = gradients.data();
+    double *m_ptr = m.data();
+    double *v_ptr = v.data();
+    for (size_t i = 0; i < parameters.size(); ++i)
     {
-        // --- Update Weights ---
-        Matrix &weights = m_layers[i].getWeights();
-        const Matrix &d_weights = m_layers[i].getWeightsGradient();
-
         // m = beta1 * m + (1 - beta1) * g
-        m_m_weights[i] = m_m_weights[i] * m_beta1 + d_weights * (1.0 - m_beta1);
+        m_ptr[i] = m_ptr[i] * beta1 + g[i] * (1.0 - beta1);
         // v = beta2 * v + (1 - beta2) * g^2
-        Matrix d_weights_sq = d_weights;
-        d_weights_sq.element_multiply(d_weights);
-        m_v_weights[i] = m_v_weights[i] * m_beta2 + d_weights_sq * (1.0 - m_beta2);
-
-        // Bias correction
-        Matrix m_hat = m_m_weights[i] * (1.0 / (1.0 - std::pow(m_beta1, m_t)));
-        Matrix v_hat = m_v_weights[i] * (1.0 / (1.0 - std::pow(m_beta2, m_t)));
+        v_ptr[i] = v_ptr[i] * beta2 + g[i] * g[i] * (1.0 - beta2);
 
-        // v_hat_sqrt = sqrt(v_hat) + epsilon
-        v_hat.element_sqrt();
-        v_hat.map([this](double val)
-                  { return val + m_epsilon; });
-
-        // Update = m_hat / v_hat_sqrt
-        m_hat.element_divide(v_hat);
-        weights.update(m_hat, m_learning_rate);
-
-        // --- Update Biases (same logic) ---
-        Matrix &biases = m_layers[i].getBiases();
-        const Matrix &d_biases = m_layers[i].getBiasesGradient();
+        // Bias correction, then update = m_hat / (sqrt(v_hat) + epsilon)
+        double m_hat = m_ptr[i] * first_correction;
+        double v_hat = std::sqrt(v_ptr[i] * second_correction) + epsilon;
+        p[i] -= m_hat / v_hat * learning_rate;
+    }
+}
+} // namespace
 
-        m_m_biases[i] = m_m_biases[i] * m_beta1 + d_biases * (1.0 - m_beta1);
-        Matrix d_biases_sq = d_biases;
-        d_biases_sq.element_multiply(d_biases);
-        m_v_biases[i] = m_v_biases[i] * m_beta2 + d_biases_sq * (1.0 - m_beta2);
+void Adam::step()
+{
+    m_t++;
+    double first_correction = 1.0 / (1.0 - std::pow(m_beta1, m_t));
+    double second_correction = 1.0 / (1.0 - std::pow(m_beta2, m_t));
 
-        Matrix m_hat_b = m_m_biases[i] * (1.0 / (1.0 - std::pow(m_beta1, m_t)));
-        Matrix v_hat_b = m_v_biases[i] * (1.0 / (1.0 - std::pow(m_beta2, m_t)));
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        adam_update(m_layers[i].getWeights(), m_layers[i].getWeightsGradient(), m_m_weights[i], m_v_weights[i],
+                    m_beta1, m_beta2, m_epsilon, first_correction, second_correction, m_learning_rate);
+        adam_update(m_layers[i].getBiases(), m_layers[i].getBiasesGradient(), m_m_biases[i], m_v_biases[i],
+                    m_beta1, m_beta2, m_epsilon, first_correction, second_correction, m_learning_rate);
+    }
+}
 
-        v_hat_b.element_sqrt();
-        v_hat_b.map([this](double val)
-                    { return val + m_epsilon; });
+OptimizerState Adam::getState() const
+{
+    OptimizerState state;
+    state.name = "adam";
+    state.step = m_t;
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        state.tensors.push_back(m_m_weights[i]);
+        state.tensors.push_back(m_v_weights[i]);
+        state.tensors.push_back(m_m_biases[i]);
+        state.tensors.push_back(m_v_biases[i]);
+    }
+    return state;
+}
 
-        m_hat_b.element_divide(v_hat_b);
-        biases.update(m_hat_b, m_learning_rate);
+void Adam::setState(const OptimizerState &state)
+{
+    if (state.name != "adam" || state.tensors.size() != 4 * m_layers.size())
+    {
+        throw std::invalid_argument("Optimizer state '" + state.name + "' does not match this Adam optimizer.");
+    }
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        const Matrix &weights = m_layers[i].getWeights();
+        const Matrix &biases = m_layers[i].getBiases();
+        for (int k = 0; k < 4; ++k)
+        {
+            const Matrix &like = k < 2 ? weights : biases;
+            const Matrix &tensor = state.tensors[4 * i + k];
+            if (tensor.getRows() != like.getRows() || tensor.getCols() != like.getCols())
+            {
+                throw std::invalid_argument("Adam state has incorrect dimensions for layer " + std::to_string(i));
+            }
+        }
+    }
+    m_t = state.step;
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        m_m_weights[i] = state.tensors[4 * i];
+        m_v_weights[i] = state.tensors[4 * i + 1];
+        m_m_biases[i] = state.tensors[4 * i + 2];
+        m_v_biases[i] = state.tensors[4 * i + 3];
     }
 }
\ No newline at end of file
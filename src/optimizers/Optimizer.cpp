@@ -1,4 +1,18 @@
 #include "optimizers/Optimizer.hpp"
+#include <stdexcept>
 
 Optimizer::Optimizer(std::vector<DenseLayer> &layers, double learning_rate)
-    : m_layers(layers), m_learning_rate(learning_rate) {}
\ No newline at end of file
+    : m_layers(layers), m_learning_rate(learning_rate) {}
+
+OptimizerState Optimizer::getState() const
+{
+    return OptimizerState();
+}
+
+void Optimizer::setState(const OptimizerState &state)
+{
+    if (!state.tensors.empty())
+    {
+        throw std::invalid_argument("Optimizer state '" + state.name + "' does not match this optimizer.");
+    }
+}
\ No newline at end of file
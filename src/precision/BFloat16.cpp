@@ -0,0 +1,164 @@
+#include "precision/BFloat16.hpp"
+#include <cstdlib>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// Values per dot-product step; rows are padded to a multiple of it
+const size_t kBlock = 32;
+
+size_t padded(size_t value, size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Dot products of a with four consecutive rows of b, over stride values
+using Dot4Kernel = void (*)(const uint16_t *a, const uint16_t *b, size_t stride, float *out);
+
+void dot4_software(const uint16_t *a, const uint16_t *b, size_t stride, float *out)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        const uint16_t *row = b + r * stride;
+        float sum = 0.0f;
+        for (size_t k = 0; k < stride; ++k)
+        {
+            sum += from_bf16(a[k]) * from_bf16(row[k]);
+        }
+        out[r] = sum;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// vdpbf16ps: 32 bf16 products summed pairwise into 16 float32 lanes per step
+__attribute__((target("avx512bf16,avx512f"))) void dot4_avx512bf16(const uint16_t *a, const uint16_t *b,
+                                                                   size_t stride, float *out)
+{
+    __m512 acc[4] = {_mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps()};
+    for (size_t k = 0; k < stride; k += kBlock)
+    {
+        __m512bh av = (__m512bh)_mm512_loadu_si512(a + k);
+        for (int r = 0; r < 4; ++r)
+        {
+            __m512bh bv = (__m512bh)_mm512_loadu_si512(b + r * stride + k);
+            acc[r] = _mm512_dpbf16_ps(acc[r], av, bv);
+        }
+    }
+    alignas(64) float lanes[16];
+    for (int r = 0; r < 4; ++r)
+    {
+        _mm512_store_ps(lanes, acc[r]);
+        float sum = 0.0f;
+        for (float lane : lanes)
+            sum += lane;
+        out[r] = sum;
+    }
+}
+#endif
+
+struct Kernel
+{
+    const char *name;
+    Dot4Kernel dot4;
+};
+
+Kernel select_kernel()
+{
+    std::vector<Kernel> kernels;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bf16"))
+        kernels.push_back({"avx512bf16", dot4_avx512bf16});
+#endif
+    kernels.push_back({"software", dot4_software});
+
+    const char *forced = std::getenv("MLP_BF16_KERNEL");
+    if (forced == nullptr || *forced == '\0')
+        return kernels.front();
+    for (const Kernel &kernel : kernels)
+    {
+        if (std::string(kernel.name) == forced)
+            return kernel;
+    }
+    throw std::runtime_error(std::string("MLP_BF16_KERNEL=") + forced + " is not available on this CPU.");
+}
+
+const Kernel &active_kernel()
+{
+    static const Kernel kernel = select_kernel();
+    return kernel;
+}
+} // namespace
+
+BF16Matrix::BF16Matrix() : m_rows(0), m_cols(0), m_stride(0) {}
+
+void BF16Matrix::pack(const Matrix &source, bool transpose)
+{
+    m_rows = transpose ? source.getCols() : source.getRows();
+    m_cols = transpose ? source.getRows() : source.getCols();
+    m_stride = padded(static_cast<size_t>(m_cols), kBlock);
+    // assign() rather than resize(), so the padding of reused storage is zero again
+    m_data.assign(padded(static_cast<size_t>(m_rows), 4) * m_stride, 0);
+
+    const double *values = source.data();
+    int source_cols = source.getCols();
+    for (int i = 0; i < source.getRows(); ++i)
+    {
+        const double *row = values + static_cast<size_t>(i) * source_cols;
+        if (transpose)
+        {
+            for (int j = 0; j < source_cols; ++j)
+                m_data[j * m_stride + i] = to_bf16(static_cast<float>(row[j]));
+        }
+        else
+        {
+            uint16_t *out = &m_data[i * m_stride];
+            for (int j = 0; j < source_cols; ++j)
+                out[j] = to_bf16(static_cast<float>(row[j]));
+        }
+    }
+}
+
+void BF16Matrix::clear()
+{
+    m_rows = 0;
+    m_cols = 0;
+    m_stride = 0;
+    std::vector<uint16_t>().swap(m_data);
+}
+
+int BF16Matrix::getRows() const { return m_rows; }
+int BF16Matrix::getCols() const { return m_cols; }
+size_t BF16Matrix::getStride() const { return m_stride; }
+const uint16_t *BF16Matrix::row(int r) const { return m_data.data() + r * m_stride; }
+size_t BF16Matrix::bytes() const { return m_data.size() * sizeof(uint16_t); }
+
+void gemm_bf16_nt(const BF16Matrix &a, const BF16Matrix &b, Matrix &c)
+{
+    if (a.getCols() != b.getCols() || c.getRows() != a.getRows() || c.getCols() != b.getRows())
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for bfloat16 multiplication.");
+    }
+    Dot4Kernel dot4 = active_kernel().dot4;
+    int n = b.getRows();
+    float sums[4];
+    for (int i = 0; i < a.getRows(); ++i)
+    {
+        double *out = c.data() + static_cast<size_t>(i) * n;
+        for (int j = 0; j < n; j += 4)
+        {
+            // b's row count is padded to 4, so the last block reads zero rows
+            dot4(a.row(i), b.row(j), b.getStride(), sums);
+            for (int r = 0; r < 4 && j + r < n; ++r)
+                out[j + r] = sums[r];
+        }
+    }
+}
+
+std::string bf16_kernel_name()
+{
+    return active_kernel().name;
+}
@@ -0,0 +1,110 @@
+#include "precision/LossScaling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+bool all_finite(const Matrix &matrix)
+{
+    const double *values = matrix.data();
+    for (size_t i = 0; i < matrix.size(); ++i)
+    {
+        if (!std::isfinite(values[i]))
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+LossScaler::LossScaler(double initial_scale, int growth_interval)
+    : m_scale(initial_scale), m_growth_interval(growth_interval), m_good_steps(0), m_skipped(0)
+{
+    if (!(initial_scale > 0.0) || growth_interval < 1)
+    {
+        throw std::invalid_argument("Loss scale and growth interval must be positive.");
+    }
+}
+
+double LossScaler::getScale() const
+{
+    return m_scale;
+}
+
+long long LossScaler::getSkippedSteps() const
+{
+    return m_skipped;
+}
+
+bool LossScaler::unscale(std::vector<DenseLayer> &layers)
+{
+    for (DenseLayer &layer : layers)
+    {
+        if (!all_finite(layer.getWeightsGradient()) || !all_finite(layer.getBiasesGradient()))
+        {
+            m_scale = std::max(m_scale / 2.0, 1.0);
+            m_good_steps = 0;
+            ++m_skipped;
+            return false;
+        }
+    }
+
+    double inverse = 1.0 / m_scale;
+    for (DenseLayer &layer : layers)
+    {
+        Matrix &d_weights = layer.getWeightsGradient();
+        Matrix &d_biases = layer.getBiasesGradient();
+        for (size_t i = 0; i < d_weights.size(); ++i)
+            d_weights.data()[i] *= inverse;
+        for (size_t i = 0; i < d_biases.size(); ++i)
+            d_biases.data()[i] *= inverse;
+        if (layer.getRegularizer())
+        {
+            // backward() added the penalty gradient unscaled, so it was just divided too
+            Matrix penalty = layer.getRegularizer()->gradient(layer.getWeights());
+            for (size_t i = 0; i < d_weights.size(); ++i)
+                d_weights.data()[i] += penalty.data()[i] * (1.0 - inverse);
+        }
+    }
+    if (++m_good_steps >= m_growth_interval)
+    {
+        m_scale *= 2.0;
+        m_good_steps = 0;
+    }
+    return true;
+}
+
+ScaledLoss::ScaledLoss(Loss &loss, const LossScaler &scaler) : m_loss(loss), m_scaler(scaler) {}
+
+double ScaledLoss::calculate(const Matrix &y_pred, const Matrix &y_true)
+{
+    return m_loss.calculate(y_pred, y_true);
+}
+
+Matrix ScaledLoss::backward(const Matrix &y_pred, const Matrix &y_true)
+{
+    return m_loss.backward(y_pred, y_true) * m_scaler.getScale();
+}
+
+ScaledOptimizer::ScaledOptimizer(std::vector<DenseLayer> &layers, Optimizer &optimizer, LossScaler &scaler)
+    : Optimizer(layers, 0.0), m_optimizer(optimizer), m_scaler(scaler)
+{
+}
+
+void ScaledOptimizer::step()
+{
+    if (m_scaler.unscale(m_layers))
+    {
+        m_optimizer.step();
+    }
+}
+
+OptimizerState ScaledOptimizer::getState() const
+{
+    return m_optimizer.getState();
+}
+
+void ScaledOptimizer::setState(const OptimizerState &state)
+{
+    m_optimizer.setState(state);
+}
@@ -0,0 +1,156 @@
+#include "pruning/Pruning.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+// Pruning zeroes weights in place, which a read-only mapping cannot take
+void check_writable(const std::vector<DenseLayer> &layers)
+{
+    for (const DenseLayer &layer : layers)
+    {
+        if (layer.getWeights().isView())
+        {
+            throw std::runtime_error("Cannot prune a read-only memory-mapped model.");
+        }
+    }
+}
+} // namespace
+
+PruningMask PruningMask::by_sparsity(std::vector<DenseLayer> &layers, double sparsity, bool blocks)
+{
+    if (sparsity < 0.0 || sparsity >= 1.0)
+    {
+        throw std::invalid_argument("Sparsity must be in [0, 1).");
+    }
+    check_writable(layers);
+    PruningMask mask;
+    for (DenseLayer &layer : layers)
+    {
+        const Matrix &weights = layer.getWeights();
+        int rows = weights.getRows();
+        int cols = weights.getCols();
+        int step = blocks ? kSparseBlock : 1;
+        int block_rows = (rows + step - 1) / step;
+        int block_cols = (cols + step - 1) / step;
+
+        // Score of every block (a single weight without blocks): its squared L2 norm
+        std::vector<double> scores(static_cast<size_t>(block_rows) * block_cols, 0.0);
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                scores[static_cast<size_t>(i / step) * block_cols + j / step] += weights(i, j) * weights(i, j);
+            }
+        }
+
+        // Blocks scoring at or below the k-th smallest are pruned, ties broken by position
+        size_t prune = static_cast<size_t>(std::floor(sparsity * scores.size()));
+        std::vector<uint8_t> keep_block(scores.size(), 1);
+        if (prune > 0)
+        {
+            std::vector<size_t> order(scores.size());
+            for (size_t b = 0; b < order.size(); ++b)
+                order[b] = b;
+            std::nth_element(order.begin(), order.begin() + (prune - 1), order.end(), [&](size_t a, size_t b)
+                             { return scores[a] < scores[b] || (scores[a] == scores[b] && a < b); });
+            for (size_t b = 0; b < prune; ++b)
+                keep_block[order[b]] = 0;
+        }
+
+        std::vector<uint8_t> keep(static_cast<size_t>(rows) * cols);
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                keep[static_cast<size_t>(i) * cols + j] = keep_block[static_cast<size_t>(i / step) * block_cols + j / step];
+            }
+        }
+        mask.m_keep.push_back(std::move(keep));
+    }
+    mask.apply(layers);
+    return mask;
+}
+
+PruningMask PruningMask::by_threshold(std::vector<DenseLayer> &layers, double threshold)
+{
+    check_writable(layers);
+    PruningMask mask;
+    for (DenseLayer &layer : layers)
+    {
+        const Matrix &weights = layer.getWeights();
+        std::vector<uint8_t> keep(weights.size());
+        for (size_t i = 0; i < weights.size(); ++i)
+        {
+            keep[i] = std::fabs(weights.data()[i]) >= threshold;
+        }
+        mask.m_keep.push_back(std::move(keep));
+    }
+    mask.apply(layers);
+    return mask;
+}
+
+static void apply_mask(const std::vector<uint8_t> &keep, Matrix &matrix)
+{
+    if (keep.size() != matrix.size())
+    {
+        throw std::invalid_argument("Pruning mask does not match the layer's weights.");
+    }
+    double *values = matrix.data();
+    for (size_t i = 0; i < keep.size(); ++i)
+    {
+        if (!keep[i])
+            values[i] = 0.0;
+    }
+}
+
+void PruningMask::apply(std::vector<DenseLayer> &layers) const
+{
+    for (size_t l = 0; l < m_keep.size() && l < layers.size(); ++l)
+    {
+        apply_mask(m_keep[l], layers[l].getWeights());
+    }
+}
+
+void PruningMask::apply_to_gradients(std::vector<DenseLayer> &layers) const
+{
+    for (size_t l = 0; l < m_keep.size() && l < layers.size(); ++l)
+    {
+        apply_mask(m_keep[l], layers[l].getWeightsGradient());
+    }
+}
+
+double weight_sparsity(const std::vector<DenseLayer> &layers)
+{
+    size_t zeros = 0, total = 0;
+    for (const DenseLayer &layer : layers)
+    {
+        const Matrix &weights = layer.getWeights();
+        zeros += std::count(weights.data(), weights.data() + weights.size(), 0.0);
+        total += weights.size();
+    }
+    return total > 0 ? static_cast<double>(zeros) / total : 0.0;
+}
+
+MaskedOptimizer::MaskedOptimizer(std::vector<DenseLayer> &layers, Optimizer &optimizer, const PruningMask &mask)
+    : Optimizer(layers, 0.0), m_optimizer(optimizer), m_mask(mask)
+{
+}
+
+void MaskedOptimizer::step()
+{
+    m_mask.apply_to_gradients(m_layers);
+    m_optimizer.step();
+    m_mask.apply(m_layers);
+}
+
+OptimizerState MaskedOptimizer::getState() const
+{
+    return m_optimizer.getState();
+}
+
+void MaskedOptimizer::setState(const OptimizerState &state)
+{
+    m_optimizer.setState(state);
+}
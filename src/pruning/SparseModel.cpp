@@ -0,0 +1,448 @@
+#include "pruning/SparseModel.hpp"
+#include "activations/Activation.hpp"
+#include "math/VectorMath.hpp"
+#include "pruning/Pruning.hpp"
+#include "utils/Hash.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/PayloadReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+// Sparse model layout (host byte order):
+//   SparseHeader
+//   per layer: SparseLayerRecord, row_start (int32), column (int32),
+//              values (doubles), biases (outputs doubles)
+// The checksum covers everything after the header.
+namespace
+{
+const char kMagic[8] = {'M', 'L', 'P', 'S', 'P', 'R', 'S', '\0'};
+const uint32_t kVersion = 1;
+const uint32_t kEndianTag = 0x01020304;
+
+// Rows per tile: a tile's values for one input are one contiguous run
+const int kTile = 64;
+const int kBlockValues = kSparseBlock * kSparseBlock;
+
+struct SparseHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t layer_count;
+    uint32_t input_size;
+    uint64_t checksum;
+};
+static_assert(sizeof(SparseHeader) == 32, "SparseHeader layout changed");
+
+struct SparseLayerRecord
+{
+    int32_t inputs;
+    int32_t outputs;
+    char activation[24];
+    int32_t format;
+    int32_t entries; // Nonzeros (CSR) or blocks (BSR)
+};
+static_assert(sizeof(SparseLayerRecord) == 40, "SparseLayerRecord layout changed");
+
+int padded(int value)
+{
+    return (value + kSparseBlock - 1) / kSparseBlock * kSparseBlock;
+}
+
+template <typename T>
+void append(std::vector<char> &payload, const std::vector<T> &values)
+{
+    const char *bytes = reinterpret_cast<const char *>(values.data());
+    payload.insert(payload.end(), bytes, bytes + values.size() * sizeof(T));
+}
+
+template <typename T>
+void append(std::vector<char> &payload, const T &value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    payload.insert(payload.end(), bytes, bytes + sizeof(T));
+}
+} // namespace
+
+SparseModel::SparseModel() : m_input_size(0) {}
+
+SparseModel SparseModel::from_model(Model &model, const Matrix &shift, const Matrix &scale, SparseFormat format)
+{
+    if (model.getLayers().empty())
+    {
+        throw std::invalid_argument("Cannot convert an empty model.");
+    }
+    // The sparse layers take raw features, so fold the preprocessing into a copy
+    Model folded = model.snapshot();
+    folded.fold_input_transform(shift, scale);
+    std::vector<DenseLayer> &layers = folded.getLayers();
+    SparseModel sparse;
+    sparse.m_input_size = layers.front().getWeights().getRows();
+
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        const Matrix &weights = layers[l].getWeights();
+        const Matrix &biases = layers[l].getBiases();
+
+        Layer layer;
+        layer.inputs = weights.getRows();
+        layer.outputs = weights.getCols();
+        layer.activation = layers[l].getActivation()->name();
+        bool elementwise = layer.activation == "relu" || layer.activation == "linear" ||
+                           layer.activation == "sigmoid" || layer.activation == "tanh" || layer.activation == "gelu";
+        if (!elementwise && (layer.activation != "softmax" || l + 1 != layers.size()))
+        {
+            throw std::invalid_argument("Sparse inference does not support a hidden layer with activation: " +
+                                        layer.activation);
+        }
+        layer.format = format;
+        layer.biases.assign(biases.data(), biases.data() + layer.outputs);
+        layer.row_start.push_back(0);
+        if (format == SparseFormat::CSR)
+        {
+            for (int o = 0; o < layer.outputs; ++o)
+            {
+                for (int i = 0; i < layer.inputs; ++i)
+                {
+                    if (weights(i, o) != 0.0)
+                    {
+                        layer.column.push_back(i);
+                        layer.values.push_back(weights(i, o));
+                    }
+                }
+                layer.row_start.push_back(static_cast<int32_t>(layer.column.size()));
+            }
+        }
+        else
+        {
+            for (int o0 = 0; o0 < layer.outputs; o0 += kSparseBlock)
+            {
+                for (int i0 = 0; i0 < layer.inputs; i0 += kSparseBlock)
+                {
+                    double block[kBlockValues] = {};
+                    bool nonzero = false;
+                    for (int r = 0; r < kSparseBlock && o0 + r < layer.outputs; ++r)
+                    {
+                        for (int c = 0; c < kSparseBlock && i0 + c < layer.inputs; ++c)
+                        {
+                            block[r * kSparseBlock + c] = weights(i0 + c, o0 + r);
+                            nonzero = nonzero || block[r * kSparseBlock + c] != 0.0;
+                        }
+                    }
+                    if (nonzero)
+                    {
+                        layer.column.push_back(i0);
+                        layer.values.insert(layer.values.end(), block, block + kBlockValues);
+                    }
+                }
+                layer.row_start.push_back(static_cast<int32_t>(layer.column.size()));
+            }
+        }
+        sparse.m_layers.push_back(std::move(layer));
+    }
+    return sparse;
+}
+
+namespace
+{
+// y (outputs x kTile) = W x + b for a transposed tile x (inputs x kTile)
+void csr_forward(const std::vector<int32_t> &row_start, const std::vector<int32_t> &column,
+                 const std::vector<double> &values, const std::vector<double> &biases, const double *x, double *y)
+{
+    int outputs = static_cast<int>(biases.size());
+    for (int o = 0; o < outputs; ++o)
+    {
+        double out[kTile];
+        std::fill(out, out + kTile, biases[o]);
+        for (int32_t k = row_start[o]; k < row_start[o + 1]; ++k)
+        {
+            const double *in = x + static_cast<size_t>(column[k]) * kTile;
+            double weight = values[k];
+            for (int t = 0; t < kTile; ++t)
+                out[t] += weight * in[t];
+        }
+        std::copy(out, out + kTile, y + static_cast<size_t>(o) * kTile);
+    }
+}
+
+void bsr_forward(const std::vector<int32_t> &row_start, const std::vector<int32_t> &column,
+                 const std::vector<double> &values, const std::vector<double> &biases, const double *x, double *y)
+{
+    int outputs = static_cast<int>(biases.size());
+    for (int o0 = 0; o0 < outputs; o0 += kSparseBlock)
+    {
+        double out[kSparseBlock][kTile];
+        for (int r = 0; r < kSparseBlock; ++r)
+            std::fill(out[r], out[r] + kTile, o0 + r < outputs ? biases[o0 + r] : 0.0);
+        for (int32_t k = row_start[o0 / kSparseBlock]; k < row_start[o0 / kSparseBlock + 1]; ++k)
+        {
+            const double *block = &values[static_cast<size_t>(k) * kBlockValues];
+            const double *in = x + static_cast<size_t>(column[k]) * kTile;
+            for (int r = 0; r < kSparseBlock; ++r)
+            {
+                double w0 = block[r * kSparseBlock], w1 = block[r * kSparseBlock + 1];
+                double w2 = block[r * kSparseBlock + 2], w3 = block[r * kSparseBlock + 3];
+                for (int t = 0; t < kTile; ++t)
+                    out[r][t] += w0 * in[t] + w1 * in[kTile + t] + w2 * in[2 * kTile + t] + w3 * in[3 * kTile + t];
+            }
+        }
+        for (int r = 0; r < kSparseBlock && o0 + r < outputs; ++r)
+            std::copy(out[r], out[r] + kTile, y + static_cast<size_t>(o0 + r) * kTile);
+    }
+}
+
+// Hidden activations are elementwise, so the transposed tile layout does not matter
+void hidden_activation(const std::string &activation, double *values, size_t count)
+{
+    if (activation == "relu")
+    {
+        for (size_t v = 0; v < count; ++v)
+            values[v] = std::max(values[v], 0.0);
+    }
+    else if (activation == "sigmoid")
+        vector_sigmoid(values, values, count);
+    else if (activation == "tanh")
+        vector_tanh(values, values, count);
+    else if (activation == "gelu")
+        vector_gelu(values, values, count);
+}
+} // namespace
+
+Matrix SparseModel::predict(const Matrix &input) const
+{
+    if (input.getCols() != m_input_size)
+    {
+        throw std::invalid_argument("Input has " + std::to_string(input.getCols()) + " features, the model expects " +
+                                    std::to_string(m_input_size) + ".");
+    }
+    int rows = input.getRows();
+    const Layer &last = m_layers.back();
+    Matrix output(rows, last.outputs);
+
+    size_t width = static_cast<size_t>(padded(m_input_size));
+    for (const Layer &layer : m_layers)
+    {
+        width = std::max(width, static_cast<size_t>(padded(layer.outputs)));
+    }
+    int tiles = (rows + kTile - 1) / kTile;
+
+    parallel_for_chunks(tiles, parallel_chunk_count(tiles, 1), [&](int, int begin, int end)
+                        {
+        std::vector<double> current(width * kTile), next(width * kTile);
+        for (int tile = begin; tile < end; ++tile)
+        {
+            int first = tile * kTile;
+            int count = std::min(kTile, rows - first);
+            std::fill(current.begin(), current.end(), 0.0);
+            for (int t = 0; t < count; ++t)
+            {
+                const double *x = input.data() + static_cast<size_t>(first + t) * m_input_size;
+                for (int i = 0; i < m_input_size; ++i)
+                    current[static_cast<size_t>(i) * kTile + t] = x[i];
+            }
+            for (const Layer &layer : m_layers)
+            {
+                // Blocks may reach past the last input: those rows must be zero
+                std::fill(current.begin() + static_cast<size_t>(layer.inputs) * kTile,
+                          current.begin() + static_cast<size_t>(padded(layer.inputs)) * kTile, 0.0);
+                if (layer.format == SparseFormat::CSR)
+                    csr_forward(layer.row_start, layer.column, layer.values, layer.biases, current.data(), next.data());
+                else
+                    bsr_forward(layer.row_start, layer.column, layer.values, layer.biases, current.data(), next.data());
+                if (&layer != &last)
+                    hidden_activation(layer.activation, next.data(), static_cast<size_t>(layer.outputs) * kTile);
+                current.swap(next);
+            }
+            for (int t = 0; t < count; ++t)
+            {
+                double *y = output.data() + static_cast<size_t>(first + t) * last.outputs;
+                for (int o = 0; o < last.outputs; ++o)
+                    y[o] = current[static_cast<size_t>(o) * kTile + t];
+            }
+        } });
+
+    if (last.activation != "linear")
+    {
+        output = Activation::create(last.activation)->forward(output);
+    }
+    return output;
+}
+
+std::vector<char> SparseModel::serialize() const
+{
+    std::vector<char> payload;
+    for (const Layer &layer : m_layers)
+    {
+        SparseLayerRecord record = {};
+        record.inputs = layer.inputs;
+        record.outputs = layer.outputs;
+        std::strncpy(record.activation, layer.activation.c_str(), sizeof(record.activation) - 1);
+        record.format = static_cast<int32_t>(layer.format);
+        record.entries = static_cast<int32_t>(layer.column.size());
+        append(payload, record);
+        append(payload, layer.row_start);
+        append(payload, layer.column);
+        append(payload, layer.values);
+        append(payload, layer.biases);
+    }
+    return payload;
+}
+
+void SparseModel::deserialize(const std::vector<char> &payload)
+{
+    PayloadReader reader(payload, "Sparse model");
+    int inputs = m_input_size;
+    for (Layer &layer : m_layers)
+    {
+        SparseLayerRecord record;
+        reader.read(&record, 1);
+        record.activation[sizeof(record.activation) - 1] = '\0';
+        if (record.inputs != inputs || record.outputs < 1 || record.entries < 0 ||
+            (record.format != static_cast<int32_t>(SparseFormat::CSR) &&
+             record.format != static_cast<int32_t>(SparseFormat::BSR)))
+        {
+            throw std::runtime_error("Sparse model file has an inconsistent layer.");
+        }
+        layer.inputs = record.inputs;
+        layer.outputs = record.outputs;
+        layer.activation = record.activation;
+        Activation::create(layer.activation); // Rejects unknown names
+        layer.format = static_cast<SparseFormat>(record.format);
+
+        bool blocks = layer.format == SparseFormat::BSR;
+        int row_count = blocks ? padded(layer.outputs) / kSparseBlock : layer.outputs;
+        layer.row_start.resize(row_count + 1);
+        layer.column.resize(record.entries);
+        layer.values.resize(static_cast<size_t>(record.entries) * (blocks ? kBlockValues : 1));
+        layer.biases.resize(layer.outputs);
+        reader.read(layer.row_start.data(), layer.row_start.size());
+        reader.read(layer.column.data(), layer.column.size());
+        reader.read(layer.values.data(), layer.values.size());
+        reader.read(layer.biases.data(), layer.biases.size());
+
+        // Indices are trusted by the kernels, so check them all here
+        if (layer.row_start.front() != 0 || layer.row_start.back() != record.entries ||
+            !std::is_sorted(layer.row_start.begin(), layer.row_start.end()))
+        {
+            throw std::runtime_error("Sparse model file has inconsistent row offsets.");
+        }
+        for (int32_t column : layer.column)
+        {
+            if (column < 0 || column >= layer.inputs || (blocks && column % kSparseBlock != 0))
+            {
+                throw std::runtime_error("Sparse model file has an out-of-range column.");
+            }
+        }
+        inputs = layer.outputs;
+    }
+    if (!reader.done())
+    {
+        throw std::runtime_error("Sparse model file has trailing data.");
+    }
+}
+
+void SparseModel::save(const std::string &filename) const
+{
+    std::vector<char> payload = serialize();
+    SparseHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.layer_count = static_cast<uint32_t>(m_layers.size());
+    header.input_size = static_cast<uint32_t>(m_input_size);
+    header.checksum = hash_bytes(payload.data(), payload.size());
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file)
+    {
+        throw std::runtime_error("Could not write sparse model: " + filename);
+    }
+}
+
+SparseModel SparseModel::from_file(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Could not open sparse model: " + filename);
+    }
+    SparseHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    {
+        throw std::runtime_error("Not a sparse model file: " + filename);
+    }
+    if (header.endian_tag != kEndianTag)
+    {
+        throw std::runtime_error("Sparse model was written on a machine with a different byte order: " + filename);
+    }
+    if (header.version != kVersion)
+    {
+        throw std::runtime_error("Unsupported sparse model version " + std::to_string(header.version) + ": " + filename);
+    }
+    if (header.layer_count == 0 || header.input_size == 0)
+    {
+        throw std::runtime_error("Sparse model file has no layers: " + filename);
+    }
+    std::vector<char> payload((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (hash_bytes(payload.data(), payload.size()) != header.checksum)
+    {
+        throw std::runtime_error("Sparse model checksum mismatch: " + filename);
+    }
+
+    SparseModel model;
+    model.m_input_size = static_cast<int>(header.input_size);
+    model.m_layers.resize(header.layer_count);
+    model.deserialize(payload);
+    return model;
+}
+
+bool SparseModel::is_sparse_file(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+int SparseModel::getInputSize() const
+{
+    return m_input_size;
+}
+
+int SparseModel::getOutputSize() const
+{
+    return m_layers.back().outputs;
+}
+
+size_t SparseModel::parameter_bytes() const
+{
+    size_t bytes = 0;
+    for (const Layer &layer : m_layers)
+    {
+        bytes += (layer.row_start.size() + layer.column.size()) * sizeof(int32_t) +
+                 (layer.values.size() + layer.biases.size()) * sizeof(double);
+    }
+    return bytes;
+}
+
+double SparseModel::density() const
+{
+    size_t stored = 0, dense = 0;
+    for (const Layer &layer : m_layers)
+    {
+        stored += layer.values.size();
+        dense += static_cast<size_t>(layer.inputs) * layer.outputs;
+    }
+    return dense > 0 ? static_cast<double>(stored) / dense : 0.0;
+}
+
+uint64_t SparseModel::fingerprint() const
+{
+    std::vector<char> payload = serialize();
+    return hash_bytes(payload.data(), payload.size());
+}
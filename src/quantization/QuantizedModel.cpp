@@ -0,0 +1,523 @@
+#include "quantization/QuantizedModel.hpp"
+#include "activations/Activation.hpp"
+#include "utils/Hash.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/PayloadReader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Quantized model layout (host byte order):
+//   QuantizedHeader
+//   input_mul, input_add (input_size floats each)
+//   per layer: QuantizedLayerRecord, multiplier and offset (outputs floats each),
+//              weights (outputs x inputs int8, output-major)
+// The checksum covers everything after the header.
+namespace
+{
+const char kMagic[8] = {'M', 'L', 'P', 'Q', '8', '\0', '\0', '\0'};
+const uint32_t kVersion = 1;
+const uint32_t kEndianTag = 0x01020304;
+
+// Largest quantized activation: 7 bits, see the class comment
+const int kMaxActivation = 127;
+const int kMaxWeight = 127;
+// Bytes of one kernel step; layer inputs are padded to a multiple of it
+const int kKernelWidth = 32;
+// Rows below which another prediction thread is not worth starting
+const int kMinRowsPerThread = 64;
+
+struct QuantizedHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t layer_count;
+    uint32_t input_size;
+    uint64_t checksum;
+};
+static_assert(sizeof(QuantizedHeader) == 32, "QuantizedHeader layout changed");
+
+struct QuantizedLayerRecord
+{
+    int32_t inputs;
+    int32_t outputs;
+    char activation[24];
+    int32_t clamp_low;
+    int32_t reserved;
+};
+static_assert(sizeof(QuantizedLayerRecord) == 40, "QuantizedLayerRecord layout changed");
+
+int round_up(int value, int multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Affine quantization of a range: value = scale * (q - zero_point), q in [0, 127].
+// The range is widened to include 0 so that 0 (ReLU's floor, the padding) is exact.
+struct TensorQuantization
+{
+    double scale;
+    int zero_point;
+};
+
+TensorQuantization quantization_for(double low, double high)
+{
+    low = std::min(low, 0.0);
+    high = std::max(high, 0.0);
+    double scale = (high - low) / kMaxActivation;
+    if (scale <= 0.0)
+        scale = 1.0;
+    int zero_point = static_cast<int>(std::lround(-low / scale));
+    return {scale, std::min(std::max(zero_point, 0), kMaxActivation)};
+}
+
+TensorQuantization calibrate(const Matrix &values)
+{
+    const double *data = values.data();
+    size_t count = static_cast<size_t>(values.getRows()) * values.getCols();
+    if (count == 0)
+        return quantization_for(0.0, 0.0);
+    auto range = std::minmax_element(data, data + count);
+    return quantization_for(*range.first, *range.second);
+}
+
+uint8_t quantize_value(float value, int low)
+{
+    value = std::min(std::max(value, static_cast<float>(low)), static_cast<float>(kMaxActivation));
+    return static_cast<uint8_t>(std::lrintf(value));
+}
+
+// Dot products of x with four consecutive weight rows, over stride bytes
+using Dot4Kernel = void (*)(const uint8_t *x, const int8_t *w, size_t stride, int32_t *out);
+
+void dot4_scalar(const uint8_t *x, const int8_t *w, size_t stride, int32_t *out)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        const int8_t *row = w + r * stride;
+        int32_t sum = 0;
+        for (size_t i = 0; i < stride; ++i)
+        {
+            sum += static_cast<int32_t>(x[i]) * row[i];
+        }
+        out[r] = sum;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Horizontal sums of four int32 vectors, stored as out[0..3]
+__attribute__((target("avx2"))) inline void store_sums(__m256i a, __m256i b, __m256i c, __m256i d, int32_t *out)
+{
+    __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(a, b), _mm256_hadd_epi32(c, d));
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), total);
+}
+
+// u8 x s8 pairs summed to 16 bits (cannot saturate with 7-bit activations),
+// then widened to 32 bits by a multiply-add with ones
+__attribute__((target("avx2"))) void dot4_avx2(const uint8_t *x, const int8_t *w, size_t stride, int32_t *out)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    for (size_t i = 0; i < stride; i += kKernelWidth)
+    {
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+        for (int r = 0; r < 4; ++r)
+        {
+            __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + r * stride + i));
+            acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(_mm256_maddubs_epi16(xv, wv), ones));
+        }
+    }
+    store_sums(acc[0], acc[1], acc[2], acc[3], out);
+}
+
+// VNNI: four u8 x s8 products accumulated into each int32 lane in one instruction
+__attribute__((target("avx512vnni,avx512vl"))) void dot4_vnni(const uint8_t *x, const int8_t *w, size_t stride,
+                                                              int32_t *out)
+{
+    __m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    for (size_t i = 0; i < stride; i += kKernelWidth)
+    {
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+        for (int r = 0; r < 4; ++r)
+        {
+            __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + r * stride + i));
+            acc[r] = _mm256_dpbusd_epi32(acc[r], xv, wv);
+        }
+    }
+    store_sums(acc[0], acc[1], acc[2], acc[3], out);
+}
+#endif
+
+struct Kernel
+{
+    const char *name;
+    Dot4Kernel dot4;
+};
+
+// Kernels this CPU can run, fastest first
+std::vector<Kernel> supported_kernels()
+{
+    std::vector<Kernel> kernels;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl"))
+        kernels.push_back({"vnni", dot4_vnni});
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({"avx2", dot4_avx2});
+#endif
+    kernels.push_back({"scalar", dot4_scalar});
+    return kernels;
+}
+
+Kernel select_kernel()
+{
+    std::vector<Kernel> kernels = supported_kernels();
+    const char *forced = std::getenv("MLP_INT8_KERNEL");
+    if (forced == nullptr || *forced == '\0')
+        return kernels.front();
+    for (const Kernel &kernel : kernels)
+    {
+        if (std::strcmp(kernel.name, forced) == 0)
+            return kernel;
+    }
+    throw std::runtime_error(std::string("MLP_INT8_KERNEL=") + forced + " is not available on this CPU.");
+}
+
+const Kernel &active_kernel()
+{
+    static const Kernel kernel = select_kernel();
+    return kernel;
+}
+
+template <typename T>
+void append(std::vector<char> &payload, const T *values, size_t count)
+{
+    const char *bytes = reinterpret_cast<const char *>(values);
+    payload.insert(payload.end(), bytes, bytes + count * sizeof(T));
+}
+} // namespace
+
+QuantizedModel::QuantizedModel() : m_input_size(0) {}
+
+QuantizedModel QuantizedModel::quantize(Model &model, const Matrix &calibration, const Matrix &shift,
+                                        const Matrix &scale)
+{
+    std::vector<DenseLayer> &layers = model.getLayers();
+    if (layers.empty())
+    {
+        throw std::invalid_argument("Cannot quantize an empty model.");
+    }
+    int input_size = layers.front().getWeights().getRows();
+    if (calibration.getRows() == 0 || calibration.getCols() != input_size || shift.getCols() != input_size ||
+        scale.getCols() != input_size)
+    {
+        throw std::invalid_argument("Calibration data does not match the model's input size.");
+    }
+
+    // Layer inputs on the calibration sample, as the double model computes them
+    Matrix activations = calibration;
+    for (int i = 0; i < activations.getRows(); ++i)
+    {
+        for (int j = 0; j < input_size; ++j)
+        {
+            activations(i, j) = (activations(i, j) - shift(0, j)) * scale(0, j);
+        }
+    }
+
+    QuantizedModel quantized;
+    quantized.m_input_size = input_size;
+    TensorQuantization input = calibrate(activations);
+    quantized.m_input_mul.resize(input_size);
+    quantized.m_input_add.resize(input_size);
+    for (int j = 0; j < input_size; ++j)
+    {
+        // q = x' / s + z with x' = (x - shift) * scale
+        double mul = scale(0, j) / input.scale;
+        quantized.m_input_mul[j] = static_cast<float>(mul);
+        quantized.m_input_add[j] = static_cast<float>(input.zero_point - shift(0, j) * mul);
+    }
+
+    for (size_t l = 0; l < layers.size(); ++l)
+    {
+        DenseLayer &dense = layers[l];
+        const Matrix &weights = dense.getWeights();
+        const Matrix &biases = dense.getBiases();
+        bool last = l + 1 == layers.size();
+
+        Layer layer;
+        layer.inputs = weights.getRows();
+        layer.outputs = weights.getCols();
+        layer.stride = round_up(layer.inputs, kKernelWidth);
+        layer.activation = dense.getActivation()->name();
+        // The output layer's activation runs in double precision, so any will do
+        if (!last && layer.activation != "relu" && layer.activation != "linear")
+        {
+            throw std::invalid_argument("Cannot quantize a hidden layer with activation: " + layer.activation);
+        }
+        layer.weights.assign(static_cast<size_t>(round_up(layer.outputs, 4)) * layer.stride, 0);
+        layer.multiplier.resize(layer.outputs);
+        layer.offset.resize(layer.outputs);
+        layer.clamp_low = 0;
+
+        activations = dense.forward(activations);
+        TensorQuantization next = last ? TensorQuantization{1.0, 0} : calibrate(activations);
+        if (!last && layer.activation == "relu")
+            layer.clamp_low = next.zero_point;
+
+        for (int o = 0; o < layer.outputs; ++o)
+        {
+            double max_abs = 0.0;
+            for (int i = 0; i < layer.inputs; ++i)
+                max_abs = std::max(max_abs, std::fabs(weights(i, o)));
+            double weight_scale = max_abs > 0.0 ? max_abs / kMaxWeight : 1.0;
+
+            int8_t *row = &layer.weights[static_cast<size_t>(o) * layer.stride];
+            long long row_sum = 0;
+            for (int i = 0; i < layer.inputs; ++i)
+            {
+                row[i] = static_cast<int8_t>(std::lround(weights(i, o) / weight_scale));
+                row_sum += row[i];
+            }
+            // y = s_in * s_w * (acc - z_in * sum(w_q)) + b, then requantized for the next layer
+            double multiplier = input.scale * weight_scale;
+            double offset = biases(0, o) - multiplier * input.zero_point * row_sum;
+            layer.multiplier[o] = static_cast<float>(multiplier / next.scale);
+            layer.offset[o] = static_cast<float>(offset / next.scale + next.zero_point);
+        }
+        quantized.m_layers.push_back(std::move(layer));
+        input = next;
+    }
+    return quantized;
+}
+
+Matrix QuantizedModel::predict(const Matrix &input) const
+{
+    if (input.getCols() != m_input_size)
+    {
+        throw std::invalid_argument("Input has " + std::to_string(input.getCols()) + " features, the model expects " +
+                                    std::to_string(m_input_size) + ".");
+    }
+    int rows = input.getRows();
+    const Layer &last = m_layers.back();
+    Matrix output(rows, last.outputs);
+
+    size_t width = 0;
+    size_t outputs = 0;
+    for (const Layer &layer : m_layers)
+    {
+        width = std::max(width, static_cast<size_t>(std::max(layer.stride, round_up(layer.outputs, kKernelWidth))));
+        outputs = std::max(outputs, static_cast<size_t>(round_up(layer.outputs, 4)));
+    }
+    Dot4Kernel dot4 = active_kernel().dot4;
+
+    parallel_for_chunks(rows, parallel_chunk_count(rows, kMinRowsPerThread), [&](int, int begin, int end)
+                        {
+        // Padding past a layer's inputs may hold stale values; its weights are zero
+        std::vector<uint8_t> current(width, 0), next(width, 0);
+        std::vector<int32_t> acc(outputs);
+        for (int r = begin; r < end; ++r)
+        {
+            const double *x = input.data() + static_cast<size_t>(r) * m_input_size;
+            for (int j = 0; j < m_input_size; ++j)
+            {
+                current[j] = quantize_value(static_cast<float>(x[j]) * m_input_mul[j] + m_input_add[j], 0);
+            }
+            for (size_t l = 0; l < m_layers.size(); ++l)
+            {
+                const Layer &layer = m_layers[l];
+                for (int o = 0; o < layer.outputs; o += 4)
+                {
+                    dot4(current.data(), &layer.weights[static_cast<size_t>(o) * layer.stride], layer.stride, &acc[o]);
+                }
+                if (&layer == &last)
+                {
+                    double *y = output.data() + static_cast<size_t>(r) * last.outputs;
+                    for (int o = 0; o < layer.outputs; ++o)
+                        y[o] = static_cast<float>(acc[o]) * layer.multiplier[o] + layer.offset[o];
+                    break;
+                }
+                // Fused bias, ReLU and requantization
+                for (int o = 0; o < layer.outputs; ++o)
+                {
+                    next[o] = quantize_value(static_cast<float>(acc[o]) * layer.multiplier[o] + layer.offset[o],
+                                             layer.clamp_low);
+                }
+                current.swap(next);
+            }
+        } });
+
+    if (last.activation != "linear")
+    {
+        output = Activation::create(last.activation)->forward(output);
+    }
+    return output;
+}
+
+std::vector<char> QuantizedModel::serialize() const
+{
+    std::vector<char> payload;
+    append(payload, m_input_mul.data(), m_input_mul.size());
+    append(payload, m_input_add.data(), m_input_add.size());
+    for (const Layer &layer : m_layers)
+    {
+        QuantizedLayerRecord record = {};
+        record.inputs = layer.inputs;
+        record.outputs = layer.outputs;
+        std::strncpy(record.activation, layer.activation.c_str(), sizeof(record.activation) - 1);
+        record.clamp_low = layer.clamp_low;
+        append(payload, &record, 1);
+        append(payload, layer.multiplier.data(), layer.multiplier.size());
+        append(payload, layer.offset.data(), layer.offset.size());
+        for (int o = 0; o < layer.outputs; ++o)
+        {
+            append(payload, &layer.weights[static_cast<size_t>(o) * layer.stride], layer.inputs);
+        }
+    }
+    return payload;
+}
+
+void QuantizedModel::deserialize(const std::vector<char> &payload)
+{
+    PayloadReader reader(payload, "Quantized model");
+    m_input_mul.resize(m_input_size);
+    m_input_add.resize(m_input_size);
+    reader.read(m_input_mul.data(), m_input_mul.size());
+    reader.read(m_input_add.data(), m_input_add.size());
+    int inputs = m_input_size;
+    for (Layer &layer : m_layers)
+    {
+        QuantizedLayerRecord record;
+        reader.read(&record, 1);
+        record.activation[sizeof(record.activation) - 1] = '\0';
+        if (record.inputs != inputs || record.outputs < 1 || record.clamp_low < 0 || record.clamp_low > kMaxActivation)
+        {
+            throw std::runtime_error("Quantized model file has an inconsistent layer.");
+        }
+        layer.inputs = record.inputs;
+        layer.outputs = record.outputs;
+        layer.stride = round_up(layer.inputs, kKernelWidth);
+        layer.activation = record.activation;
+        Activation::create(layer.activation); // Rejects unknown names
+        layer.clamp_low = record.clamp_low;
+        layer.multiplier.resize(layer.outputs);
+        layer.offset.resize(layer.outputs);
+        reader.read(layer.multiplier.data(), layer.multiplier.size());
+        reader.read(layer.offset.data(), layer.offset.size());
+        layer.weights.assign(static_cast<size_t>(round_up(layer.outputs, 4)) * layer.stride, 0);
+        for (int o = 0; o < layer.outputs; ++o)
+        {
+            reader.read(&layer.weights[static_cast<size_t>(o) * layer.stride], layer.inputs);
+        }
+        inputs = layer.outputs;
+    }
+    if (!reader.done())
+    {
+        throw std::runtime_error("Quantized model file has trailing data.");
+    }
+}
+
+void QuantizedModel::save(const std::string &filename) const
+{
+    std::vector<char> payload = serialize();
+    QuantizedHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.layer_count = static_cast<uint32_t>(m_layers.size());
+    header.input_size = static_cast<uint32_t>(m_input_size);
+    header.checksum = hash_bytes(payload.data(), payload.size());
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file)
+    {
+        throw std::runtime_error("Could not write quantized model: " + filename);
+    }
+}
+
+QuantizedModel QuantizedModel::from_file(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Could not open quantized model: " + filename);
+    }
+    QuantizedHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    {
+        throw std::runtime_error("Not a quantized model file: " + filename);
+    }
+    if (header.endian_tag != kEndianTag)
+    {
+        throw std::runtime_error("Quantized model was written on a machine with a different byte order: " + filename);
+    }
+    if (header.version != kVersion)
+    {
+        throw std::runtime_error("Unsupported quantized model version " + std::to_string(header.version) + ": " +
+                                 filename);
+    }
+    if (header.layer_count == 0 || header.input_size == 0)
+    {
+        throw std::runtime_error("Quantized model file has no layers: " + filename);
+    }
+    std::vector<char> payload((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (hash_bytes(payload.data(), payload.size()) != header.checksum)
+    {
+        throw std::runtime_error("Quantized model checksum mismatch: " + filename);
+    }
+
+    QuantizedModel model;
+    model.m_input_size = static_cast<int>(header.input_size);
+    model.m_layers.resize(header.layer_count);
+    model.deserialize(payload);
+    return model;
+}
+
+bool QuantizedModel::is_quantized_file(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+int QuantizedModel::getInputSize() const
+{
+    return m_input_size;
+}
+
+int QuantizedModel::getOutputSize() const
+{
+    return m_layers.back().outputs;
+}
+
+size_t QuantizedModel::parameter_bytes() const
+{
+    size_t bytes = (m_input_mul.size() + m_input_add.size()) * sizeof(float);
+    for (const Layer &layer : m_layers)
+    {
+        bytes += static_cast<size_t>(layer.inputs) * layer.outputs + 2 * layer.outputs * sizeof(float);
+    }
+    return bytes;
+}
+
+uint64_t QuantizedModel::fingerprint() const
+{
+    std::vector<char> payload = serialize();
+    return hash_bytes(payload.data(), payload.size());
+}
+
+std::string QuantizedModel::kernel_name()
+{
+    return active_kernel().name;
+}
@@ -45,4 +45,24 @@ Matrix ElasticNetRegularizer::gradient(const Matrix &weights)
     Matrix l2_grad = weights * m_lambda2;
 
     return l1_grad + l2_grad;
+}
+
+void ElasticNetRegularizer::add_gradient(const Matrix &weights, Matrix &gradient)
+{
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        double w = weights.data()[i];
+        double l1 = w > 0 ? m_lambda1 : (w < 0 ? -m_lambda1 : 0.0);
+        gradient.data()[i] += l1 + w * m_lambda2;
+    }
+}
+
+std::string ElasticNetRegularizer::name() const
+{
+    return "elasticnet";
+}
+
+std::vector<double> ElasticNetRegularizer::parameters() const
+{
+    return {m_lambda1, m_lambda2};
 }
\ No newline at end of file
@@ -25,4 +25,23 @@ Matrix L1Regularizer::gradient(const Matrix &weights)
         if (w < 0) return -m_lambda;
         return 0.0; });
     return grad;
+}
+
+void L1Regularizer::add_gradient(const Matrix &weights, Matrix &gradient)
+{
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        double w = weights.data()[i];
+        gradient.data()[i] += w > 0 ? m_lambda : (w < 0 ? -m_lambda : 0.0);
+    }
+}
+
+std::string L1Regularizer::name() const
+{
+    return "l1";
+}
+
+std::vector<double> L1Regularizer::parameters() const
+{
+    return {m_lambda};
 }
\ No newline at end of file
@@ -20,4 +20,22 @@ Matrix L2Regularizer::gradient(const Matrix &weights)
 {
     // Gradient is lambda * weights
     return weights * m_lambda;
+}
+
+void L2Regularizer::add_gradient(const Matrix &weights, Matrix &gradient)
+{
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        gradient.data()[i] += weights.data()[i] * m_lambda;
+    }
+}
+
+std::string L2Regularizer::name() const
+{
+    return "l2";
+}
+
+std::vector<double> L2Regularizer::parameters() const
+{
+    return {m_lambda};
 }
\ No newline at end of file
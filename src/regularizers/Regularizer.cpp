@@ -0,0 +1,33 @@
+#include "regularizers/Regularizer.hpp"
+#include "regularizers/L1Regularizer.hpp"
+#include "regularizers/L2Regularizer.hpp"
+#include "regularizers/ElasticNetRegularizer.hpp"
+#include <stdexcept>
+
+void Regularizer::add_gradient(const Matrix &weights, Matrix &gradient)
+{
+    Matrix penalty = this->gradient(weights);
+    for (size_t i = 0; i < gradient.size(); ++i)
+    {
+        gradient.data()[i] += penalty.data()[i];
+    }
+}
+
+std::shared_ptr<Regularizer> Regularizer::create(const std::string &name, const std::vector<double> &parameters)
+{
+    if (name == "none" || name.empty())
+        return nullptr;
+
+    size_t expected = name == "elasticnet" ? 2 : 1;
+    if (parameters.size() != expected)
+    {
+        throw std::invalid_argument("Regularizer '" + name + "' expects " + std::to_string(expected) + " parameter(s).");
+    }
+    if (name == "l1")
+        return std::make_shared<L1Regularizer>(parameters[0]);
+    if (name == "l2")
+        return std::make_shared<L2Regularizer>(parameters[0]);
+    if (name == "elasticnet")
+        return std::make_shared<ElasticNetRegularizer>(parameters[0], parameters[1]);
+    throw std::invalid_argument("Unknown regularizer: " + name);
+}
@@ -0,0 +1,367 @@
+#include "serving/InferenceServer.hpp"
+#include "utils/BoundedQueue.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+// Latency samples kept for percentiles: the most recent requests only
+const size_t kLatencyWindow = 65536;
+// Replies a connection may have outstanding before its reader waits
+const size_t kMaxInFlight = 4096;
+// How often the accept loop checks for stop()
+const int kPollIntervalMs = 200;
+
+std::future<std::string> ready_reply(std::string text)
+{
+    std::promise<std::string> reply;
+    reply.set_value(std::move(text));
+    return reply.get_future();
+}
+
+bool send_all(int fd, const std::string &text)
+{
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+double percentile(std::vector<double> samples, double q)
+{
+    if (samples.empty())
+        return 0.0;
+    size_t k = static_cast<size_t>(q * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+} // namespace
+
+InferenceServer::InferenceServer(ChunkInference infer, int input_size, int max_batch, double max_latency_ms)
+    : m_infer(std::move(infer)), m_input_size(input_size), m_max_batch(static_cast<size_t>(std::max(1, max_batch))),
+      m_max_latency(static_cast<long long>(std::max(0.0, max_latency_ms) * 1000.0)), m_closing(false),
+      m_stop_requested(false), m_next_sample(0), m_requests(0), m_batches(0)
+{
+    if (input_size < 1)
+    {
+        throw std::invalid_argument("Inference server needs a positive input size.");
+    }
+    m_batcher = std::thread(&InferenceServer::batch_loop, this);
+}
+
+InferenceServer::~InferenceServer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_cv.notify_all();
+    m_batcher.join();
+}
+
+void InferenceServer::stop()
+{
+    m_stop_requested.store(true);
+}
+
+std::future<std::string> InferenceServer::submit(std::vector<double> features)
+{
+    std::unique_ptr<Request> request(new Request);
+    request->features = std::move(features);
+    request->arrived = std::chrono::steady_clock::now();
+    std::future<std::string> reply = request->reply.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(request));
+    }
+    m_cv.notify_one();
+    return reply;
+}
+
+void InferenceServer::batch_loop()
+{
+    for (;;)
+    {
+        std::vector<std::unique_ptr<Request>> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                      { return !m_pending.empty() || m_closing; });
+            if (m_pending.empty())
+                return;
+            // Coalesce: the oldest request waits at most m_max_latency for company
+            auto deadline = m_pending.front()->arrived + m_max_latency;
+            m_cv.wait_until(lock, deadline, [this]()
+                            { return m_pending.size() >= m_max_batch || m_closing; });
+            size_t count = std::min(m_pending.size(), m_max_batch);
+            for (size_t i = 0; i < count; ++i)
+            {
+                batch.push_back(std::move(m_pending.front()));
+                m_pending.pop_front();
+            }
+        }
+        run_batch(batch);
+    }
+}
+
+void InferenceServer::run_batch(std::vector<std::unique_ptr<Request>> &batch)
+{
+    auto start = std::chrono::steady_clock::now();
+    int rows = static_cast<int>(batch.size());
+    std::vector<std::string> replies(rows);
+    try
+    {
+        Matrix features(rows, m_input_size);
+        for (int i = 0; i < rows; ++i)
+        {
+            std::copy(batch[i]->features.begin(), batch[i]->features.end(),
+                      features.data() + static_cast<size_t>(i) * m_input_size);
+        }
+        Matrix output = m_infer(features);
+        if (output.getRows() != rows)
+        {
+            throw std::runtime_error("Inference returned the wrong number of rows.");
+        }
+        char cell[32];
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < output.getCols(); ++j)
+            {
+                if (j)
+                    replies[i].push_back(',');
+                char *end = std::to_chars(cell, cell + sizeof(cell), output(i, j)).ptr;
+                replies[i].append(cell, end);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fill(replies.begin(), replies.end(), std::string("error: ") + e.what());
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double compute_ms = elapsed_ms(start, finish);
+    for (int i = 0; i < rows; ++i)
+    {
+        record(elapsed_ms(batch[i]->arrived, start), compute_ms);
+        batch[i]->reply.set_value(std::move(replies[i]));
+    }
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    ++m_batches;
+}
+
+void InferenceServer::record(double queue_ms, double compute_ms)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    if (m_queue_ms.size() < kLatencyWindow)
+    {
+        m_queue_ms.push_back(queue_ms);
+        m_compute_ms.push_back(compute_ms);
+    }
+    else
+    {
+        m_queue_ms[m_next_sample] = queue_ms;
+        m_compute_ms[m_next_sample] = compute_ms;
+    }
+    m_next_sample = (m_next_sample + 1) % kLatencyWindow;
+    ++m_requests;
+}
+
+std::string InferenceServer::stats() const
+{
+    std::vector<double> queue_ms, compute_ms;
+    long long requests, batches;
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        queue_ms = m_queue_ms;
+        compute_ms = m_compute_ms;
+        requests = m_requests;
+        batches = m_batches;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "requests=" << requests << " batches=" << batches
+        << " mean_batch=" << (batches > 0 ? static_cast<double>(requests) / batches : 0.0);
+    for (const auto &series : {std::make_pair("queue_ms", &queue_ms), std::make_pair("compute_ms", &compute_ms)})
+    {
+        out << " " << series.first << " p50=" << percentile(*series.second, 0.50)
+            << " p90=" << percentile(*series.second, 0.90) << " p99=" << percentile(*series.second, 0.99);
+    }
+    for (const auto &source : m_stats_sources)
+    {
+        out << " " << source();
+    }
+    return out.str();
+}
+
+void InferenceServer::add_stats_source(std::function<std::string()> source)
+{
+    m_stats_sources.push_back(std::move(source));
+}
+
+std::future<std::string> InferenceServer::handle_line(const std::string &line)
+{
+    if (line == "stats")
+    {
+        return ready_reply(stats());
+    }
+    std::vector<double> features;
+    features.reserve(m_input_size);
+    const char *cell = line.c_str();
+    for (;;)
+    {
+        char *end;
+        double value = std::strtod(cell, &end);
+        if (end == cell)
+        {
+            return ready_reply("error: value " + std::to_string(features.size() + 1) + " is not a number");
+        }
+        features.push_back(value);
+        while (*end == ' ')
+            ++end;
+        if (*end != ',')
+            break;
+        cell = end + 1;
+    }
+    if (static_cast<int>(features.size()) != m_input_size)
+    {
+        return ready_reply("error: expected " + std::to_string(m_input_size) + " values, got " +
+                           std::to_string(features.size()));
+    }
+    return submit(std::move(features));
+}
+
+void InferenceServer::handle_connection(int fd)
+{
+    // Replies are written in request order by a second thread, so a client can
+    // keep sending while earlier requests wait in a batch
+    BoundedQueue<std::future<std::string>> replies(kMaxInFlight);
+    std::thread writer([&]()
+                       {
+        std::future<std::string> reply;
+        bool connected = true;
+        while (replies.pop(reply))
+        {
+            std::string line = reply.get() + "\n";
+            connected = connected && send_all(fd, line);
+        } });
+
+    std::string pending;
+    char buffer[65536];
+    for (;;)
+    {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        pending.append(buffer, static_cast<size_t>(n));
+        size_t begin = 0;
+        size_t newline;
+        while ((newline = pending.find('\n', begin)) != std::string::npos)
+        {
+            std::string line = pending.substr(begin, newline - begin);
+            begin = newline + 1;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty())
+                replies.push(handle_line(line));
+        }
+        pending.erase(0, begin);
+    }
+    replies.close();
+    writer.join();
+
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    m_connections.erase(std::find(m_connections.begin(), m_connections.end(), fd));
+    ::close(fd);
+}
+
+void InferenceServer::serve(const std::string &socket_path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Invalid socket path: " + socket_path);
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    // A socket left behind by a previous server is replaced; any other file is not
+    struct stat existing;
+    if (::lstat(socket_path.c_str(), &existing) == 0)
+    {
+        if (!S_ISSOCK(existing.st_mode))
+        {
+            throw std::runtime_error("Could not listen on " + socket_path + ": the path exists and is not a socket");
+        }
+        ::unlink(socket_path.c_str());
+    }
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+    {
+        throw std::runtime_error(std::string("Could not create socket: ") + std::strerror(errno));
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(listener, SOMAXCONN) < 0)
+    {
+        int err = errno;
+        ::close(listener);
+        throw std::runtime_error("Could not listen on " + socket_path + ": " + std::strerror(err));
+    }
+
+    // One thread per connection; finished ones are joined as the loop goes
+    std::vector<std::future<void>> connections;
+    while (!m_stop_requested.load())
+    {
+        pollfd ready = {listener, POLLIN, 0};
+        int events = ::poll(&ready, 1, kPollIntervalMs);
+        connections.erase(std::remove_if(connections.begin(), connections.end(), [](std::future<void> &connection)
+                                         { return connection.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }),
+                          connections.end());
+        if (events <= 0)
+            continue; // Timeout, or interrupted by a signal
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+        {
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            m_connections.push_back(fd);
+        }
+        connections.push_back(std::async(std::launch::async, &InferenceServer::handle_connection, this, fd));
+    }
+
+    ::close(listener);
+    ::unlink(socket_path.c_str());
+    {
+        // Clients see end of input; requests already read are still answered
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        for (int fd : m_connections)
+            ::shutdown(fd, SHUT_RD);
+    }
+    connections.clear(); // Joins the connection threads
+}
@@ -0,0 +1,204 @@
+#include "serving/PredictionCache.hpp"
+#include "utils/Hash.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+// List node, hash-map node and vector headers of one entry, roughly
+const size_t kEntryOverhead = 128;
+
+size_t entry_bytes(int input_cols, int output_cols)
+{
+    return (static_cast<size_t>(input_cols) + output_cols) * sizeof(double) + kEntryOverhead;
+}
+} // namespace
+
+PredictionCache::PredictionCache(size_t max_bytes, uint64_t model_version, int shards)
+    : m_version(model_version), m_output_cols(0), m_hits(0), m_misses(0)
+{
+    if (shards < 1)
+    {
+        throw std::invalid_argument("Prediction cache needs at least one shard.");
+    }
+    m_shard_capacity = max_bytes / shards;
+    for (int s = 0; s < shards; ++s)
+    {
+        m_shards.emplace_back(new Shard);
+    }
+}
+
+uint64_t PredictionCache::key_for(const double *row, int cols) const
+{
+    return hash_doubles(row, cols, m_version);
+}
+
+PredictionCache::Shard &PredictionCache::shard_for(uint64_t key)
+{
+    // High bits pick the shard; the shard's hash map buckets by the low bits
+    return *m_shards[(key >> 32) % m_shards.size()];
+}
+
+bool PredictionCache::lookup(const double *row, int cols, double *output)
+{
+    uint64_t key = key_for(row, cols);
+    Shard &shard = shard_for(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end())
+        {
+            Entry &entry = *found->second;
+            if (entry.input.size() == static_cast<size_t>(cols) && std::equal(row, row + cols, entry.input.begin()))
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+                std::copy(entry.output.begin(), entry.output.end(), output);
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void PredictionCache::insert(const double *row, int cols, const double *output, int output_cols)
+{
+    size_t bytes = entry_bytes(cols, output_cols);
+    if (bytes > m_shard_capacity)
+    {
+        return;
+    }
+    int expected = 0;
+    m_output_cols.compare_exchange_strong(expected, output_cols);
+
+    // Copies are made before taking the lock
+    Entry entry{key_for(row, cols), std::vector<double>(row, row + cols),
+                std::vector<double>(output, output + output_cols)};
+    Shard &shard = shard_for(entry.key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(entry.key);
+    if (found != shard.index.end())
+    {
+        // Same row inserted twice, or a collision: the newer entry wins
+        shard.bytes -= entry_bytes(static_cast<int>(found->second->input.size()),
+                                   static_cast<int>(found->second->output.size()));
+        shard.lru.erase(found->second);
+        shard.index.erase(found);
+    }
+    shard.lru.push_front(std::move(entry));
+    shard.index[shard.lru.front().key] = shard.lru.begin();
+    shard.bytes += bytes;
+    while (shard.bytes > m_shard_capacity)
+    {
+        const Entry &oldest = shard.lru.back();
+        shard.bytes -= entry_bytes(static_cast<int>(oldest.input.size()), static_cast<int>(oldest.output.size()));
+        shard.index.erase(oldest.key);
+        shard.lru.pop_back();
+    }
+}
+
+Matrix PredictionCache::predict(const Matrix &input, const std::function<Matrix(const Matrix &)> &forward)
+{
+    int rows = input.getRows();
+    int cols = input.getCols();
+    int output_cols = m_output_cols.load();
+    if (output_cols == 0)
+    {
+        // Nothing cached yet, so nothing can hit
+        m_misses.fetch_add(rows, std::memory_order_relaxed);
+        Matrix output = forward(input);
+        for (int i = 0; i < rows; ++i)
+        {
+            insert(input.data() + static_cast<size_t>(i) * cols, cols,
+                   output.data() + static_cast<size_t>(i) * output.getCols(), output.getCols());
+        }
+        return output;
+    }
+
+    Matrix output(rows, output_cols);
+    std::vector<int> missed;
+    for (int i = 0; i < rows; ++i)
+    {
+        if (!lookup(input.data() + static_cast<size_t>(i) * cols, cols,
+                    output.data() + static_cast<size_t>(i) * output_cols))
+        {
+            missed.push_back(i);
+        }
+    }
+    if (missed.empty())
+    {
+        return output;
+    }
+
+    // One forward pass over just the rows that missed
+    Matrix miss_input(static_cast<int>(missed.size()), cols);
+    for (size_t m = 0; m < missed.size(); ++m)
+    {
+        const double *row = input.data() + static_cast<size_t>(missed[m]) * cols;
+        std::copy(row, row + cols, miss_input.data() + m * cols);
+    }
+    Matrix computed = forward(miss_input);
+    if (computed.getCols() != output_cols)
+    {
+        throw std::runtime_error("Model output width does not match the cached predictions.");
+    }
+    for (size_t m = 0; m < missed.size(); ++m)
+    {
+        const double *values = computed.data() + m * output_cols;
+        std::copy(values, values + output_cols, output.data() + static_cast<size_t>(missed[m]) * output_cols);
+        insert(miss_input.data() + m * cols, cols, values, output_cols);
+    }
+    return output;
+}
+
+int PredictionCache::getOutputCols() const
+{
+    return m_output_cols.load();
+}
+
+long long PredictionCache::getHits() const
+{
+    return m_hits.load();
+}
+
+long long PredictionCache::getMisses() const
+{
+    return m_misses.load();
+}
+
+size_t PredictionCache::getEntries() const
+{
+    size_t entries = 0;
+    for (const auto &shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        entries += shard->lru.size();
+    }
+    return entries;
+}
+
+size_t PredictionCache::getBytes() const
+{
+    size_t bytes = 0;
+    for (const auto &shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        bytes += shard->bytes;
+    }
+    return bytes;
+}
+
+std::string PredictionCache::stats() const
+{
+    long long hits = getHits();
+    long long misses = getMisses();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "cache_hits=" << hits << " cache_misses=" << misses << " hit_rate="
+        << (hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0) << "%"
+        << " entries=" << getEntries() << " MB=" << getBytes() / (1024.0 * 1024.0);
+    return out.str();
+}
@@ -0,0 +1,132 @@
+#include "training/DataParallelTrainer.hpp"
+#include "training/GradientReduction.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+DataParallelTrainer::DataParallelTrainer(Model &model, Loss &loss, int workers)
+    : m_model(model), m_loss(loss)
+{
+    if (workers <= 0)
+    {
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    if (m_model.getLayers().empty())
+    {
+        throw std::invalid_argument("Data-parallel training needs a model with layers.");
+    }
+    if (m_model.isMapped())
+    {
+        throw std::runtime_error("Data-parallel training needs a model that owns its parameters.");
+    }
+    m_replicas.reserve(workers);
+    for (int w = 0; w < workers; ++w)
+    {
+        m_replicas.push_back(m_model.snapshot());
+        // Snapshots compute in double; replicas train in the master's precision
+        for (size_t l = 0; l < m_model.getLayers().size(); ++l)
+        {
+            m_replicas.back().getLayers()[l].setPrecision(m_model.getLayers()[l].getPrecision());
+        }
+    }
+}
+
+int DataParallelTrainer::getWorkers() const
+{
+    return static_cast<int>(m_replicas.size());
+}
+
+double DataParallelTrainer::step(const Matrix &X, const Matrix &y, Optimizer &optimizer)
+{
+    int rows = X.getRows();
+    if (rows == 0 || y.getRows() != rows)
+    {
+        throw std::invalid_argument("Training batch must be non-empty with one target row per input row.");
+    }
+    int shards = std::min(getWorkers(), rows);
+    std::vector<DenseLayer> &master = m_model.getLayers();
+    std::vector<int> shard_rows(shards);
+    std::vector<double> shard_loss(shards);
+
+    parallel_for_chunks(rows, shards, [&](int shard, int begin, int end)
+                        {
+        // Broadcast: the replica starts from the current master parameters.
+        // Same-shape assignment reuses the replica's storage.
+        std::vector<DenseLayer> &layers = m_replicas[shard].getLayers();
+        for (size_t l = 0; l < layers.size(); ++l)
+        {
+            layers[l].setWeights(master[l].getWeights());
+            layers[l].setBiases(master[l].getBiases());
+        }
+
+        Matrix X_shard = X.slice(begin, end);
+        Matrix y_shard = y.slice(begin, end);
+        Matrix y_pred = m_replicas[shard].predict(X_shard);
+        shard_loss[shard] = m_loss.calculate(y_pred, y_shard) * (end - begin);
+        m_replicas[shard].backward(m_loss.backward(y_pred, y_shard), false);
+        shard_rows[shard] = end - begin; });
+
+    all_reduce(shards, shard_rows, rows);
+    for (DenseLayer &layer : master)
+    {
+        add_regularizer_gradient(layer);
+    }
+    optimizer.step();
+
+    double loss = 0.0;
+    for (double l : shard_loss)
+    {
+        loss += l;
+    }
+    return loss / rows;
+}
+
+void DataParallelTrainer::all_reduce(int shards, const std::vector<int> &shard_rows, int total_rows)
+{
+    std::vector<double> weight(shards);
+    for (int s = 0; s < shards; ++s)
+    {
+        weight[s] = part_gradient_weight(m_loss, shard_rows[s], total_rows);
+    }
+
+    // Collect buffers up front: sizing the master buffers is not thread-safe
+    struct Slot
+    {
+        double *out;
+        std::vector<const double *> in;
+        size_t size;
+    };
+    std::vector<Slot> slots;
+    std::vector<DenseLayer> &master = m_model.getLayers();
+    for (size_t l = 0; l < master.size(); ++l)
+    {
+        Slot weights{master[l].getWeightsGradient().data(), {}, master[l].getWeights().size()};
+        Slot biases{master[l].getBiasesGradient().data(), {}, master[l].getBiases().size()};
+        for (int s = 0; s < shards; ++s)
+        {
+            const DenseLayer &replica = m_replicas[s].getLayers()[l];
+            weights.in.push_back(replica.getWeightsGradient().data());
+            biases.in.push_back(replica.getBiasesGradient().data());
+        }
+        slots.push_back(std::move(weights));
+        slots.push_back(std::move(biases));
+    }
+
+    parallel_for_chunks(shards, shards, [&](int part, int, int)
+                        {
+        for (const Slot &slot : slots)
+        {
+            size_t begin = slot.size * part / shards;
+            size_t end = slot.size * (part + 1) / shards;
+            for (size_t i = begin; i < end; ++i)
+            {
+                double sum = 0.0;
+                for (int s = 0; s < shards; ++s)
+                {
+                    sum += weight[s] * slot.in[s][i];
+                }
+                slot.out[i] = sum;
+            }
+        } });
+}
@@ -0,0 +1,14 @@
+#include "training/GradientReduction.hpp"
+
+double part_gradient_weight(const Loss &loss, int rows, int total_rows)
+{
+    return loss.gradient_is_mean() ? static_cast<double>(rows) / total_rows : 1.0;
+}
+
+void add_regularizer_gradient(DenseLayer &layer)
+{
+    if (layer.getRegularizer())
+    {
+        layer.getRegularizer()->add_gradient(layer.getWeights(), layer.getWeightsGradient());
+    }
+}
@@ -0,0 +1,96 @@
+#include "training/HogwildTrainer.hpp"
+#include "utils/DataHandler.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Random.hpp"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+HogwildTrainer::HogwildTrainer(Model &model, Loss &loss, OptimizerFactory make_optimizer,
+                               int threads, int batch_size)
+    : m_model(model), m_loss(loss), m_batch_size(batch_size)
+{
+    if (threads <= 0)
+    {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    if (m_batch_size <= 0)
+    {
+        throw std::invalid_argument("Hogwild batch size must be positive.");
+    }
+    if (m_model.isMapped())
+    {
+        throw std::runtime_error("Hogwild training needs a model that owns its parameters.");
+    }
+
+    for (int t = 0; t < threads; ++t)
+    {
+        std::unique_ptr<Worker> worker(new Worker());
+        for (auto &layer : m_model.getLayers())
+        {
+            Matrix &weights = layer.getWeights();
+            Matrix &biases = layer.getBiases();
+            // Shared parameters, private activation caches and gradients
+            worker->replica.add(DenseLayer(Matrix::view(weights.data(), weights.getRows(), weights.getCols()),
+                                           Matrix::view(biases.data(), biases.getRows(), biases.getCols()),
+                                           Activation::create(layer.getActivation()->name()),
+                                           layer.getRegularizer()));
+        }
+        worker->optimizer = make_optimizer(worker->replica.getLayers());
+        m_workers.push_back(std::move(worker));
+    }
+}
+
+int HogwildTrainer::getThreads() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+int HogwildTrainer::getBatchSize() const
+{
+    return m_batch_size;
+}
+
+double HogwildTrainer::epoch(const Matrix &X, const Matrix &y)
+{
+    int rows = X.getRows();
+    if (rows == 0 || y.getRows() != rows)
+    {
+        throw std::invalid_argument("Training data must be non-empty with one target row per input row.");
+    }
+
+    std::vector<int> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), global_rng());
+
+    int batches = (rows + m_batch_size - 1) / m_batch_size;
+    int threads = std::min(getThreads(), batches);
+    std::atomic<int> next_batch(0);
+    std::vector<double> thread_loss(threads, 0.0);
+
+    parallel_for_chunks(threads, threads, [&](int t, int, int)
+                        {
+        Worker &worker = *m_workers[t];
+        for (int b = next_batch.fetch_add(1, std::memory_order_relaxed); b < batches;
+             b = next_batch.fetch_add(1, std::memory_order_relaxed))
+        {
+            size_t begin = static_cast<size_t>(b) * m_batch_size;
+            size_t end = std::min(begin + m_batch_size, static_cast<size_t>(rows));
+            Matrix X_batch = gather_rows(X, order, begin, end);
+            Matrix y_batch = gather_rows(y, order, begin, end);
+
+            Matrix y_pred = worker.replica.predict(X_batch);
+            thread_loss[t] += m_loss.calculate(y_pred, y_batch);
+            worker.replica.backward(m_loss.backward(y_pred, y_batch));
+            worker.optimizer->step(); // Writes straight into the shared weights
+        } });
+
+    double loss = 0.0;
+    for (double l : thread_loss)
+    {
+        loss += l;
+    }
+    return loss / batches;
+}
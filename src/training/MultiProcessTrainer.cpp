@@ -0,0 +1,68 @@
+#include "training/MultiProcessTrainer.hpp"
+#include "training/GradientReduction.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+MultiProcessTrainer::MultiProcessTrainer(Model &model, Loss &loss, SharedMemoryGroup &group)
+    : m_model(model), m_loss(loss), m_group(group), m_buffer(buffer_size(model))
+{
+    if (m_model.isMapped())
+    {
+        throw std::runtime_error("Multi-process training needs a model that owns its parameters.");
+    }
+}
+
+size_t MultiProcessTrainer::buffer_size(Model &model)
+{
+    size_t count = 1; // Batch loss
+    for (auto &layer : model.getLayers())
+    {
+        count += layer.getWeights().size() + layer.getBiases().size();
+    }
+    return count;
+}
+
+double MultiProcessTrainer::step(const Matrix &X, const Matrix &y, Optimizer &optimizer)
+{
+    int rows = X.getRows();
+    if (rows < m_group.world() || y.getRows() != rows)
+    {
+        throw std::invalid_argument("Training batch needs at least one row per process and one target row per input row.");
+    }
+    int begin = static_cast<int>(static_cast<long long>(rows) * m_group.rank() / m_group.world());
+    int end = static_cast<int>(static_cast<long long>(rows) * (m_group.rank() + 1) / m_group.world());
+    Matrix X_shard = X.slice(begin, end);
+    Matrix y_shard = y.slice(begin, end);
+
+    Matrix y_pred = m_model.predict(X_shard);
+    m_model.backward(m_loss.backward(y_pred, y_shard), false);
+
+    double weight = part_gradient_weight(m_loss, end - begin, rows);
+    std::vector<DenseLayer> &layers = m_model.getLayers();
+    double *out = m_buffer.data();
+    for (auto &layer : layers)
+    {
+        for (const Matrix *gradient : {&layer.getWeightsGradient(), &layer.getBiasesGradient()})
+        {
+            out = std::transform(gradient->data(), gradient->data() + gradient->size(), out,
+                                 [weight](double g)
+                                 { return g * weight; });
+        }
+    }
+    *out = m_loss.calculate(y_pred, y_shard) * (end - begin) / rows;
+
+    m_group.all_reduce(m_buffer.data(), m_buffer.size());
+
+    const double *in = m_buffer.data();
+    for (auto &layer : layers)
+    {
+        for (Matrix *gradient : {&layer.getWeightsGradient(), &layer.getBiasesGradient()})
+        {
+            std::copy(in, in + gradient->size(), gradient->data());
+            in += gradient->size();
+        }
+        add_regularizer_gradient(layer);
+    }
+    optimizer.step();
+    return *in;
+}
@@ -0,0 +1,328 @@
+#include "training/PipelineExecutor.hpp"
+#include "training/GradientReduction.hpp"
+#include "utils/BoundedQueue.hpp"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+// A micro-batch's activations or gradients moving between stages
+struct Packet
+{
+    int micro = -1;
+    Matrix data{0, 0};
+};
+
+using PacketQueue = BoundedQueue<Packet>;
+
+std::vector<std::unique_ptr<PacketQueue>> make_queues(size_t count, size_t capacity)
+{
+    std::vector<std::unique_ptr<PacketQueue>> queues;
+    for (size_t i = 0; i < count; ++i)
+    {
+        queues.emplace_back(new PacketQueue(capacity));
+    }
+    return queues;
+}
+
+// Runs body(stage) on one thread per stage. The first failure closes every
+// queue so the other stages stop waiting, and is rethrown once all have joined.
+template <typename Body>
+void run_stages(int stages, std::vector<std::unique_ptr<PacketQueue>> &queues, Body body)
+{
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto guarded = [&](int stage)
+    {
+        try
+        {
+            body(stage);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+            for (auto &queue : queues)
+                queue->close();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int s = 0; s < stages; ++s)
+    {
+        threads.emplace_back(guarded, s);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+int micro_begin(int rows, int micro, int micro_batches)
+{
+    return static_cast<int>(static_cast<long long>(rows) * micro / micro_batches);
+}
+} // namespace
+
+PipelineExecutor::PipelineExecutor(Model &model, int stages, int micro_batches, size_t queue_capacity)
+    : m_model(model), m_micro_batches(std::max(1, micro_batches)), m_queue_capacity(std::max<size_t>(1, queue_capacity))
+{
+    std::vector<DenseLayer> &layers = m_model.getLayers();
+    int layer_count = static_cast<int>(layers.size());
+    if (layer_count == 0)
+    {
+        throw std::invalid_argument("Pipeline execution needs a model with layers.");
+    }
+    if (m_model.isMapped())
+    {
+        throw std::runtime_error("Pipeline execution needs a model that owns its parameters.");
+    }
+    if (stages <= 0)
+    {
+        stages = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    stages = std::min(stages, layer_count);
+
+    // Contiguous stages with roughly equal weight counts, each at least one layer
+    double total = 0.0;
+    for (const auto &layer : layers)
+    {
+        total += layer.getWeights().size() + layer.getBiases().size();
+    }
+    m_stage_begin.push_back(0);
+    double assigned = 0.0;
+    for (int l = 0; l + 1 < layer_count && static_cast<int>(m_stage_begin.size()) < stages; ++l)
+    {
+        assigned += layers[l].getWeights().size() + layers[l].getBiases().size();
+        int stages_left = stages - static_cast<int>(m_stage_begin.size());
+        int layers_left = layer_count - (l + 1);
+        if (assigned >= total * m_stage_begin.size() / stages || layers_left == stages_left)
+        {
+            m_stage_begin.push_back(l + 1);
+        }
+    }
+    m_stage_begin.push_back(layer_count);
+}
+
+int PipelineExecutor::getStages() const
+{
+    return static_cast<int>(m_stage_begin.size()) - 1;
+}
+
+int PipelineExecutor::getMicroBatches() const
+{
+    return m_micro_batches;
+}
+
+int PipelineExecutor::micro_batch_count(int rows) const
+{
+    if (rows <= 0)
+    {
+        throw std::invalid_argument("Pipeline execution needs a non-empty batch.");
+    }
+    return std::min(m_micro_batches, rows);
+}
+
+std::vector<DenseLayer> PipelineExecutor::make_replica() const
+{
+    std::vector<DenseLayer> replica;
+    for (auto &layer : m_model.getLayers())
+    {
+        Matrix &weights = layer.getWeights();
+        Matrix &biases = layer.getBiases();
+        replica.emplace_back(Matrix::view(weights.data(), weights.getRows(), weights.getCols()),
+                             Matrix::view(biases.data(), biases.getRows(), biases.getCols()),
+                             Activation::create(layer.getActivation()->name()), layer.getRegularizer());
+    }
+    return replica;
+}
+
+Matrix PipelineExecutor::predict(const Matrix &input)
+{
+    int rows = input.getRows();
+    int micro_batches = micro_batch_count(rows);
+    int stages = getStages();
+    // Every stage touches only its own layers, so one replica serves all micro-batches
+    std::vector<DenseLayer> replica = make_replica();
+
+    // queues[s] feeds stage s; the last one collects outputs and holds them all
+    auto queues = make_queues(stages, m_queue_capacity);
+    queues.emplace_back(new PacketQueue(micro_batches));
+
+    std::thread feeder([&]()
+                       {
+        for (int m = 0; m < micro_batches; ++m)
+        {
+            Packet packet{m, input.slice(micro_begin(rows, m, micro_batches), micro_begin(rows, m + 1, micro_batches))};
+            if (!queues[0]->push(std::move(packet)))
+                return;
+        } });
+
+    try
+    {
+        run_stages(stages, queues, [&](int stage)
+                   {
+            Packet packet;
+            for (int i = 0; i < micro_batches && queues[stage]->pop(packet); ++i)
+            {
+                for (int l = m_stage_begin[stage]; l < m_stage_begin[stage + 1]; ++l)
+                {
+                    packet.data = replica[l].forward(packet.data);
+                }
+                queues[stage + 1]->push(std::move(packet));
+            } });
+    }
+    catch (...)
+    {
+        feeder.join();
+        throw;
+    }
+    feeder.join();
+
+    Matrix output(rows, replica.back().getWeights().getCols());
+    Packet packet;
+    for (int i = 0; i < micro_batches && queues[stages]->pop(packet); ++i)
+    {
+        int offset = micro_begin(rows, packet.micro, micro_batches);
+        std::copy(packet.data.data(), packet.data.data() + packet.data.size(),
+                  output.data() + static_cast<size_t>(offset) * output.getCols());
+    }
+    return output;
+}
+
+double PipelineExecutor::forward_backward(const Matrix &X, const Matrix &y, Loss &loss)
+{
+    int rows = X.getRows();
+    if (y.getRows() != rows)
+    {
+        throw std::invalid_argument("Training batch needs one target row per input row.");
+    }
+    int micro_batches = micro_batch_count(rows);
+    int stages = getStages();
+
+    // Each in-flight micro-batch keeps its own activation caches and gradients
+    std::vector<std::vector<DenseLayer>> replicas;
+    for (int m = 0; m < micro_batches; ++m)
+    {
+        replicas.push_back(make_replica());
+    }
+    std::vector<double> share(micro_batches), weight(micro_batches);
+    for (int m = 0; m < micro_batches; ++m)
+    {
+        int micro_rows = micro_begin(rows, m + 1, micro_batches) - micro_begin(rows, m, micro_batches);
+        share[m] = static_cast<double>(micro_rows) / rows;
+        weight[m] = part_gradient_weight(loss, micro_rows, rows);
+    }
+
+    // queues[s] feeds stage s going forward, queues[stages + s] going backward
+    auto queues = make_queues(2 * stages, m_queue_capacity);
+    auto fwd = [&](int s) -> PacketQueue &
+    { return *queues[s]; };
+    auto bwd = [&](int s) -> PacketQueue &
+    { return *queues[stages + s]; };
+
+    std::vector<double> micro_loss(micro_batches, 0.0);
+    std::vector<DenseLayer> &master = m_model.getLayers();
+
+    std::thread feeder([&]()
+                       {
+        for (int m = 0; m < micro_batches; ++m)
+        {
+            Packet packet{m, X.slice(micro_begin(rows, m, micro_batches), micro_begin(rows, m + 1, micro_batches))};
+            if (!fwd(0).push(std::move(packet)))
+                return;
+        } });
+
+    auto stage_body = [&](int stage)
+    {
+        int first = m_stage_begin[stage];
+        int last = m_stage_begin[stage + 1];
+        bool is_last = stage == stages - 1;
+        std::vector<Packet> output_grads; // Last stage: loss gradients, in arrival order
+
+        // --- Forward: all micro-batches ---
+        Packet packet;
+        for (int i = 0; i < micro_batches; ++i)
+        {
+            if (!fwd(stage).pop(packet))
+                return;
+            for (int l = first; l < last; ++l)
+            {
+                packet.data = replicas[packet.micro][l].forward(packet.data);
+            }
+            if (is_last)
+            {
+                int m = packet.micro;
+                Matrix y_micro = y.slice(micro_begin(rows, m, micro_batches), micro_begin(rows, m + 1, micro_batches));
+                micro_loss[m] = loss.calculate(packet.data, y_micro) * share[m];
+                output_grads.push_back(Packet{m, loss.backward(packet.data, y_micro)});
+            }
+            else if (!fwd(stage + 1).push(std::move(packet)))
+            {
+                return;
+            }
+        }
+
+        // --- Backward: all micro-batches ---
+        for (int i = 0; i < micro_batches; ++i)
+        {
+            if (is_last)
+                packet = std::move(output_grads[i]);
+            else if (!bwd(stage).pop(packet))
+                return;
+            for (int l = last - 1; l >= first; --l)
+            {
+                // The regularizers' penalty is added once, after accumulating
+                packet.data = replicas[packet.micro][l].backward(packet.data, true, false);
+            }
+            if (stage > 0 && !bwd(stage - 1).push(std::move(packet)))
+                return;
+        }
+
+        // --- Accumulate this stage's gradients into the model ---
+        for (int l = first; l < last; ++l)
+        {
+            for (bool weights : {true, false})
+            {
+                Matrix &out = weights ? master[l].getWeightsGradient() : master[l].getBiasesGradient();
+                std::fill(out.data(), out.data() + out.size(), 0.0);
+                for (int m = 0; m < micro_batches; ++m)
+                {
+                    const DenseLayer &replica = replicas[m][l];
+                    const Matrix &grad = weights ? replica.getWeightsGradient() : replica.getBiasesGradient();
+                    for (size_t i = 0; i < out.size(); ++i)
+                    {
+                        out.data()[i] += weight[m] * grad.data()[i];
+                    }
+                }
+            }
+            add_regularizer_gradient(master[l]);
+        }
+    };
+
+    try
+    {
+        run_stages(stages, queues, stage_body);
+    }
+    catch (...)
+    {
+        feeder.join();
+        throw;
+    }
+    feeder.join();
+
+    double total = 0.0;
+    for (double l : micro_loss)
+    {
+        total += l;
+    }
+    return total;
+}
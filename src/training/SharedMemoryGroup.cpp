@@ -0,0 +1,243 @@
+#include "training/SharedMemoryGroup.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+const size_t kAlignment = 64;
+
+size_t align_up(size_t bytes)
+{
+    return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+} // namespace
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared-memory barrier needs lock-free atomics");
+
+struct SharedMemoryGroup::Header
+{
+    std::atomic<uint32_t> arrived;
+    std::atomic<uint32_t> generation;
+    std::atomic<uint32_t> aborted;
+};
+
+SharedMemoryGroup::SharedMemoryGroup(void *base, size_t bytes, int rank, int world, size_t capacity)
+    : m_base(base), m_bytes(bytes), m_header(static_cast<Header *>(base)), m_rank(rank), m_world(world),
+      m_capacity(capacity), m_parent(getpid()), m_finished(false)
+{
+}
+
+std::unique_ptr<SharedMemoryGroup> SharedMemoryGroup::launch(int world, size_t capacity)
+{
+    if (world < 1)
+    {
+        throw std::invalid_argument("A process group needs at least one rank.");
+    }
+
+    size_t bytes = align_up(sizeof(Header)) + world * align_up(capacity * sizeof(double));
+    std::string name = "/mlp-" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        throw std::runtime_error("shm_open failed for " + name + ": " + std::strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+    {
+        int err = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error(std::string("Could not size shared-memory segment: ") + std::strerror(err));
+    }
+    void *base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int map_errno = errno;
+    close(fd);
+    // The mapping (inherited by fork) keeps the segment alive; drop the name now
+    shm_unlink(name.c_str());
+    if (base == MAP_FAILED)
+    {
+        throw std::runtime_error(std::string("Could not map shared-memory segment: ") + std::strerror(map_errno));
+    }
+    new (base) Header{{0}, {0}, {0}};
+
+    std::unique_ptr<SharedMemoryGroup> group(new SharedMemoryGroup(base, bytes, 0, world, capacity));
+    std::cout.flush(); // Children must not inherit unflushed output
+    for (int r = 1; r < world; ++r)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            group->m_header->aborted.store(1);
+            throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+        }
+        if (pid == 0)
+        {
+            group->m_rank = r;
+            group->m_children.clear();
+            return group;
+        }
+        group->m_children.push_back(pid);
+    }
+    return group;
+}
+
+SharedMemoryGroup::~SharedMemoryGroup()
+{
+    if (!m_finished)
+    {
+        // Leaving without finish() (e.g. an exception): release the peers
+        m_header->aborted.store(1);
+    }
+    munmap(m_base, m_bytes);
+}
+
+int SharedMemoryGroup::rank() const
+{
+    return m_rank;
+}
+
+int SharedMemoryGroup::world() const
+{
+    return m_world;
+}
+
+double *SharedMemoryGroup::buffer(int rank) const
+{
+    char *start = static_cast<char *>(m_base) + align_up(sizeof(Header));
+    return reinterpret_cast<double *>(start + rank * align_up(m_capacity * sizeof(double)));
+}
+
+// Throws if a peer has failed while this rank waits in the barrier of the given
+// generation, so no rank waits forever on a dead one
+void SharedMemoryGroup::check_peers(uint32_t generation)
+{
+    if (m_header->aborted.load(std::memory_order_acquire))
+    {
+        throw std::runtime_error("Another training process failed.");
+    }
+    if (m_rank == 0)
+    {
+        for (pid_t child : m_children)
+        {
+            // Peek without reaping: finish() collects the exit status
+            siginfo_t info;
+            info.si_pid = 0;
+            if (waitid(P_PID, child, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == child)
+            {
+                if (m_header->generation.load(std::memory_order_acquire) != generation)
+                    return; // The barrier completed before the child exited
+                m_header->aborted.store(1, std::memory_order_release);
+                throw std::runtime_error("Training process " + std::to_string(child) + " exited early.");
+            }
+        }
+    }
+    else if (getppid() != m_parent)
+    {
+        m_header->aborted.store(1, std::memory_order_release);
+        throw std::runtime_error("Rank 0 training process exited early.");
+    }
+}
+
+void SharedMemoryGroup::barrier()
+{
+    uint32_t generation = m_header->generation.load(std::memory_order_acquire);
+    if (m_header->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == static_cast<uint32_t>(m_world))
+    {
+        m_header->arrived.store(0, std::memory_order_relaxed);
+        m_header->generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    for (unsigned spins = 1; m_header->generation.load(std::memory_order_acquire) == generation; ++spins)
+    {
+        if (spins % 64 == 0)
+        {
+            sched_yield(); // Ranks may outnumber cores
+        }
+        if (spins % 4096 == 0)
+        {
+            check_peers(generation);
+        }
+    }
+}
+
+void SharedMemoryGroup::all_reduce(double *data, size_t count)
+{
+    if (count > m_capacity)
+    {
+        throw std::invalid_argument("all_reduce of " + std::to_string(count) + " values exceeds the group's buffers.");
+    }
+    double *mine = buffer(m_rank);
+    std::copy(data, data + count, mine);
+    if (m_world == 1)
+        return;
+    barrier();
+
+    // Ring over `world` chunks. Each step reads one chunk from the left
+    // neighbour's buffer while that neighbour works on a different chunk.
+    const double *left = buffer((m_rank + m_world - 1) % m_world);
+    auto chunk_begin = [&](int chunk)
+    { return count * chunk / m_world; };
+
+    // Reduce-scatter: after world - 1 steps, rank r holds the full sum of chunk r + 1
+    for (int step = 0; step < m_world - 1; ++step)
+    {
+        int chunk = (m_rank - step - 1 + 2 * m_world) % m_world;
+        for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+        {
+            mine[i] += left[i];
+        }
+        barrier();
+    }
+    // All-gather: pass the finished chunks around the ring
+    for (int step = 0; step < m_world - 1; ++step)
+    {
+        int chunk = (m_rank - step + 2 * m_world) % m_world;
+        std::copy(left + chunk_begin(chunk), left + chunk_begin(chunk + 1), mine + chunk_begin(chunk));
+        barrier();
+    }
+    std::copy(mine, mine + count, data);
+}
+
+bool SharedMemoryGroup::any(bool flag)
+{
+    double value = flag ? 1.0 : 0.0;
+    all_reduce(&value, 1);
+    return value > 0.0;
+}
+
+void SharedMemoryGroup::finish()
+{
+    m_finished = true;
+    if (m_rank != 0)
+    {
+        std::cout.flush();
+        std::cerr.flush();
+        _exit(0);
+    }
+
+    bool failed = false;
+    for (pid_t child : m_children)
+    {
+        int status = 0;
+        if (waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            failed = true;
+        }
+    }
+    m_children.clear();
+    if (failed)
+    {
+        throw std::runtime_error("A training process did not finish cleanly.");
+    }
+}
@@ -0,0 +1,138 @@
+#include "utils/AsyncValidator.hpp"
+#include "utils/Evaluation.hpp"
+
+AsyncValidator::AsyncValidator(const Matrix &X_val, const Matrix &y_val, std::shared_ptr<Loss> loss,
+                               const Matrix &labels, size_t snapshots)
+    : m_X_val(X_val), m_y_val(y_val), m_loss(std::move(loss)), m_labels(labels),
+      m_snapshots(snapshots < 1 ? 1 : snapshots), m_has_taken(false), m_taken(0), m_busy(false), m_stop(false)
+{
+    for (size_t s = m_snapshots.size(); s > 0; --s)
+    {
+        m_free.push_back(s - 1);
+    }
+    m_worker = std::thread(&AsyncValidator::run, this);
+}
+
+AsyncValidator::~AsyncValidator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+}
+
+bool AsyncValidator::submit(int epoch, const Model &model)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        release_taken();
+        m_cv.wait(lock, [this]()
+                  { return !m_free.empty() || !m_done.empty() || m_error; });
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+        if (m_free.empty())
+        {
+            return false;
+        }
+        // A free snapshot is not touched by the worker, and the first fill sizes it
+        Model &snapshot = m_snapshots[m_free.back()];
+        if (snapshot.getLayers().empty())
+            snapshot = model.snapshot();
+        else
+            snapshot.copy_parameters(model);
+        m_pending.push_back(Job{epoch, m_free.back()});
+        m_free.pop_back();
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+// The previous result's snapshot goes back to the pool. Caller holds m_mutex.
+void AsyncValidator::release_taken()
+{
+    if (m_has_taken)
+    {
+        m_free.push_back(m_taken);
+        m_has_taken = false;
+    }
+}
+
+// Pops a finished result, or rethrows a failure from the worker. Caller holds m_mutex.
+bool AsyncValidator::take(ValidationResult &result)
+{
+    release_taken();
+    if (!m_done.empty())
+    {
+        result = m_done.front().result;
+        m_taken = m_done.front().snapshot;
+        m_has_taken = true;
+        m_done.pop_front();
+        return true;
+    }
+    if (m_error)
+    {
+        std::rethrow_exception(m_error);
+    }
+    return false;
+}
+
+bool AsyncValidator::poll(ValidationResult &result)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return take(result);
+}
+
+bool AsyncValidator::wait(ValidationResult &result)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]()
+              { return !m_done.empty() || m_error || (m_pending.empty() && !m_busy); });
+    return take(result);
+}
+
+void AsyncValidator::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this]()
+                  { return !m_pending.empty() || m_stop; });
+        if (m_stop)
+            break;
+
+        Job job = m_pending.front();
+        m_pending.pop_front();
+        m_busy = true;
+        lock.unlock();
+
+        ValidationResult result;
+        std::exception_ptr error;
+        try
+        {
+            Matrix predictions = m_snapshots[job.snapshot].predict(m_X_val);
+            result.epoch = job.epoch;
+            result.loss = m_loss->calculate(predictions, m_y_val);
+            if (m_labels.getRows() > 0)
+            {
+                result.accuracy = calculate_accuracy(predictions, m_labels);
+            }
+            result.snapshot = &m_snapshots[job.snapshot];
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        m_busy = false;
+        if (error)
+            m_error = error;
+        else
+            m_done.push_back(Done{result, job.snapshot});
+        m_cv.notify_all();
+    }
+}
@@ -0,0 +1,165 @@
+#include "utils/Checkpoint.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+Checkpointer::Checkpointer(const std::string &path, int every_epochs)
+    : m_path(path), m_every(every_epochs), m_busy(false), m_stop(false)
+{
+    if (m_every <= 0)
+    {
+        throw std::invalid_argument("Checkpoint interval must be positive.");
+    }
+    m_worker = std::thread(&Checkpointer::run, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+}
+
+bool Checkpointer::due(int epoch) const
+{
+    return (epoch + 1) % m_every == 0;
+}
+
+void Checkpointer::submit(Model snapshot, TrainingState state)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_model.reset(new Model(std::move(snapshot)));
+        m_pending_state = std::move(state);
+    }
+    m_cv.notify_all();
+}
+
+void Checkpointer::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]()
+              { return !m_pending_model && !m_busy; });
+}
+
+void Checkpointer::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this]()
+                  { return m_pending_model || m_stop; });
+        if (!m_pending_model)
+            break; // Stopping with nothing left to write
+
+        std::unique_ptr<Model> model = std::move(m_pending_model);
+        TrainingState state = std::move(m_pending_state);
+        m_busy = true;
+        lock.unlock();
+        try
+        {
+            write(m_path, *model, state);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Warning: checkpoint at epoch " << state.epoch << " failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+        m_busy = false;
+        m_cv.notify_all();
+    }
+}
+
+void Checkpointer::write(const std::string &path, const Model &model, const TrainingState &state)
+{
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Could not open file for saving: " + tmp_path);
+        }
+        model.save_text(file);
+
+        file << "TRAINING_STATE 1\n";
+        file << "EPOCH " << state.epoch << "\n";
+        file << "RNG " << state.rng_state << "\n";
+        file << "OPTIMIZER " << (state.optimizer.name.empty() ? "none" : state.optimizer.name) << " "
+             << state.optimizer.step << " " << state.optimizer.tensors.size() << "\n";
+        for (const auto &tensor : state.optimizer.tensors)
+        {
+            tensor.write_text(file);
+        }
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write checkpoint: " + tmp_path);
+        }
+    }
+
+    // Make the data durable before the rename publishes it
+    int fd = ::open(tmp_path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        throw std::runtime_error("Could not move checkpoint into place: " + path);
+    }
+}
+
+bool Checkpointer::read_state(const std::string &path, TrainingState &state)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line) && line != "TRAINING_STATE 1")
+    {
+    }
+    if (!file)
+    {
+        return false;
+    }
+
+    TrainingState result;
+    std::string tag;
+    std::getline(file, line);
+    std::stringstream(line) >> tag >> result.epoch;
+    std::getline(file, line);
+    if (line.compare(0, 4, "RNG ") != 0)
+    {
+        throw std::runtime_error("Malformed checkpoint: missing RNG state.");
+    }
+    result.rng_state = line.substr(4);
+
+    size_t tensor_count = 0;
+    std::getline(file, line);
+    std::stringstream optimizer_line(line);
+    optimizer_line >> tag >> result.optimizer.name >> result.optimizer.step >> tensor_count;
+    if (tag != "OPTIMIZER")
+    {
+        throw std::runtime_error("Malformed checkpoint: missing optimizer state.");
+    }
+    if (result.optimizer.name == "none")
+    {
+        result.optimizer.name.clear();
+    }
+    for (size_t i = 0; i < tensor_count; ++i)
+    {
+        result.optimizer.tensors.push_back(Matrix::read_text(file));
+    }
+    state = std::move(result);
+    return true;
+}
@@ -1,59 +1,164 @@
 #include "utils/DataHandler.hpp"
+#include "utils/Parallel.hpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
-#include <cmath> // For std::sqrt and std::pow
+#include <cmath> // For std::sqrt
+#include <stdexcept>
+#include <algorithm>
 
-// Add this class implementation to DataHandler.cpp
-#include <stdexcept> // For StandardScaler
+namespace
+{
+// Rows below this are scanned on the calling thread; spawning is not worth it.
+const int kScalerRowsPerThread = 4096;
+
+// Running statistics of one row chunk
+struct PartialStats
+{
+    long long count = 0;
+    std::vector<double> mean;
+    std::vector<double> m2;
+};
+
+// Chan et al. pairwise merge of two sets of (count, mean, M2)
+void merge_stats(long long &count, double *mean, double *m2,
+                 const PartialStats &other, int cols)
+{
+    if (other.count == 0)
+        return;
+    long long total = count + other.count;
+    double weight = static_cast<double>(other.count) / total;
+    double cross = static_cast<double>(count) * other.count / total;
+    for (int j = 0; j < cols; ++j)
+    {
+        double delta = other.mean[j] - mean[j];
+        mean[j] += delta * weight;
+        m2[j] += other.m2[j] + delta * delta * cross;
+    }
+    count = total;
+}
+} // namespace
 
-StandardScaler::StandardScaler() : m_mean(0, 0), m_std(0, 0) {}
+StandardScaler::StandardScaler() : m_count(0), m_mean(0, 0), m_m2(0, 0), m_std(0, 0) {}
+
+void StandardScaler::reset()
+{
+    m_count = 0;
+    m_mean = Matrix(0, 0);
+    m_m2 = Matrix(0, 0);
+    m_std = Matrix(0, 0);
+}
+
+void StandardScaler::set_statistics(const Matrix &mean, const Matrix &std, long long count)
+{
+    if (mean.getRows() != 1 || std.getRows() != 1 || mean.getCols() != std.getCols() || count <= 0)
+    {
+        throw std::invalid_argument("Invalid scaler statistics.");
+    }
+    m_count = count;
+    m_mean = mean;
+    m_std = std;
+    // M2 is implied by the population standard deviation
+    m_m2 = Matrix(1, std.getCols());
+    for (int j = 0; j < std.getCols(); ++j)
+    {
+        m_m2.data()[j] = std.data()[j] * std.data()[j] * count;
+    }
+}
 
 void StandardScaler::fit(const Matrix &data)
+{
+    if (data.getRows() == 0)
+        return;
+    reset();
+    partial_fit(data);
+}
+
+void StandardScaler::partial_fit(const Matrix &data)
 {
     int rows = data.getRows();
     int cols = data.getCols();
     if (rows == 0)
         return;
 
-    m_mean = Matrix(1, cols);
-    m_std = Matrix(1, cols);
-
-    for (int j = 0; j < cols; ++j)
+    if (m_count == 0)
     {
-        double sum = 0.0;
-        for (int i = 0; i < rows; ++i)
-        {
-            sum += data(i, j);
-        }
-        m_mean(0, j) = sum / rows;
+        m_mean = Matrix(1, cols);
+        m_m2 = Matrix(1, cols);
+    }
+    else if (cols != m_mean.getCols())
+    {
+        throw std::runtime_error("Data has incorrect number of features for partial_fit.");
+    }
 
-        double sum_sq_diff = 0.0;
-        for (int i = 0; i < rows; ++i)
+    // Single row-major Welford pass per chunk, chunks merged afterwards
+    int chunks = parallel_chunk_count(rows, kScalerRowsPerThread);
+    std::vector<PartialStats> partials(chunks);
+    const double *src = data.data();
+    parallel_for_chunks(rows, chunks, [&](int chunk, int begin, int end)
+                        {
+        PartialStats &stats = partials[chunk];
+        stats.mean.assign(cols, 0.0);
+        stats.m2.assign(cols, 0.0);
+        for (int i = begin; i < end; ++i)
         {
-            sum_sq_diff += std::pow(data(i, j) - m_mean(0, j), 2);
-        }
-        m_std(0, j) = std::sqrt(sum_sq_diff / rows);
-        if (m_std(0, j) == 0)
-            m_std(0, j) = 1.0; // Avoid division by zero
+            const double *row = src + static_cast<size_t>(i) * cols;
+            stats.count++;
+            double inv_count = 1.0 / stats.count;
+            for (int j = 0; j < cols; ++j)
+            {
+                double delta = row[j] - stats.mean[j];
+                stats.mean[j] += delta * inv_count;
+                stats.m2[j] += delta * (row[j] - stats.mean[j]);
+            }
+        } });
+
+    for (const auto &stats : partials)
+    {
+        merge_stats(m_count, m_mean.data(), m_m2.data(), stats, cols);
+    }
+
+    m_std = Matrix(1, cols);
+    for (int j = 0; j < cols; ++j)
+    {
+        double std_dev = std::sqrt(m_m2.data()[j] / m_count);
+        m_std.data()[j] = std_dev == 0 ? 1.0 : std_dev; // Avoid division by zero
     }
 }
 
 Matrix StandardScaler::transform(const Matrix &data) const
 {
-    if (data.getCols() != m_mean.getCols())
+    Matrix scaled_data = data;
+    transform_inplace(scaled_data);
+    return scaled_data;
+}
+
+void StandardScaler::transform_inplace(Matrix &data) const
+{
+    int cols = data.getCols();
+    if (cols != m_mean.getCols())
     {
         throw std::runtime_error("Data has incorrect number of features for transform.");
     }
-    Matrix scaled_data = data;
-    for (int j = 0; j < data.getCols(); ++j)
+    std::vector<double> inv_std(cols);
+    for (int j = 0; j < cols; ++j)
     {
-        for (int i = 0; i < data.getRows(); ++i)
-        {
-            scaled_data(i, j) = (scaled_data(i, j) - m_mean(0, j)) / m_std(0, j);
-        }
+        inv_std[j] = 1.0 / m_std.data()[j];
     }
-    return scaled_data;
+    const double *mean = m_mean.data();
+    double *dst = data.data();
+    int rows = data.getRows();
+    parallel_for_chunks(rows, parallel_chunk_count(rows, kScalerRowsPerThread),
+                        [&](int, int begin, int end)
+                        {
+        for (int i = begin; i < end; ++i)
+        {
+            double *row = dst + static_cast<size_t>(i) * cols;
+            for (int j = 0; j < cols; ++j)
+            {
+                row[j] = (row[j] - mean[j]) * inv_std[j];
+            }
+        } });
 }
 
 Matrix StandardScaler::fit_transform(const Matrix &data)
@@ -62,6 +167,10 @@ Matrix StandardScaler::fit_transform(const Matrix &data)
     return transform(data);
 }
 
+const Matrix &StandardScaler::getMean() const { return m_mean; }
+const Matrix &StandardScaler::getStd() const { return m_std; }
+long long StandardScaler::getCount() const { return m_count; }
+
 std::pair<Matrix, Matrix> read_csv_mnist(const std::string &filepath, int num_rows)
 {
     std::ifstream file(filepath);
@@ -144,6 +253,23 @@ void normalize_features(Matrix &features)
                  { return val / 255.0; });
 }
 
+std::pair<Matrix, Matrix> normalization_transform(int num_features)
+{
+    Matrix shift(1, num_features);
+    Matrix scale(1, num_features);
+    scale.map([](double)
+              { return 1.0 / 255.0; });
+    return {shift, scale};
+}
+
+std::pair<Matrix, Matrix> scaler_transform(const StandardScaler &scaler)
+{
+    Matrix scale = scaler.getStd();
+    scale.map([](double s)
+              { return 1.0 / s; });
+    return {scaler.getMean(), scale};
+}
+
 Matrix one_hot_encode(const Matrix &labels, int num_classes)
 {
     Matrix one_hot(labels.getRows(), num_classes);
@@ -157,3 +283,16 @@ Matrix one_hot_encode(const Matrix &labels, int num_classes)
     }
     return one_hot;
 }
+
+Matrix gather_rows(const Matrix &source, const std::vector<int> &order, size_t begin, size_t end)
+{
+    int cols = source.getCols();
+    Matrix batch(static_cast<int>(end - begin), cols);
+    for (size_t i = begin; i < end; ++i)
+    {
+        std::copy(source.data() + static_cast<size_t>(order[i]) * cols,
+                  source.data() + static_cast<size_t>(order[i] + 1) * cols,
+                  batch.data() + (i - begin) * cols);
+    }
+    return batch;
+}
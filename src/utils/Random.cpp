@@ -0,0 +1,32 @@
+#include "utils/Random.hpp"
+#include <sstream>
+#include <stdexcept>
+
+std::mt19937 &global_rng()
+{
+    static std::mt19937 rng{std::random_device{}()};
+    return rng;
+}
+
+void seed_global_rng(unsigned int seed)
+{
+    global_rng().seed(seed);
+}
+
+std::string save_rng_state()
+{
+    std::ostringstream out;
+    out << global_rng();
+    return out.str();
+}
+
+void restore_rng_state(const std::string &state)
+{
+    std::istringstream in(state);
+    std::mt19937 rng;
+    if (!(in >> rng))
+    {
+        throw std::runtime_error("Invalid random generator state.");
+    }
+    global_rng() = rng;
+}
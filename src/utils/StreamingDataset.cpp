@@ -0,0 +1,462 @@
+#include "utils/StreamingDataset.hpp"
+#include "utils/Random.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+// Binary dataset layout (native byte order, checked with the endian tag):
+//   DatasetHeader
+//   rows x cols doubles, row-major, label column where the CSV had it
+namespace
+{
+const char kMagic[8] = {'M', 'L', 'P', 'D', 'A', 'T', 'A', '\0'};
+const uint32_t kVersion = 1;
+const uint32_t kEndianTag = 0x01020304;
+// Rows read from a binary dataset per read() call
+const size_t kBinaryChunkRows = 1024;
+
+struct DatasetHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t cols;
+    uint32_t reserved;
+    uint64_t rows;
+};
+static_assert(sizeof(DatasetHeader) == 32, "DatasetHeader layout changed");
+} // namespace
+
+// Reads a dataset file one row (label included) at a time
+class RowSource
+{
+public:
+    virtual ~RowSource() = default;
+    // Fills row[0, columns()); false at the end of the file
+    virtual bool next_row(double *row) = 0;
+    // Goes back to the first row
+    virtual void rewind() = 0;
+    int columns() const { return m_columns; }
+
+protected:
+    int m_columns = 0;
+};
+
+namespace
+{
+class CsvRowSource : public RowSource
+{
+public:
+    explicit CsvRowSource(const std::string &filepath) : m_path(filepath), m_file(filepath), m_line_number(1)
+    {
+        if (!m_file.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + filepath);
+        }
+        std::string header;
+        if (!std::getline(m_file, header))
+        {
+            throw std::runtime_error("Dataset file is empty: " + filepath);
+        }
+        m_columns = static_cast<int>(std::count(header.begin(), header.end(), ',')) + 1;
+        m_data_start = m_file.tellg();
+    }
+
+    bool next_row(double *row) override
+    {
+        while (std::getline(m_file, m_line))
+        {
+            ++m_line_number;
+            if (m_line.empty() || m_line == "\r")
+                continue;
+            parse_line(row);
+            return true;
+        }
+        return false;
+    }
+
+    void rewind() override
+    {
+        m_file.clear();
+        m_file.seekg(m_data_start);
+        m_line_number = 1;
+    }
+
+private:
+    void parse_line(double *row)
+    {
+        const char *cell = m_line.c_str();
+        int col = 0;
+        for (;;)
+        {
+            if (col == m_columns)
+                bad_row();
+            char *end;
+            double value = std::strtod(cell, &end);
+            // Anything that is not a number ("NA", empty) reads as 0, like read_csv_boston
+            row[col++] = end == cell ? 0.0 : value;
+            const char *comma = std::strchr(end, ',');
+            if (!comma)
+                break;
+            cell = comma + 1;
+        }
+        if (col != m_columns)
+            bad_row();
+    }
+
+    [[noreturn]] void bad_row() const
+    {
+        throw std::runtime_error("Line " + std::to_string(m_line_number) + " of " + m_path +
+                                 " does not have " + std::to_string(m_columns) + " columns.");
+    }
+
+    std::string m_path;
+    std::ifstream m_file;
+    std::streampos m_data_start;
+    std::string m_line;
+    long long m_line_number;
+};
+
+class BinaryRowSource : public RowSource
+{
+public:
+    explicit BinaryRowSource(const std::string &filepath)
+        : m_path(filepath), m_file(filepath, std::ios::binary), m_rows_read(0), m_filled(0), m_next(0)
+    {
+        if (!m_file.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + filepath);
+        }
+        DatasetHeader header;
+        if (!m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            throw std::runtime_error("Not a binary dataset file: " + filepath);
+        }
+        if (header.version != kVersion)
+        {
+            throw std::runtime_error("Unsupported binary dataset version " + std::to_string(header.version));
+        }
+        if (header.endian_tag != kEndianTag)
+        {
+            throw std::runtime_error("Binary dataset was written with a different byte order.");
+        }
+        m_columns = static_cast<int>(header.cols);
+        m_rows = header.rows;
+        m_buffer.resize(kBinaryChunkRows * m_columns);
+    }
+
+    bool next_row(double *row) override
+    {
+        if (m_next == m_filled)
+        {
+            if (m_rows_read == m_rows)
+                return false;
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(kBinaryChunkRows, m_rows - m_rows_read));
+            if (!m_file.read(reinterpret_cast<char *>(m_buffer.data()), chunk * m_columns * sizeof(double)))
+            {
+                throw std::runtime_error("Binary dataset is truncated: " + m_path);
+            }
+            m_rows_read += chunk;
+            m_filled = chunk;
+            m_next = 0;
+        }
+        const double *source = m_buffer.data() + m_next * m_columns;
+        std::copy(source, source + m_columns, row);
+        ++m_next;
+        return true;
+    }
+
+    void rewind() override
+    {
+        m_file.clear();
+        m_file.seekg(sizeof(DatasetHeader));
+        m_rows_read = 0;
+        m_filled = 0;
+        m_next = 0;
+    }
+
+private:
+    std::string m_path;
+    std::ifstream m_file;
+    uint64_t m_rows;
+    uint64_t m_rows_read;
+    std::vector<double> m_buffer; // One chunk of rows
+    size_t m_filled;
+    size_t m_next;
+};
+
+std::unique_ptr<RowSource> open_source(const std::string &filepath)
+{
+    if (StreamingDataset::is_binary_file(filepath))
+    {
+        return std::unique_ptr<RowSource>(new BinaryRowSource(filepath));
+    }
+    return std::unique_ptr<RowSource>(new CsvRowSource(filepath));
+}
+} // namespace
+
+StreamingDataset::StreamingDataset(const std::string &path, LabelColumn label, int batch_size,
+                                   size_t shuffle_buffer, long long skip_rows)
+    : m_source(open_source(path)), m_label(label), m_batch_size(batch_size), m_shuffle_buffer(shuffle_buffer),
+      m_skip_rows(skip_rows), m_rng(global_rng()()), m_batches(2), m_pass_done(false),
+      m_passes_requested(1), m_passes_started(0), m_stop(false)
+{
+    if (batch_size < 1)
+    {
+        throw std::invalid_argument("Batch size must be positive.");
+    }
+    if (m_source->columns() < 2)
+    {
+        throw std::runtime_error("Dataset needs a label and at least one feature column: " + path);
+    }
+    m_worker = std::thread(&StreamingDataset::run, this);
+}
+
+StreamingDataset::~StreamingDataset()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_batches.close();
+    m_worker.join();
+}
+
+int StreamingDataset::getFeatureCount() const
+{
+    return m_source->columns() - 1;
+}
+
+int StreamingDataset::column_count(const std::string &path)
+{
+    return open_source(path)->columns();
+}
+
+bool StreamingDataset::is_binary_file(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(kMagic)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool StreamingDataset::next(DataBatch &batch)
+{
+    if (m_pass_done)
+    {
+        return false;
+    }
+    if (!m_batches.pop(batch))
+    {
+        // Closed early: the prefetch thread failed
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pass_done = true;
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return false;
+    }
+    // An empty batch marks the end of a pass
+    if (batch.features.getRows() == 0)
+    {
+        m_pass_done = true;
+        return false;
+    }
+    return true;
+}
+
+void StreamingDataset::rewind()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_passes_requested;
+    }
+    m_cv.notify_one();
+    // The prefetch thread cuts the current pass short; drop what it already queued
+    DataBatch skipped;
+    while (next(skipped))
+    {
+    }
+    m_pass_done = false;
+}
+
+void StreamingDataset::run()
+{
+    try
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]()
+                          { return m_stop || m_passes_requested > m_passes_started; });
+                if (m_stop)
+                    return;
+                ++m_passes_started;
+            }
+            produce_pass();
+            if (!m_batches.push(DataBatch{}))
+                return;
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+        m_batches.close();
+    }
+}
+
+void StreamingDataset::produce_pass()
+{
+    m_source->rewind();
+    size_t cols = static_cast<size_t>(m_source->columns());
+    std::vector<double> row(cols);
+    std::vector<double> pool; // Shuffle buffer, grown up to m_shuffle_buffer rows
+    size_t pooled = 0;
+    DataBatch batch;
+    int filled = 0;
+
+    for (long long skipped = 0; skipped < m_skip_rows && m_source->next_row(row.data()); ++skipped)
+    {
+    }
+    while (m_source->next_row(row.data()))
+    {
+        if (m_shuffle_buffer == 0)
+        {
+            emit_row(row.data(), batch, filled);
+        }
+        else if (pooled < m_shuffle_buffer)
+        {
+            pool.insert(pool.end(), row.begin(), row.end());
+            ++pooled;
+            continue;
+        }
+        else
+        {
+            // Emit a random buffered row and keep the new one in its slot
+            size_t slot = std::uniform_int_distribution<size_t>(0, pooled - 1)(m_rng);
+            double *kept = pool.data() + slot * cols;
+            emit_row(kept, batch, filled);
+            std::copy(row.begin(), row.end(), kept);
+        }
+        if (filled == m_batch_size && !flush_batch(batch, filled))
+            return;
+    }
+
+    // End of the file: what is left in the shuffle buffer goes out in random order
+    std::vector<size_t> order(pooled);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), m_rng);
+    for (size_t slot : order)
+    {
+        emit_row(pool.data() + slot * cols, batch, filled);
+        if (filled == m_batch_size && !flush_batch(batch, filled))
+            return;
+    }
+    if (filled > 0)
+        flush_batch(batch, filled);
+}
+
+void StreamingDataset::emit_row(const double *row, DataBatch &batch, int &filled)
+{
+    int features = getFeatureCount();
+    if (filled == 0)
+    {
+        batch.features = Matrix(m_batch_size, features);
+        batch.labels = Matrix(m_batch_size, 1);
+    }
+    const double *first_feature = m_label == LabelColumn::FIRST ? row + 1 : row;
+    batch.labels.data()[filled] = m_label == LabelColumn::FIRST ? row[0] : row[features];
+    std::copy(first_feature, first_feature + features,
+              batch.features.data() + static_cast<size_t>(filled) * features);
+    ++filled;
+}
+
+bool StreamingDataset::flush_batch(DataBatch &batch, int &filled)
+{
+    if (filled < m_batch_size)
+    {
+        batch.features = batch.features.slice(0, filled);
+        batch.labels = batch.labels.slice(0, filled);
+    }
+    filled = 0;
+    {
+        // Stop early when the dataset is closing or the consumer already rewound
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || m_passes_requested > m_passes_started)
+            return false;
+    }
+    return m_batches.push(std::move(batch));
+}
+
+void StreamingDataset::convert_csv(const std::string &csv_path, const std::string &binary_path)
+{
+    CsvRowSource source(csv_path);
+    DatasetWriter writer(binary_path, source.columns());
+    std::vector<double> row(source.columns());
+    while (source.next_row(row.data()))
+    {
+        writer.write(row.data(), 1);
+    }
+    writer.close();
+}
+
+DatasetWriter::DatasetWriter(const std::string &path, int cols)
+    : m_path(path), m_file(path, std::ios::binary), m_cols(cols), m_rows(0), m_closed(false)
+{
+    if (!m_file.is_open())
+    {
+        throw std::runtime_error("Could not open file for writing: " + path);
+    }
+    write_header(); // Placeholder until close() knows the row count
+}
+
+DatasetWriter::~DatasetWriter()
+{
+    if (!m_closed)
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception &)
+        {
+        }
+    }
+}
+
+void DatasetWriter::write(const double *rows, size_t count)
+{
+    m_file.write(reinterpret_cast<const char *>(rows), count * m_cols * sizeof(double));
+    m_rows += count;
+}
+
+void DatasetWriter::close()
+{
+    m_closed = true;
+    m_file.seekp(0);
+    write_header();
+    m_file.close();
+    if (!m_file)
+    {
+        throw std::runtime_error("Failed to write dataset file: " + m_path);
+    }
+}
+
+void DatasetWriter::write_header()
+{
+    DatasetHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.cols = static_cast<uint32_t>(m_cols);
+    header.rows = m_rows;
+    m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
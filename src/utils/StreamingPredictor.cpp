@@ -0,0 +1,167 @@
+#include "utils/StreamingPredictor.hpp"
+#include "utils/BoundedQueue.hpp"
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+bool has_binary_extension(const std::string &filepath)
+{
+    const std::string ext = ".bin";
+    return filepath.size() >= ext.size() &&
+           filepath.compare(filepath.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+class ChunkWriter
+{
+public:
+    virtual ~ChunkWriter() = default;
+    virtual void write(const Matrix &chunk) = 0;
+    virtual void close() = 0;
+};
+
+class CsvChunkWriter : public ChunkWriter
+{
+public:
+    CsvChunkWriter(const std::string &path, const std::vector<std::string> &columns)
+        : m_path(path), m_file(path, std::ios::binary)
+    {
+        if (!m_file.is_open())
+        {
+            throw std::runtime_error("Could not open file for writing: " + path);
+        }
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            m_file << (i ? "," : "") << columns[i];
+        }
+        m_file << '\n';
+    }
+
+    void write(const Matrix &chunk) override
+    {
+        // Shortest text that reads back as the same double
+        char cell[32];
+        m_text.clear();
+        const double *values = chunk.data();
+        for (int i = 0; i < chunk.getRows(); ++i)
+        {
+            for (int j = 0; j < chunk.getCols(); ++j)
+            {
+                if (j)
+                    m_text.push_back(',');
+                char *end = std::to_chars(cell, cell + sizeof(cell), *values++).ptr;
+                m_text.append(cell, end);
+            }
+            m_text.push_back('\n');
+        }
+        m_file.write(m_text.data(), m_text.size());
+    }
+
+    void close() override
+    {
+        m_file.close();
+        if (!m_file)
+        {
+            throw std::runtime_error("Failed to write predictions: " + m_path);
+        }
+    }
+
+private:
+    std::string m_path;
+    std::ofstream m_file;
+    std::string m_text; // One chunk, formatted
+};
+
+class BinaryChunkWriter : public ChunkWriter
+{
+public:
+    BinaryChunkWriter(const std::string &path, int cols) : m_writer(path, cols) {}
+
+    void write(const Matrix &chunk) override
+    {
+        m_writer.write(chunk.data(), chunk.getRows());
+    }
+
+    void close() override
+    {
+        m_writer.close();
+    }
+
+private:
+    DatasetWriter m_writer;
+};
+} // namespace
+
+PredictionStats stream_predictions(StreamingDataset &input, const std::string &output_path,
+                                   const std::vector<std::string> &columns, const ChunkInference &infer,
+                                   const ChunkObserver &observe)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<ChunkWriter> writer;
+    if (has_binary_extension(output_path))
+        writer.reset(new BinaryChunkWriter(output_path, static_cast<int>(columns.size())));
+    else if (!output_path.empty())
+        writer.reset(new CsvChunkWriter(output_path, columns));
+
+    // Writer stage: formats and writes finished chunks while the next ones are inferred
+    BoundedQueue<Matrix> finished(2);
+    std::exception_ptr write_error;
+    std::thread writer_thread([&]()
+                              {
+        try
+        {
+            Matrix chunk(0, 0);
+            while (finished.pop(chunk))
+            {
+                if (writer)
+                    writer->write(chunk);
+            }
+            if (writer)
+                writer->close();
+        }
+        catch (...)
+        {
+            write_error = std::current_exception();
+            finished.close();
+        } });
+
+    PredictionStats stats;
+    try
+    {
+        DataBatch batch;
+        while (input.next(batch))
+        {
+            Matrix output = infer(batch.features);
+            if (output.getCols() != static_cast<int>(columns.size()))
+            {
+                throw std::runtime_error("Prediction output has " + std::to_string(output.getCols()) +
+                                         " columns, expected " + std::to_string(columns.size()) + ".");
+            }
+            observe(output, batch.labels, stats.rows);
+            stats.rows += output.getRows();
+            if (!finished.push(std::move(output)))
+                break; // The writer failed
+        }
+    }
+    catch (...)
+    {
+        finished.close();
+        writer_thread.join();
+        throw;
+    }
+    finished.close();
+    writer_thread.join();
+    if (write_error)
+    {
+        std::rethrow_exception(write_error);
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.rows_per_second = stats.seconds > 0.0 ? stats.rows / stats.seconds : 0.0;
+    return stats;
+}
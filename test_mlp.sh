@@ -313,6 +313,188 @@ else
     exit 1
 fi
 
+# Test 14: Binary model conversion round trip
+if [ -f "models/boston_test.txt" ]; then
+    echo
+    print_info "Test 14: Binary model conversion"
+    if ./mlp --mode boston --convert models/boston_test.txt --save "$TEST_MODELS_DIR/test_boston.bin" > /dev/null 2>&1 && \
+       ./mlp --mode boston --convert "$TEST_MODELS_DIR/test_boston.bin" --save "$TEST_MODELS_DIR/test_boston_roundtrip.txt" > /dev/null 2>&1 && \
+       ./mlp --mode boston --convert "$TEST_MODELS_DIR/test_boston_roundtrip.txt" --save "$TEST_MODELS_DIR/test_boston_roundtrip.bin" > /dev/null 2>&1 && \
+       cmp -s "$TEST_MODELS_DIR/test_boston.bin" "$TEST_MODELS_DIR/test_boston_roundtrip.bin"; then
+        print_success "Binary conversion round trip is bit-exact"
+    else
+        print_error "Binary conversion round trip failed"
+        exit 1
+    fi
+fi
+
+# Test 15: Multi-process training matches single-process training
+if [ -f "data/boston_housing.csv" ]; then
+    echo
+    print_info "Test 15: Multi-process shared-memory training"
+    single=$(./mlp --mode boston --train --epochs 20 --seed 1 2>&1 | grep "Final Validation MSE")
+    multi=$(./mlp --mode boston --train --epochs 20 --seed 1 --processes 3 2>&1 | grep "Final Validation MSE")
+    if [ -n "$single" ] && [ "$single" = "$multi" ]; then
+        print_success "3-process training reproduces single-process training"
+    else
+        print_error "Multi-process training diverged: '$single' vs '$multi'"
+        exit 1
+    fi
+fi
+
+# Test 16: Streamed prediction writes one output row per input row
+if [ -f "data/boston_housing.csv" ] && [ -f "$TEST_MODELS_DIR/test_boston.txt" ]; then
+    echo
+    print_info "Test 16: Streamed prediction to an output file"
+    ./mlp --mode boston --predict --load "$TEST_MODELS_DIR/test_boston.txt" --chunk-size 100 \
+        --output "$TEST_MODELS_DIR/predictions.csv" > /dev/null 2>&1
+    expected=$(($(wc -l < data/boston_housing.csv)))
+    if [ -f "$TEST_MODELS_DIR/predictions.csv" ] && [ "$(wc -l < "$TEST_MODELS_DIR/predictions.csv")" -eq "$expected" ]; then
+        print_success "Predictions written for every input row"
+    else
+        print_error "Prediction output is missing rows"
+        exit 1
+    fi
+fi
+
+# Test 17: An int8 model predicts the same with every kernel the CPU offers
+if [ -f "data/boston_housing.csv" ] && [ -f "$TEST_MODELS_DIR/test_boston.txt" ]; then
+    echo
+    print_info "Test 17: Int8 quantization and kernel agreement"
+    ./mlp --mode boston --quantize "$TEST_MODELS_DIR/test_boston.txt" --save "$TEST_MODELS_DIR/test_boston.q8" > /dev/null 2>&1
+    ./mlp --mode boston --predict --load "$TEST_MODELS_DIR/test_boston.q8" \
+        --output "$TEST_MODELS_DIR/int8.csv" > /dev/null 2>&1
+    MLP_INT8_KERNEL=scalar ./mlp --mode boston --predict --load "$TEST_MODELS_DIR/test_boston.q8" \
+        --output "$TEST_MODELS_DIR/int8_scalar.csv" > /dev/null 2>&1
+    if [ -s "$TEST_MODELS_DIR/int8.csv" ] && cmp -s "$TEST_MODELS_DIR/int8.csv" "$TEST_MODELS_DIR/int8_scalar.csv"; then
+        print_success "Int8 predictions match the scalar kernel"
+    else
+        print_error "Int8 predictions are missing or differ between kernels"
+        exit 1
+    fi
+fi
+
+# Test 18: A pruned, block-sparse model predicts every row
+if [ -f "data/boston_housing.csv" ] && [ -f "$TEST_MODELS_DIR/test_boston.txt" ]; then
+    echo
+    print_info "Test 18: Pruning to a block-sparse model"
+    ./mlp --mode boston --prune "$TEST_MODELS_DIR/test_boston.txt" --sparsity 0.5 --sparse-format bsr --fine-tune 2 \
+        --save "$TEST_MODELS_DIR/test_boston.sparse" > /dev/null 2>&1
+    ./mlp --mode boston --predict --load "$TEST_MODELS_DIR/test_boston.sparse" \
+        --output "$TEST_MODELS_DIR/sparse.csv" > /dev/null 2>&1
+    expected=$(($(wc -l < data/boston_housing.csv)))
+    if [ -f "$TEST_MODELS_DIR/sparse.csv" ] && [ "$(wc -l < "$TEST_MODELS_DIR/sparse.csv")" -eq "$expected" ]; then
+        print_success "Sparse model predicted every row"
+    else
+        print_error "Sparse model prediction failed"
+        exit 1
+    fi
+fi
+
+# Test 19: A low-rank factorized model saves and loads like any other
+if [ -f "data/boston_housing.csv" ] && [ -f "$TEST_MODELS_DIR/test_boston.txt" ]; then
+    echo
+    print_info "Test 19: Low-rank factorization round trip"
+    ./mlp --mode boston --factorize "$TEST_MODELS_DIR/test_boston.txt" --rank 4 --fine-tune 2 \
+        --save "$TEST_MODELS_DIR/test_boston_r4.txt" > /dev/null 2>&1
+    if ./mlp --mode boston --predict --load "$TEST_MODELS_DIR/test_boston_r4.txt" 2>&1 | grep -q "Overall MSE"; then
+        print_success "Factorized model loaded and predicted"
+    else
+        print_error "Factorized model could not be loaded"
+        exit 1
+    fi
+fi
+
+# Test 20: Code generation writes a standalone header that compiles and predicts like Model
+if [ -f "data/boston_housing.csv" ] && [ -f "$TEST_MODELS_DIR/test_boston.txt" ]; then
+    echo
+    print_info "Test 20: Ahead-of-time code generation"
+    DIFF=$(./mlp --mode boston --generate "$TEST_MODELS_DIR/test_boston.txt" --save "$TEST_MODELS_DIR/test_boston.hpp" 2>&1 | grep -o "Largest difference from Model::predict: [0-9.e+-]*" | awk '{print $5}')
+    if [ -n "$DIFF" ] && awk -v d="$DIFF" 'BEGIN { exit !(d < 1e-9) }'; then
+        print_success "Generated header compiles and matches Model::predict"
+    else
+        print_error "Generated code failed to build or disagrees with Model::predict"
+        exit 1
+    fi
+fi
+
+# Test 21: The compile-time StaticMLP trains like Model
+if [ -f "data/boston_housing.csv" ]; then
+    echo
+    print_info "Test 21: StaticMLP against Model"
+    LOSSES=$(./mlp --mode boston --benchmark static --epochs 5 2>&1 | grep -o "last loss [0-9.]*" | sort -u | wc -l)
+    if [ "$LOSSES" = "1" ]; then
+        print_success "StaticMLP matches Model"
+    else
+        print_error "StaticMLP and Model disagree"
+        exit 1
+    fi
+fi
+
+# Test 22: A compiled execution plan trains like Model
+if [ -f "data/boston_housing.csv" ]; then
+    echo
+    print_info "Test 22: Compiled execution plan"
+    DIFF=$(./mlp --mode boston --benchmark plan --epochs 2 2>&1 | grep -o "largest parameter difference [0-9.e+-]*" | awk '{print $4}')
+    if [ -n "$DIFF" ] && awk -v d="$DIFF" 'BEGIN { exit !(d < 1e-9) }'; then
+        print_success "Execution plan matches Model"
+    else
+        print_error "Execution plan and Model disagree"
+        exit 1
+    fi
+fi
+
+# Test 23: Activation recomputation leaves training unchanged
+if [ -f "data/boston_housing.csv" ]; then
+    echo
+    print_info "Test 23: Activation recomputation"
+    KEPT=$(./mlp --mode boston --train --epochs 5 --hidden 16,16,16,16 --seed 7 2>&1 | grep "Final Validation MSE")
+    RECOMPUTED=$(./mlp --mode boston --train --epochs 5 --hidden 16,16,16,16 --seed 7 --recompute 2 2>&1 | grep "Final Validation MSE")
+    if [ -n "$KEPT" ] && [ "$KEPT" = "$RECOMPUTED" ]; then
+        print_success "Recomputed activations train identically"
+    else
+        print_error "Activation recomputation changed training"
+        exit 1
+    fi
+fi
+
+# Test 24: Vectorized math kernels stay within their error bounds, and a GELU
+# network trains the same through an execution plan, whose arena holds the
+# inputs GELU keeps for backward and shrinks when they are recomputed
+if [ -f "data/boston_housing.csv" ]; then
+    echo
+    print_info "Test 24: Vectorized math kernels"
+    PLAN_ARGS="--mode boston --benchmark plan --epochs 1 --batch-size 256 --hidden 32,32,32,32,32,32,32,32"
+    RELU=$(./mlp $PLAN_ARGS 2>&1 | grep "^Plan:")
+    GELU=$(./mlp $PLAN_ARGS --activation gelu --recompute 4 2>&1 | grep "^Plan")
+    DIFFS=$(echo "$GELU" | grep -o "largest parameter difference [0-9.e+-]*" | awk '{print $4}')
+    ARENAS=$(echo "$RELU"; echo "$GELU") # ReLU, GELU, GELU with recomputation
+    ARENAS=$(echo "$ARENAS" | grep -o "arena [0-9.]*" | awk '{print $2}' | tr '\n' ' ')
+    if ./mlp --mode boston --benchmark math > /dev/null 2>&1 && [ "$(echo "$DIFFS" | wc -w)" = "2" ] &&
+        echo "$DIFFS" | awk '$1 >= 1e-9 { bad = 1 } END { exit bad }' &&
+        echo "$ARENAS" | awk '{ exit !($2 > $1 && $3 < $2) }'; then
+        print_success "Kernels within bounds, GELU plan matches Model and its arena shrinks with recomputation"
+    else
+        print_error "Vectorized math kernels or GELU execution plan failed"
+        exit 1
+    fi
+fi
+
+# Test 25: Parallel trainers reproduce the single-threaded gradient, for the
+# mean squared error (Boston) and for the summed cross-entropy gradient (MNIST),
+# without and with L2 regularizers, whose penalty must be added only once
+if [ -f "data/boston_housing.csv" ] && [ -f "data/mnist_train.csv" ]; then
+    echo
+    print_info "Test 25: Parallel training gradients"
+    PARALLEL_ARGS="--benchmark parallel --epochs 1 --workers 3 --processes 3 --pipeline 2 --micro-batches 3"
+    if ./mlp --mode boston $PARALLEL_ARGS > /dev/null 2>&1 && ./mlp --mode mnist $PARALLEL_ARGS > /dev/null 2>&1; then
+        print_success "Parallel gradients match the single-threaded Model, with and without regularizers"
+    else
+        print_error "A parallel trainer's gradient differs from the single-threaded Model"
+        exit 1
+    fi
+fi
+
 echo
 print_info "Cleaning up test models..."
 rm -rf "$TEST_MODELS_DIR"